@@ -61,6 +61,58 @@ public class DB {
   public static final int MREPLACE = 2;
   /** merge mode: append the new value */
   public static final int MAPPEND = 3;
+  /** change capture policy: block the writer while the buffer is full */
+  public static final int CBLOCK = 0;
+  /** change capture policy: discard the new change while the buffer is full */
+  public static final int CDISCARD = 1;
+  /** change capture policy: overwrite the oldest change while the buffer is full */
+  public static final int COVERWRITE = 2;
+  /** change type: a record is stored */
+  public static final int CSET = 1;
+  /** change type: a record is removed */
+  public static final int CREMOVE = 2;
+  /** change type: all records are removed */
+  public static final int CCLEAR = 3;
+  /** index extractor: byte range of the value */
+  public static final int IRANGE = 0;
+  /** index extractor: delimiter-separated field of the value */
+  public static final int IFIELD = 1;
+  /** index extractor: fixed-width big-endian integer in the value */
+  public static final int IINTEGER = 2;
+  /** file format: tab-separated values with escaping */
+  public static final int FTSV = 0;
+  /** file format: records prefixed by the 32-bit big-endian lengths of the key and the value */
+  public static final int FBINARY = 1;
+  /** file format: snapshot */
+  public static final int FSNAPSHOT = 2;
+  /** merge operator: addition of 64-bit big-endian integers */
+  public static final int VADDINT = 0;
+  /** merge operator: addition of 64-bit big-endian IEEE 754 doubles */
+  public static final int VADDDBL = 1;
+  /** merge operator: lexicographic maximum */
+  public static final int VMAX = 2;
+  /** merge operator: lexicographic minimum */
+  public static final int VMIN = 3;
+  /** merge operator: maximum of 64-bit big-endian integers */
+  public static final int VMAXINT = 4;
+  /** merge operator: minimum of 64-bit big-endian integers */
+  public static final int VMININT = 5;
+  /** merge operator: bitwise OR */
+  public static final int VOR = 6;
+  /** merge operator: union of sorted unique line-feed separated lists */
+  public static final int VUNION = 7;
+  /** transformation: overwrite the bytes at a position */
+  public static final int TSET = 0;
+  /** transformation: append bytes */
+  public static final int TAPPEND = 1;
+  /** transformation: prepend bytes */
+  public static final int TPREPEND = 2;
+  /** transformation: replace a delimiter-separated field */
+  public static final int TFIELD = 3;
+  /** transformation: remove the record */
+  public static final int TREMOVE = 4;
+  /** transformation: add a number to a 64-bit big-endian integer at a position */
+  public static final int TINCINT = 5;
   //----------------------------------------------------------------
   // constructors and finalizer
   //----------------------------------------------------------------
@@ -220,6 +272,18 @@ public class DB {
   public boolean add(String key, String value) {
     return add(str_to_ary(key), str_to_ary(value));
   }
+  /**
+   * Add multiple records at once.
+   * @param keys the keys of the records.
+   * @param values the values corresponding to the keys.
+   * @param atomic true to perform all operations in a transaction, or false for non-atomic
+   * operations.
+   * @return a bitset of the keys whose records were added, or null on failure.  The bit of
+   * the i-th key is (bits[i/8] >> (i%8)) & 1.
+   * @note If atomic mode is specified, no record is added unless all of the keys are new.
+   * Otherwise, existing records are skipped with their bits cleared.
+   */
+  public native byte[] add_bulk(byte[][] keys, byte[][] values, boolean atomic);
   /**
    * Replace the value of a record.
    * @param key the key.
@@ -292,6 +356,77 @@ public class DB {
   public double increment_double(String key, double num, double orig) {
     return increment_double(str_to_ary(key), num, orig);
   }
+  /**
+   * Add numbers to the numeric integer values of multiple records at once.
+   * @param keys the keys of the records.
+   * @param nums the additional numbers corresponding to the keys.
+   * @param results an array to store the result values, or null if they are not needed.
+   * @param orig the origin number if no record corresponds to a key.
+   * @param atomic true to perform all operations in a transaction, or false for non-atomic
+   * operations.
+   * @return true on success, or false on failure.
+   * @note If atomic mode is specified, no addition is applied on failure.  Otherwise,
+   * additions before the failed one are kept.
+   */
+  public native boolean increment_bulk(byte[][] keys, long[] nums, long[] results,
+                                       long orig, boolean atomic);
+  /**
+   * Add numbers to the numeric double values of multiple records at once.
+   * @param keys the keys of the records.
+   * @param nums the additional numbers corresponding to the keys.
+   * @param results an array to store the result values, or null if they are not needed.
+   * @param orig the origin number if no record corresponds to a key.
+   * @param atomic true to perform all operations in a transaction, or false for non-atomic
+   * operations.
+   * @return true on success, or false on failure.
+   * @note If atomic mode is specified, no addition is applied on failure.  Otherwise,
+   * additions before the failed one are kept.
+   */
+  public native boolean increment_double_bulk(byte[][] keys, double[] nums, double[] results,
+                                              double orig, boolean atomic);
+  /**
+   * Merge an operand into the value of a record.
+   * @param key the key.
+   * @param op the merge operator.  DB.VADDINT, DB.VADDDBL, DB.VMAX, DB.VMIN, DB.VMAXINT,
+   * DB.VMININT, DB.VOR, or DB.VUNION.
+   * @param operand the operand.  Numeric operands are 8-byte big-endian values.
+   * @return true on success, or false on failure.
+   * @note The operation is done atomically inside the database.  If no record corresponds,
+   * the operand is stored as the value.
+   */
+  public boolean merge_value(byte[] key, int op, byte[] operand) {
+    return merge_value(key, op, operand, 0);
+  }
+  /**
+   * Merge an operand into the value of a record.
+   * @param key the key.
+   * @param op the merge operator.
+   * @param operand the operand.
+   * @param limit the maximum number of elements kept by DB.VUNION.  The greatest elements are
+   * kept.  If it is not more than 0, no limit is specified.
+   * @return true on success, or false on failure.
+   */
+  public native boolean merge_value(byte[] key, int op, byte[] operand, long limit);
+  /**
+   * Merge an operand into the value of a record.
+   * @note Equal to the original DB.merge_value method except that the parameters are String.
+   * @see #merge_value(byte[], int, byte[], long)
+   */
+  public boolean merge_value(String key, int op, String operand, long limit) {
+    return merge_value(str_to_ary(key), op, str_to_ary(operand), limit);
+  }
+  /**
+   * Merge operands into the values of multiple records.
+   * @param recs an array of keys and operands placed alternately.
+   * @param op the merge operator.
+   * @param limit the maximum number of elements kept by DB.VUNION.
+   * @param atomic true to perform all operations atomically, or false for non-atomic operations.
+   * @return the number of merged operands, or -1 on failure.
+   * @note An operand of a numeric operator not of 8 bytes is rejected before any record is
+   * updated.  In the atomic mode, the operations run in a transaction, which is aborted if a
+   * stored value does not suit the operator.
+   */
+  public native long merge_value_bulk(byte[][] recs, int op, long limit, boolean atomic);
   /**
    * Perform compare-and-swap.
    * @param key the key.
@@ -310,6 +445,21 @@ public class DB {
     byte[] nary = oval != null ? str_to_ary(nval) : null;
     return cas(str_to_ary(key), oary, nary);
   }
+  /**
+   * Perform compare-and-swap on multiple records at once.
+   * @param keys the keys of the records.
+   * @param ovals the old values corresponding to the keys.  null elements mean that no record
+   * corresponds.
+   * @param nvals the new values corresponding to the keys.  null elements mean that the records
+   * are removed.
+   * @param atomic true to perform all operations in a transaction, or false for non-atomic
+   * operations.
+   * @return a bitset of the keys whose records were swapped, or null on failure.  The bit of
+   * the i-th key is (bits[i/8] >> (i%8)) & 1.
+   * @note If atomic mode is specified, no record is modified unless all of the old values
+   * match.  Otherwise, mismatched records are skipped with their bits cleared.
+   */
+  public native byte[] cas_bulk(byte[][] keys, byte[][] ovals, byte[][] nvals, boolean atomic);
   /**
    * Remove a record.
    * @param key the key.
@@ -353,6 +503,23 @@ public class DB {
   public int check(String key) {
     return check(str_to_ary(key));
   }
+  /**
+   * Check the existence of multiple records at once.
+   * @param keys the keys of the records.
+   * @param sizes an array to store the sizes of the values, or null if they are not needed.
+   * -1 is stored for each missing record.
+   * @return the number of existing records, or -1 on failure.
+   * @note Missing records are not regarded as failure.
+   */
+  public native long check_bulk(byte[][] keys, int[] sizes);
+  /**
+   * Check the existence of multiple records at once.
+   * @param keys the keys of the records.
+   * @return a bitset of the keys whose records exist, or null on failure.  The bit of the i-th
+   * key is (bits[i/64] >>> (i%64)) & 1.
+   * @note Missing records are not regarded as failure.
+   */
+  public native long[] contains_bulk(byte[][] keys);
   /**
    * Retrieve the value of a record and remove it atomically.
    * @param key the key.
@@ -409,6 +576,103 @@ public class DB {
     }
     return remove_bulk(keyary, atomic);
   }
+  /**
+   * Remove records whose keys begin with a prefix.
+   * @param prefix the prefix of the keys.
+   * @return the number of removed records, or -1 on failure.
+   */
+  public long remove_prefix(byte[] prefix) {
+    return remove_prefix(prefix, 0, 0);
+  }
+  /**
+   * Remove records whose keys begin with a prefix.
+   * @param prefix the prefix of the keys.
+   * @param unit the number of removals committed in each transaction.  If it is not more
+   * than 0, no transaction is used.
+   * @param pause the time in seconds to pause between transactions.
+   * @return the number of removed records, or -1 on failure.
+   * @note Tree databases are scanned only within the range of the prefix while the other
+   * databases are scanned entirely.  On failure, the transactions already committed are kept.
+   */
+  public native long remove_prefix(byte[] prefix, long unit, double pause);
+  /**
+   * Remove records whose keys begin with a prefix.
+   * @note Equal to the original DB.remove_prefix method except that the parameter is String.
+   * @see #remove_prefix(byte[])
+   */
+  public long remove_prefix(String prefix) {
+    return remove_prefix(str_to_ary(prefix));
+  }
+  /**
+   * Remove records whose keys are in a range.
+   * @param begin the lower limit of the keys, inclusive.  null means the first key.
+   * @param end the upper limit of the keys, exclusive.  null means no limit.
+   * @return the number of removed records, or -1 on failure.
+   */
+  public long remove_range(byte[] begin, byte[] end) {
+    return remove_range(begin, end, 0, 0);
+  }
+  /**
+   * Remove records whose keys are in a range.
+   * @param begin the lower limit of the keys, inclusive.  null means the first key.
+   * @param end the upper limit of the keys, exclusive.  null means no limit.
+   * @param unit the number of removals committed in each transaction.  If it is not more
+   * than 0, no transaction is used.
+   * @param pause the time in seconds to pause between transactions.
+   * @return the number of removed records, or -1 on failure.
+   * @note Keys are compared lexically.  Tree databases are scanned only within the range while
+   * the other databases are scanned entirely.  On failure, the transactions already committed
+   * are kept.
+   */
+  public native long remove_range(byte[] begin, byte[] end, long unit, double pause);
+  /**
+   * Remove records whose keys are in a range.
+   * @note Equal to the original DB.remove_range method except that the parameters are String.
+   * @see #remove_range(byte[], byte[])
+   */
+  public long remove_range(String begin, String end) {
+    byte[] bary = begin != null ? str_to_ary(begin) : null;
+    byte[] eary = end != null ? str_to_ary(end) : null;
+    return remove_range(bary, eary);
+  }
+  /**
+   * Transform the values of records whose keys are in a range.
+   * @param begin the lower limit of the keys, inclusive.  null means the first key.
+   * @param end the upper limit of the keys, exclusive.  null means no limit.
+   * @param op the transformation.  DB.TSET to overwrite the bytes at the position with the
+   * data, DB.TAPPEND to append the data, DB.TPREPEND to prepend the data, DB.TFIELD to replace
+   * the field at the position separated by the number as a delimiter with the data, DB.TREMOVE
+   * to remove the record, DB.TINCINT to add the number to the 64-bit big-endian integer at the
+   * position.
+   * @param pos the position in bytes, or the index of the field.
+   * @param num the additional number, or the delimiter.
+   * @param data the data.
+   * @return the number of transformed records, or -1 on failure.
+   */
+  public long update_where(byte[] begin, byte[] end, int op, long pos, long num, byte[] data) {
+    return update_where(begin, end, op, pos, num, data, 0, null);
+  }
+  /**
+   * Transform the values of records whose keys are in a range.
+   * @param begin the lower limit of the keys, inclusive.  null means the first key.
+   * @param end the upper limit of the keys, exclusive.  null means no limit.
+   * @param op the transformation.
+   * @param pos the position in bytes, or the index of the field.
+   * @param num the additional number, or the delimiter.
+   * @param data the data.
+   * @param unit the number of transformed records committed in each transaction.  If it is not
+   * more than 0, no transaction is used.
+   * @param checker a progress checker object.  If it is null, no checking is performed.
+   * @return the number of transformed records, or -1 on failure.
+   * @note Values are transformed natively without calling back Java code.  Records which the
+   * transformation does not change, such as those lacking the field or the integer at the
+   * position, are skipped and not counted.  Tree databases are scanned only within the range
+   * while the other databases are scanned entirely.  Transformations which may grow values,
+   * DB.TSET, DB.TAPPEND, DB.TPREPEND, and DB.TFIELD, iterate the other databases entirely at
+   * once instead, without transactions in chunks.
+   */
+  public native long update_where(byte[] begin, byte[] end, int op, long pos, long num,
+                                  byte[] data, long unit, ProgressChecker checker);
   /**
    * Retrieve records at once.
    * @param keys the keys of the records to retrieve.
@@ -488,13 +752,43 @@ public class DB {
    * @param dest the name of the destination file.
    * @return true on success, or false on failure.
    */
-  public native boolean dump_snapshot(String dest);
+  public boolean dump_snapshot(String dest) {
+    return dump_snapshot(dest, null, null);
+  }
+  /**
+   * Dump records into a snapshot file with compression and progress checking.
+   * @param dest the name of the destination file.
+   * @param codec the name of the compressor.  "zlib" for the ZLIB raw compressor, "def" for the
+   * ZLIB deflate compressor, "gz" for the ZLIB gzip compressor, "lzo" for the LZO compressor,
+   * "lzma" for the LZMA compressor, or "fast" for the built-in LZF-style compressor.  If it is
+   * null or empty, the snapshot is not compressed.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note The ZLIB, LZO, and LZMA compressors are available only if Kyoto Cabinet was built with
+   * the corresponding libraries.  The message passed to the checker ends with the number of
+   * bytes written so far in parentheses.  If the checker returns false, the operation is
+   * stopped.
+   */
+  public native boolean dump_snapshot(String dest, String codec, ProgressChecker checker);
   /**
    * Load records from a snapshot file.
    * @param src the name of the source file.
    * @return true on success, or false on failure.
    */
-  public native boolean load_snapshot(String src);
+  public boolean load_snapshot(String src) {
+    return load_snapshot(src, null);
+  }
+  /**
+   * Load records from a snapshot file with progress checking.
+   * @param src the name of the source file.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note The compressor of the snapshot is detected automatically.  Compressed blocks are
+   * decompressed by a background thread while records are being stored.  The message passed to
+   * the checker ends with the number of bytes read so far in parentheses.  If the checker
+   * returns false, the operation is stopped.
+   */
+  public native boolean load_snapshot(String src, ProgressChecker checker);
   /**
    * Get the number of records.
    * @return the number of records, or -1 on failure.
@@ -545,13 +839,333 @@ public class DB {
    * existing value, DB.MAPPEND to append the new value.
    * @return true on success, or false on failure.
    */
-  public native boolean merge(DB[] srcary, int mode);
+  public boolean merge(DB[] srcary, int mode) {
+    return merge(srcary, mode, null);
+  }
+  /**
+   * Merge records from other databases with progress checking.
+   * @param srcary an array of the source detabase objects.
+   * @param mode the merge mode.  DB.MSET to overwrite the existing value, DB.MADD to keep the
+   * existing value, DB.MREPLACE to modify the existing record only, DB.MAPPEND to append the
+   * new value.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note Each source database is read by a dedicated thread into a bounded queue, and the
+   * records are merged in the order of keys.  Records of the same key are applied in the order
+   * of the source databases.  If the checker returns false, the operation is stopped.
+   */
+  public native boolean merge(DB[] srcary, int mode, ProgressChecker checker);
+  /**
+   * Load unsorted records from a file into the empty tree database.
+   * @param src the name of the source file of tab-separated values, in the same format as the
+   * import_file method with DB.FTSV.
+   * @return true on success, or false on failure.
+   */
+  public boolean bulk_load(String src) {
+    return bulk_load(src, null, 1, null);
+  }
+  /**
+   * Load unsorted records from a file into the empty tree database with progress checking.
+   * @param src the name of the source file of tab-separated values, in the same format as the
+   * import_file method with DB.FTSV.
+   * @param tmpdir the name of the directory for temporary files.  If it is null, the directory
+   * of the source file is used.
+   * @param thnum the number of worker threads to sort records.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note The database must be an empty tree database.  The records are sorted in runs of 64MB
+   * by the worker threads, the runs are written into temporary files, and they are merged and
+   * stored in ascending order of the keys without transactions, which is followed by
+   * synchronization.  Empty lines are skipped.  Records of the same key are applied in the
+   * order of the source file.  Opening the database with a large page cache, for example "#pccap=1g", and without
+   * DB.OAUTOTRAN makes loading faster.  The message passed to the checker is "sorting" or
+   * "loading", followed by the estimated remaining time in parentheses.  If the checker
+   * returns false, the operation is stopped.
+   */
+  public native boolean bulk_load(String src, String tmpdir, int thnum, ProgressChecker checker);
+  /**
+   * Import records from a file.
+   * @param path the name of the source file.
+   * @param format the file format.  DB.FTSV for tab-separated values, DB.FBINARY for
+   * length-prefixed binary records, DB.FSNAPSHOT for a snapshot.
+   * @return true on success, or false on failure.
+   */
+  public boolean import_file(String path, int format) {
+    return import_file(path, format, 1, 1024, null);
+  }
+  /**
+   * Import records from a file with parallel parsers.
+   * @param path the name of the source file.
+   * @param format the file format.  DB.FTSV for tab-separated values, DB.FBINARY for
+   * length-prefixed binary records, DB.FSNAPSHOT for a snapshot.
+   * @param thnum the number of parser threads.
+   * @param batch the number of records stored at once by each parser.
+   * @return true on success, or false on failure.
+   */
+  public boolean import_file(String path, int format, int thnum, int batch) {
+    return import_file(path, format, thnum, batch, null);
+  }
+  /**
+   * Import records from a file with parallel parsers and progress checking.
+   * @param path the name of the source file.
+   * @param format the file format.  DB.FTSV for tab-separated values, DB.FBINARY for
+   * length-prefixed binary records, DB.FSNAPSHOT for a snapshot.
+   * @param thnum the number of parser threads.
+   * @param batch the number of records stored at once by each parser.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note The file is read through a memory map in chunks split at record boundaries, and the
+   * chunks are parsed and stored by the parser threads without passing the Java heap.  A line
+   * of tab-separated values is the key and the value separated by a tab, where a backslash, a
+   * tab, a line feed, and a carriage return are escaped as "\\", "\t", "\n", and "\r", and
+   * other control characters as "\x" and two hexadecimal digits.  A binary record is the
+   * 32-bit big-endian lengths of the key and the value followed by the key and the value.
+   * Records of the same key in different chunks may be stored in any order.  A snapshot is
+   * loaded in the same way as the load_snapshot method, regardless of the number of threads.
+   * If the checker returns false, the operation is stopped.
+   */
+  public native boolean import_file(String path, int format, int thnum, int batch,
+                                    ProgressChecker checker);
+  /**
+   * Export all records into a file.
+   * @param path the name of the destination file.
+   * @param format the file format.  DB.FTSV for tab-separated values, DB.FBINARY for
+   * length-prefixed binary records, DB.FSNAPSHOT for a snapshot.
+   * @return true on success, or false on failure.
+   */
+  public boolean export_file(String path, int format) {
+    return export_file(path, format, (byte[])null, (byte[])null, null);
+  }
+  /**
+   * Export records in a range of keys into a file.
+   * @note Equal to the original DB.export_file method except that the parameters are String.
+   * @see #export_file(String, int, byte[], byte[], ProgressChecker)
+   */
+  public boolean export_file(String path, int format, String begin, String end) {
+    return export_file(path, format, str_to_ary(begin), str_to_ary(end), null);
+  }
+  /**
+   * Export records in a range of keys into a file with progress checking.
+   * @param path the name of the destination file.
+   * @param format the file format.  DB.FTSV for tab-separated values, DB.FBINARY for
+   * length-prefixed binary records, DB.FSNAPSHOT for a snapshot.
+   * @param begin the inclusive lower bound of keys.  If it is null, no lower bound is specified.
+   * @param end the exclusive upper bound of keys.  If it is null, no upper bound is specified.
+   * @param checker a progress checker object.  If it is null, no checker is used.
+   * @return true on success, or false on failure.
+   * @note The formats are the same as those of the import_file method.  Keys are compared in
+   * the lexical order.  Tree databases are scanned from the lower bound to the upper bound and
+   * other databases are scanned entirely.  A range cannot be specified for a snapshot.  If the
+   * checker returns false, the operation is stopped.
+   */
+  public native boolean export_file(String path, int format, byte[] begin, byte[] end,
+                                    ProgressChecker checker);
   /**
    * Create a cursor object.
    * @return the return value is the created cursor object.  Each cursor should be disabled
    * with the Cursor#disable method when it is no longer in use.
    */
   public native Cursor cursor();
+  /**
+   * Set the group commit mode.
+   * @param enabled true to enable group commit, or false to disable it.
+   * @param hard true for physical synchronization with the device, or false for logical
+   * synchronization with the file system.
+   * @return true on success, or false on failure.
+   * @note In the group commit mode, the set, remove, set_bulk, and remove_bulk methods called
+   * by concurrent threads are queued and one of the callers applies all of the queued requests
+   * in one transaction.  Each caller returns after the transaction including its request has
+   * been committed.  The "atomic" parameter of the bulk methods is ignored.  If a bulk request
+   * fails partway, the records applied before the failure are committed together with the
+   * other requests in the transaction, and the caller gets the failure.  The mode should not
+   * be used together with explicit transactions by the begin_transaction method.
+   */
+  public native boolean tune_group_commit(boolean enabled, boolean hard);
+  /**
+   * Set the background synchronization mode.
+   * @param interval the maximum interval of synchronization in milliseconds.  If it is not more
+   * than 0, synchronization is not triggered by time.
+   * @param size the amount of updated data in bytes to trigger synchronization.  If it is not
+   * more than 0, synchronization is not triggered by the amount.
+   * @param hard true for physical synchronization with the device, or false for logical
+   * synchronization with the file system.
+   * @return true on success, or false on failure.
+   * @note A background thread synchronizes the database when either condition is met while the
+   * database is opened as a writer.  If both conditions are disabled, the thread is stopped.
+   */
+  public native boolean tune_background_sync(long interval, long size, boolean hard);
+  /**
+   * Get the sequence number of the last updating operation.
+   * @return the sequence number of the last updating operation.
+   * @note The sequence number is incremented for each updated record.
+   */
+  public native long sequence();
+  /**
+   * Get the sequence number of the last synchronized updating operation.
+   * @return the sequence number of the last synchronized updating operation.
+   */
+  public native long synced_sequence();
+  /**
+   * Get the time of the last synchronization.
+   * @return the time of the last synchronization in seconds since the UNIX epoch, or 0 if it
+   * has never been synchronized.
+   */
+  public native double synced_time();
+  /**
+   * Wait until updating operations up to a sequence number are synchronized.
+   * @param seq the sequence number returned by the sequence method.
+   * @return true on success, or false on failure.
+   * @note If background synchronization is running, this method asks the thread to synchronize
+   * immediately and waits for it.  Otherwise, the database is synchronized by the caller.
+   */
+  public native boolean synchronize_until(long seq);
+  /**
+   * Set the admission control of updating operations.
+   * @param ops the maximum number of updated records per second.  If it is not more than 0, the
+   * number is not limited.
+   * @param size the maximum amount of updated data in bytes per second.  If it is not more than
+   * 0, the amount is not limited.
+   * @param prior true to make updating operations give way to reading operations in progress,
+   * or false to treat them equally.
+   * @return true on success, or false on failure.
+   * @note Updating operations are delayed by token buckets with a capacity of one second.
+   * Reading operations are never delayed.  The number of delayed operations and the total time
+   * of the delay are reported as "throttle_count" and "throttle_time" by the status method.
+   */
+  public native boolean tune_throttle(long ops, long size, boolean prior);
+  /**
+   * Set the capture of changes.
+   * @param capacity the number of changes kept in the buffer.  It is rounded up to a power of 2.
+   * If it is not more than 0, changes are not captured.
+   * @param policy the policy when the buffer is full.  DB.CBLOCK to block the writer until
+   * changes are polled, DB.CDISCARD to discard the new change, DB.COVERWRITE to overwrite the
+   * oldest change.
+   * @return true on success, or false on failure.
+   * @note This method should be called before the database is opened.  Every updated record
+   * by any method including cursors, visitors, and bulk operations is appended to a lock-free
+   * ring buffer with a sequence number.  Discarded changes are counted as "cdc_dropped" by the
+   * status method, and overwritten ones leave a gap in the sequence numbers.
+   */
+  public native boolean tune_change_capture(int capacity, int policy);
+  /**
+   * Take captured changes out of the buffer.
+   * @param buf the buffer to store the packed changes.
+   * @param max the maximum number of changes to take.  If it is negative, no limit is specified.
+   * @return the number of changes stored, or -1 on failure.
+   * @note Each change is packed as the sequence number in 8 bytes, the change type (DB.CSET,
+   * DB.CREMOVE, or DB.CCLEAR) in 1 byte, the size of the key in 4 bytes, the size of the value
+   * in 4 bytes, the key, and the value, where numbers are in big endian.  The key and the value
+   * of DB.CCLEAR and the value of DB.CREMOVE are empty.  If the next change is larger than the
+   * buffer, it fails.  Changes are captured after the records are actually updated, and
+   * changes in a transaction are captured when it is committed.
+   */
+  public native int poll_changes(byte[] buf, int max);
+  /**
+   * Open a database file with an update log.
+   * @param path the path of a database file.
+   * @param mode the connection mode.  It is the same as the open method.
+   * @param ulog the path of the directory of the update log.  It is created if it does not
+   * exist.
+   * @param limit the size limit of each log file in bytes.  When a file exceeds it, a new file
+   * is created.  If it is not more than 0, no limit is specified.
+   * @return true on success, or false on failure.
+   * @note Every updated record is appended to the log with a time stamp in microseconds since
+   * the UNIX epoch, which is reported as "ulog_timestamp" by the status method.  Failed updates
+   * are not logged, and updates in a transaction are logged when it is committed.  The log is
+   * read by the ReplicationReader class.  Old log files can be removed by the application.
+   */
+  public native boolean open_with_ulog(String path, int mode, String ulog, long limit);
+  /**
+   * Add a secondary index.
+   * @param name the name of the index.
+   * @param path the path of the database file of the index.  It is opened with the same
+   * syntax as the open method.  A tree database is suggested for efficient lookup.
+   * @param kind the kind of the extractor of the indexed value.  DB.IRANGE for the byte range
+   * of the value, DB.IFIELD for a delimiter-separated field of the value, DB.IINTEGER for a
+   * fixed-width big-endian integer in the value.
+   * @param first the offset of the range or the integer, or the delimiter character of fields.
+   * @param second the length of the range, the index of the field starting with 0, or the
+   * width of the integer up to 8 bytes.  If the length or the width is not more than 0, it is
+   * to the end of the value or 8 bytes respectively.
+   * @return true on success, or false on failure.
+   * @note The database must be opened and no transaction may be in progress.  An existing index
+   * database is reused only if it was detached by closing the database and the record count,
+   * the file size, and the modification time of the database still match the ones stamped into
+   * it then, and the database has not been updated since it was opened.  Otherwise, the index
+   * database is cleared and built from the existing records while concurrent updates are held
+   * and applied afterwards, and lookups fail until the build finishes.  Then the index is updated
+   * by every updating method while the record is locked, so no extra read of the old value is
+   * needed.  A transaction of the database runs a transaction of the index database in step, so
+   * aborting it rolls back the index as well.  Records whose value does not contain the indexed
+   * part are not indexed.  The index is detached when the database is closed.
+   */
+  public native boolean add_index(String name, String path, int kind, int first, int second);
+  /**
+   * Look up primary keys by a secondary index.
+   * @param name the name of the index.
+   * @param value the indexed value.  For DB.IINTEGER, it is an integer in 8-byte big endian.
+   * @param max the maximum number to retrieve.  If it is negative, no limit is specified.
+   * @return an array of the primary keys, or null on failure.
+   */
+  public native byte[][] index_lookup(String name, byte[] value, long max);
+  /**
+   * Look up primary keys by a secondary index.
+   * Equal to the original DB.index_lookup method except that the parameter and the return
+   * value are String.
+   * @see #index_lookup(String, byte[], long)
+   */
+  public List<String> index_lookup(String name, String value, long max) {
+    byte[][] keys = index_lookup(name, str_to_ary(value), max);
+    if (keys == null) return null;
+    List<String> list = new ArrayList<String>(keys.length);
+    for (int i = 0; i < keys.length; i++) {
+      list.add(ary_to_str(keys[i]));
+    }
+    return list;
+  }
+  /**
+   * Look up primary keys by a secondary index of integers.
+   * Equal to the original DB.index_lookup method except that the parameter is an integer.
+   * @see #index_lookup(String, byte[], long)
+   */
+  public byte[][] index_lookup(String name, long value, long max) {
+    byte[] ary = new byte[8];
+    for (int i = 7; i >= 0; i--) {
+      ary[i] = (byte)value;
+      value >>>= 8;
+    }
+    return index_lookup(name, ary, max);
+  }
+  /**
+   * Set the bloom filter to skip lookups of missing keys.
+   * @param expected the expected number of keys.  If it is not more than 0, twice the number
+   * of records at opening is used.
+   * @param fprate the target false positive rate.  If it is not between 0 and 1, the filter is
+   * disabled.
+   * @return true on success, or false on failure.
+   * @note This method should be called before the database is opened.  The filter is loaded
+   * from the sidecar file whose path is the database path with the suffix ".kcbf" if the record
+   * count, the file size, and the modification time of the database match the ones recorded in
+   * it, or built by scanning the keys otherwise, and it is saved into the sidecar file when the
+   * database is closed.  Methods retrieving a single record, such as get and check,
+   * consult the filter before the database.  When many records are removed, the filter is
+   * rebuilt in the background.  Clearing the database in a transaction keeps the filter until
+   * the transaction is committed, and then it is rebuilt in the background.  The status method
+   * reports "bloom_fprate", "bloom_memory", "bloom_negatives", and so on.
+   */
+  public native boolean tune_bloom_filter(long expected, double fprate);
+  /**
+   * Set the front cache of hot records.
+   * @param capacity the capacity of the cache in bytes.  If it is not more than 0, the cache is
+   * disabled.
+   * @return true on success, or false on failure.
+   * @note This method should be called before the database is opened.  Values retrieved by
+   * methods for a single record, such as get and check, are kept in a cache striped into
+   * slots and evicted in LRU order, so repeated reads of hot records do not lock the database.
+   * Cached records are invalidated by every updating method.  The status method reports
+   * "fcache_hits", "fcache_misses", "fcache_evictions", "fcache_count", and "fcache_size".
+   */
+  public native boolean tune_front_cache(long capacity);
   /**
    * Set the rule about throwing exception.
    * @param codes an array of error codes.  If each method occurs an error corresponding to one
@@ -0,0 +1,85 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface of indexed database abstraction for values growing by appending.
+ * @note The records are stored in the database specified by the path given to the open method,
+ * and values appended by the append method are buffered and merged on memory, spilled into
+ * temporary databases when the buffer exceeds the cache limit, and merged into the database by
+ * the synchronize and close methods.  Therefore, appending is much faster than that of the DB
+ * class, but appended values may not be visible to reading methods until synchronization.
+ * Iteration, cursors, and scanning synchronize the database first.  Other methods behave as
+ * those of the DB class except that updates are not atomic across methods and transactions are
+ * not supported.
+ */
+public class IndexDB extends DB {
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance.
+   */
+  public IndexDB() {
+    this(0);
+  }
+  /**
+   * Create an instance with options.
+   * @param opts the optional features by bitwise-or: DB.GEXCEPTIONAL for the exceptional mode.
+   */
+  public IndexDB(int opts) {
+    super(opts);
+    initialize();
+  }
+  //----------------------------------------------------------------
+  // public methods
+  //----------------------------------------------------------------
+  /**
+   * Set the size limit of the buffer of appended values.
+   * @param limit the size limit in bytes.  If it is not more than 0, the default limit is used.
+   * @return true on success, or false on failure.
+   * @note This method must be called before the database is opened.
+   */
+  public native boolean tune_cache_limit(long limit);
+  /**
+   * Append the value of a record into the buffer.
+   * @param key the key.
+   * @param value the value.
+   * @return true on success, or false on failure.
+   * @note If no record corresponds to the key, a new record is created.  If the corresponding
+   * record exists, the given value is appended at the end of the existing value.  The bloom
+   * filter and the front cache are kept in sync.  If a secondary index, the change data capture,
+   * or the update log is enabled, the whole new value is needed, so the record is read and
+   * rewritten as with the append method of the DB class instead of being buffered.
+   */
+  public native boolean append(byte[] key, byte[] value);
+  //----------------------------------------------------------------
+  // private methods
+  //----------------------------------------------------------------
+  /**
+   * Initialize the indexed database.
+   */
+  private native void initialize();
+}
+
+
+
+// END OF FILE
@@ -0,0 +1,81 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface of database abstraction absorbing updates into on-memory tables.
+ * @note Updates are stored into the active memtable, which is an on-memory database specified
+ * by its own path, either a stash database (":") or a grass database ("%"), and reading a record
+ * looks up the active memtable, the frozen memtable, and the database specified by the path given
+ * to the open method in this order.  When the memory usage of the active memtable reaches the
+ * limit, it is swapped with the empty frozen memtable and a background thread writes the frozen
+ * memtable into the persistent database in ascending order of the keys, which turns random
+ * insertions into a tree database into sequential ones.  Writers are not blocked by the flush
+ * until the memory usage of both memtables reaches twice the limit; then they wait for the
+ * flush unless it fails.  Updates staying in the memtables are lost on a crash; the synchronize
+ * and close methods write them first.  Iteration, cursors, counting, and copying write the
+ * memtables first and work on the persistent database; updates by them are stored into the
+ * active memtable.  Transactions are not supported.  The status method reports
+ * "memtable_count", "memtable_frozen", "memtable_size", "memtable_frozen_size",
+ * "memtable_flushes", "memtable_flush_fails", and "memtable_flush_time" of the last flush in
+ * seconds.
+ */
+public class MemtableDB extends DB {
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance with a grass database as the memtable.
+   * @param limit the memory usage of the memtable to start flushing in bytes.
+   */
+  public MemtableDB(long limit) {
+    this("%", limit, 0);
+  }
+  /**
+   * Create an instance.
+   * @param memtable the path of the memtable.
+   * @param limit the memory usage of the memtable to start flushing in bytes.
+   */
+  public MemtableDB(String memtable, long limit) {
+    this(memtable, limit, 0);
+  }
+  /**
+   * Create an instance with options.
+   * @param memtable the path of the memtable.
+   * @param limit the memory usage of the memtable to start flushing in bytes.
+   * @param opts the optional features by bitwise-or: DB.GEXCEPTIONAL for the exceptional mode.
+   */
+  public MemtableDB(String memtable, long limit, int opts) {
+    super(opts);
+    initialize(memtable, limit);
+  }
+  //----------------------------------------------------------------
+  // private methods
+  //----------------------------------------------------------------
+  /**
+   * Initialize the memtables.
+   */
+  private native void initialize(String memtable, long limit);
+}
+
+
+
+// END OF FILE
@@ -0,0 +1,43 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface to check progress status of long operations.
+ */
+public interface ProgressChecker {
+  //----------------------------------------------------------------
+  // public methods
+  //----------------------------------------------------------------
+  /**
+   * Check the progress status.
+   * @param name the name of the process.
+   * @param message a supplement message.
+   * @param curcnt the count of the current step of the progress, or -1 if not applicable.
+   * @param allcnt the estimation count of all steps of the progress, or -1 if not applicable.
+   * @return true to continue the process, or false to stop the process.
+   */
+  public boolean check(String name, String message, long curcnt, long allcnt);
+}
+
+
+
+// END OF FILE
@@ -0,0 +1,111 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Reader of an update log to apply it to a replica database.
+ * @note The update log is written by a database opened with the DB.open_with_ulog method.  The
+ * reader tails the log files from a time stamp, so a replica can follow the primary database as
+ * a hot standby on the same host, or a snapshot can be rolled forward to a point in time.
+ */
+public class ReplicationReader {
+  //----------------------------------------------------------------
+  // static initializer
+  //----------------------------------------------------------------
+  static {
+    Loader.load();
+  }
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance.
+   * @param dir the path of the directory of the update log.
+   * @param ts the time stamp in microseconds since the UNIX epoch.  Only updates after it are
+   * read.  If it is not more than 0, all updates are read.
+   */
+  public ReplicationReader(String dir, long ts) {
+    initialize(dir, ts);
+  }
+  /**
+   * Release resources.
+   */
+  protected void finalize() {
+    destruct();
+  }
+  //----------------------------------------------------------------
+  // public methods
+  //----------------------------------------------------------------
+  /**
+   * Disable the reader.
+   * @note This method should be called explicitly when the reader is no longer in use.
+   */
+  public native void disable();
+  /**
+   * Apply updates to a replica database.
+   * @param db the replica database.
+   * @param max the maximum number of updates to apply.  If it is negative, no limit is
+   * specified.
+   * @return the number of applied updates, or -1 on failure.
+   * @note The updates are applied in one transaction.  If it returns 0, no more update is
+   * available for now and it can be called again later.
+   */
+  public int apply(DB db, int max) {
+    return apply(db, max, Long.MAX_VALUE);
+  }
+  /**
+   * Apply updates up to a time stamp to a replica database.
+   * @param db the replica database.
+   * @param max the maximum number of updates to apply.  If it is negative, no limit is
+   * specified.
+   * @param until the time stamp in microseconds since the UNIX epoch.  Updates after it are not
+   * applied.
+   * @return the number of applied updates, or -1 on failure.
+   * @note The updates are applied in one transaction.  On failure, the reader is rewound to the
+   * position before the call.
+   */
+  public native int apply(DB db, int max, long until);
+  /**
+   * Get the time stamp of the last applied update.
+   * @return the time stamp in microseconds since the UNIX epoch.
+   */
+  public native long timestamp();
+  //----------------------------------------------------------------
+  // private methods
+  //----------------------------------------------------------------
+  /**
+   * Initialize the object.
+   */
+  private native void initialize(String dir, long ts);
+  /**
+   * Release resources.
+   */
+  private native void destruct();
+  //----------------------------------------------------------------
+  // private fields
+  //----------------------------------------------------------------
+  /** The pointer to the native object */
+  private long ptr_ = 0;
+}
+
+
+
+// END OF FILE
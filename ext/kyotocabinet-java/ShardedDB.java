@@ -0,0 +1,65 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface of database abstraction distributing records into multiple databases.
+ * @note Each record is stored in the database selected by the MurMur hash value of the key, as
+ * calculated by Utility.hash_murmur, modulo the number of shards.  The path given to the open
+ * method is a template whose "%d" (or "%0Nd" for zero-padding) is replaced with the shard
+ * number, for example "casket-%02d.kch#bnum=1000000".  Bulk operations in atomic mode, the
+ * synchronize method without a file processor, and the clear method are performed on every
+ * shard in parallel threads.  Other methods behave as those of the DB class except that
+ * atomicity and transactions are guaranteed per shard only, and cursors traverse the shards one
+ * after another in order of the shard number.
+ */
+public class ShardedDB extends DB {
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance.
+   * @param num the number of shards.
+   */
+  public ShardedDB(int num) {
+    this(num, 0);
+  }
+  /**
+   * Create an instance with options.
+   * @param num the number of shards.
+   * @param opts the optional features by bitwise-or: DB.GEXCEPTIONAL for the exceptional mode.
+   */
+  public ShardedDB(int num, int opts) {
+    super(opts);
+    initialize(num);
+  }
+  //----------------------------------------------------------------
+  // private methods
+  //----------------------------------------------------------------
+  /**
+   * Initialize the shards.
+   */
+  private native void initialize(int num);
+}
+
+
+
+// END OF FILE
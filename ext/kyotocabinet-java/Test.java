@@ -18,6 +18,7 @@ package kyotocabinet;
 import java.util.*;
 import java.io.*;
 import java.net.*;
+import java.nio.*;
 
 
 /**
@@ -39,6 +40,8 @@ public class Test {
       rv = runmisc(args);
     } else if (args[0].equals("memsize")) {
       rv = runmemsize(args);
+    } else if (args[0].equals("memsweep")) {
+      rv = runmemsweep(args);
     } else {
       usage();
     }
@@ -59,7 +62,8 @@ public class Test {
     STDERR.printf("  order [-th num] [-rnd] [-etc] path rnum\n");
     STDERR.printf("  wicked [-th num] [-it num] path rnum\n");
     STDERR.printf("  misc path\n");
-    STDERR.printf("  memsize [rnum [path]]\n");
+    STDERR.printf("  memsize [-ks num] [-vs num] [-bulk num] [rnum [path]]\n");
+    STDERR.printf("  memsweep [-rn num,...] [-ks num,...] [-vs num,...] [-bulk num] [path...]\n");
     STDERR.printf("\n");
     System.exit(1);
   }
@@ -170,10 +174,24 @@ public class Test {
   private static int runmemsize(String[] args) {
     String rstr = null;
     String path = null;
+    int ksiz = 8;
+    int vsiz = 8;
+    int bnum = 0;
     for (int i = 1; i < args.length; i++) {
       String arg = args[i];
-      if (path == null && arg.startsWith("-")) {
-        usage();
+      if (rstr == null && arg.startsWith("-")) {
+        if (arg.equals("-ks")) {
+          if (++i >= args.length) usage();
+          ksiz = (int)Utility.atoix(args[i]);
+        } else if (arg.equals("-vs")) {
+          if (++i >= args.length) usage();
+          vsiz = (int)Utility.atoix(args[i]);
+        } else if (arg.equals("-bulk")) {
+          if (++i >= args.length) usage();
+          bnum = (int)Utility.atoix(args[i]);
+        } else {
+          usage();
+        }
       } else if (rstr == null) {
         rstr = arg;
       } else if (path == null) {
@@ -183,8 +201,48 @@ public class Test {
       }
     }
     long rnum = rstr != null ? Utility.atoix(rstr) : 1000000;
-    if (rnum < 1) usage();
-    int rv = procmemsize(rnum, path);
+    if (rnum < 1 || ksiz < 1 || vsiz < 0 || bnum < 0) usage();
+    int rv = procmemsize(rnum, path, ksiz, vsiz, bnum);
+    return rv;
+  }
+  /** parse arguments of memsweep command */
+  private static int runmemsweep(String[] args) {
+    String rnstr = "10000,100000";
+    String ksstr = "8,32";
+    String vsstr = "8,128,1024";
+    int bnum = 1000;
+    List<String> paths = new ArrayList<String>();
+    for (int i = 1; i < args.length; i++) {
+      String arg = args[i];
+      if (paths.isEmpty() && arg.startsWith("-") && arg.length() > 1) {
+        if (arg.equals("-rn")) {
+          if (++i >= args.length) usage();
+          rnstr = args[i];
+        } else if (arg.equals("-ks")) {
+          if (++i >= args.length) usage();
+          ksstr = args[i];
+        } else if (arg.equals("-vs")) {
+          if (++i >= args.length) usage();
+          vsstr = args[i];
+        } else if (arg.equals("-bulk")) {
+          if (++i >= args.length) usage();
+          bnum = (int)Utility.atoix(args[i]);
+        } else {
+          usage();
+        }
+      } else {
+        paths.add(arg);
+      }
+    }
+    if (paths.isEmpty()) {
+      String[] defpaths = { "-", "+", ":", "*", "%", "casket.kch", "casket.kct" };
+      paths.addAll(Arrays.asList(defpaths));
+    }
+    long[] rnums = numlist(rnstr);
+    long[] ksizs = numlist(ksstr);
+    long[] vsizs = numlist(vsstr);
+    if (rnums == null || ksizs == null || vsizs == null || bnum < 0) usage();
+    int rv = procmemsweep(paths, rnums, ksizs, vsizs, bnum);
     return rv;
   }
   /** perform order command */
@@ -1279,6 +1337,534 @@ public class Test {
         dberrprint(db, "DB::transaction");
         err = true;
       }
+      printf("performing group commit:\n");
+      if (!db.tune_group_commit(true, false)) {
+        dberrprint(db, "DB::tune_group_commit");
+        err = true;
+      }
+      cnt = db.count();
+      class Committer extends Thread {
+        Committer(DB db, int id) {
+          db_ = db;
+          id_ = id;
+        }
+        public void run() {
+          for (int i = 0; i < 100; i++) {
+            String key = String.format("gc:%d:%d", id_, i);
+            if (!db_.set(key, key)) {
+              dberrprint(db_, "DB::set");
+              err_ = true;
+            }
+            if (i % 2 == 0 && !db_.remove(key)) {
+              dberrprint(db_, "DB::remove");
+              err_ = true;
+            }
+          }
+          byte[][] grecs = new byte[10][];
+          for (int i = 0; i < grecs.length; i++) {
+            grecs[i] = String.format("gc:%d:bulk:%d", id_, i / 2).getBytes();
+          }
+          if (db_.set_bulk(grecs, false) != grecs.length / 2) {
+            dberrprint(db_, "DB::set_bulk");
+            err_ = true;
+          }
+        }
+        boolean error() {
+          return err_;
+        }
+        private DB db_;
+        private int id_;
+        private boolean err_ = false;
+      }
+      Committer[] committers = new Committer[4];
+      for (int i = 0; i < committers.length; i++) {
+        committers[i] = new Committer(db, i);
+        committers[i].start();
+      }
+      for (int i = 0; i < committers.length; i++) {
+        try {
+          committers[i].join();
+        } catch (InterruptedException e) {
+          e.printStackTrace();
+        }
+        if (committers[i].error()) err = true;
+      }
+      if (db.count() != cnt + committers.length * 55) {
+        dberrprint(db, "DB::count");
+        err = true;
+      }
+      if (!db.tune_group_commit(false, false)) {
+        dberrprint(db, "DB::tune_group_commit");
+        err = true;
+      }
+      printf("performing background synchronization:\n");
+      if (!db.tune_background_sync(100, 1 << 20, false)) {
+        dberrprint(db, "DB::tune_background_sync");
+        err = true;
+      }
+      long seq = db.sequence();
+      for (int i = 0; i < 100; i++) {
+        String key = String.format("bs:%d", i);
+        db.set(key, key);
+      }
+      if (db.sequence() != seq + 100) {
+        dberrprint(db, "DB::sequence");
+        err = true;
+      }
+      seq = db.sequence();
+      if (!db.synchronize_until(seq)) {
+        dberrprint(db, "DB::synchronize_until");
+        err = true;
+      }
+      if (db.synced_sequence() < seq || db.synced_time() <= 0) {
+        dberrprint(db, "DB::synced_sequence");
+        err = true;
+      }
+      if (!db.tune_background_sync(0, 0, false)) {
+        dberrprint(db, "DB::tune_background_sync");
+        err = true;
+      }
+      printf("performing throttled updates:\n");
+      if (!db.tune_throttle(1000, 0, true)) {
+        dberrprint(db, "DB::tune_throttle");
+        err = true;
+      }
+      for (int i = 0; i < 2000; i++) {
+        String key = String.format("th:%d", i);
+        db.set(key, key);
+      }
+      Map<String, String> thstatus = db.status();
+      if (thstatus == null || !thstatus.containsKey("throttle_count") ||
+          Utility.atoi(thstatus.get("throttle_count")) < 1) {
+        dberrprint(db, "DB::status");
+        err = true;
+      }
+      if (!db.tune_throttle(0, 0, false)) {
+        dberrprint(db, "DB::tune_throttle");
+        err = true;
+      }
+      printf("performing change capture:\n");
+      DB cdb = new DB();
+      if (!cdb.tune_change_capture(64, DB.CBLOCK)) {
+        dberrprint(cdb, "DB::tune_change_capture");
+        err = true;
+      }
+      if (!cdb.open("*", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(cdb, "DB::open");
+        err = true;
+      }
+      if (cdb.tune_change_capture(64, DB.CBLOCK)) {
+        dberrprint(cdb, "DB::tune_change_capture");
+        err = true;
+      }
+      for (int i = 0; i < 10; i++) {
+        String key = String.format("cdc:%d", i);
+        cdb.set(key, key);
+      }
+      byte[][] cdrecs = new byte[20][];
+      for (int i = 0; i < cdrecs.length; i++) {
+        cdrecs[i] = String.format("cdc:%d", 10 + i / 2).getBytes();
+      }
+      cdb.set_bulk(cdrecs, false);
+      cdb.remove("cdc:0");
+      cdb.remove("cdc:none");
+      cdb.begin_transaction(false);
+      cdb.set("cdc:aborted", "x");
+      cdb.end_transaction(false);
+      cdb.clear();
+      byte[] cdbuf = new byte[64];
+      long cdseq = 0;
+      int[] cdnums = new int[4];
+      while (true) {
+        int cdnum = cdb.poll_changes(cdbuf, 3);
+        if (cdnum < 1) {
+          if (cdnum < 0) {
+            dberrprint(cdb, "DB::poll_changes");
+            err = true;
+          }
+          break;
+        }
+        ByteBuffer cdbb = ByteBuffer.wrap(cdbuf);
+        for (int i = 0; i < cdnum; i++) {
+          long cdsn = cdbb.getLong();
+          int type = cdbb.get();
+          int ksiz = cdbb.getInt();
+          int vsiz = cdbb.getInt();
+          cdbb.position(cdbb.position() + ksiz + vsiz);
+          if (cdsn != cdseq + 1 || type < DB.CSET || type > DB.CCLEAR) {
+            dberrprint(cdb, "DB::poll_changes");
+            err = true;
+          }
+          cdseq = cdsn;
+          cdnums[type]++;
+        }
+      }
+      if (cdnums[DB.CSET] != 20 || cdnums[DB.CREMOVE] != 1 || cdnums[DB.CCLEAR] != 1) {
+        dberrprint(cdb, "DB::poll_changes");
+        err = true;
+      }
+      if (!cdb.close()) {
+        dberrprint(cdb, "DB::close");
+        err = true;
+      }
+      printf("performing front cache:\n");
+      DB fcdb = new DB();
+      if (!fcdb.tune_front_cache(1 << 20)) {
+        dberrprint(fcdb, "DB::tune_front_cache");
+        err = true;
+      }
+      if (!fcdb.open("*", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(fcdb, "DB::open");
+        err = true;
+      }
+      for (int i = 0; i < 100; i++) {
+        fcdb.set(String.format("fc:%d", i), String.format("%d", i));
+      }
+      for (int i = 0; i < 300; i++) {
+        String key = String.format("fc:%d", i % 100);
+        if (!String.format("%d", i % 100).equals(fcdb.get(key))) {
+          dberrprint(fcdb, "DB::get");
+          err = true;
+        }
+      }
+      fcdb.set("fc:1", "one");
+      fcdb.append("fc:2", "two");
+      fcdb.remove("fc:3");
+      if (!"one".equals(fcdb.get("fc:1")) || !"2two".equals(fcdb.get("fc:2")) ||
+          fcdb.get("fc:3") != null) {
+        dberrprint(fcdb, "DB::get");
+        err = true;
+      }
+      fcdb.begin_transaction(false);
+      fcdb.set("fc:5", "five");
+      fcdb.get("fc:5");
+      fcdb.end_transaction(false);
+      if (!"5".equals(fcdb.get("fc:5"))) {
+        dberrprint(fcdb, "DB::get");
+        err = true;
+      }
+      Map<String, String> fcstatus = fcdb.status();
+      if (fcstatus == null || Utility.atoi(fcstatus.get("fcache_hits")) < 200) {
+        dberrprint(fcdb, "DB::status");
+        err = true;
+      }
+      if (!fcdb.close()) {
+        dberrprint(fcdb, "DB::close");
+        err = true;
+      }
+      printf("performing secondary index:\n");
+      DB idb = new DB();
+      if (!idb.open("*", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(idb, "DB::open");
+        err = true;
+      }
+      for (int i = 0; i < 50; i++) {
+        idb.set(String.format("ix:%d", i), String.format("%d\tgroup:%d", i, i % 5));
+      }
+      if (!idb.add_index("group", "%", DB.IFIELD, '\t', 1)) {
+        dberrprint(idb, "DB::add_index");
+        err = true;
+      }
+      if (idb.add_index("group", "%", DB.IFIELD, '\t', 1)) {
+        dberrprint(idb, "DB::add_index");
+        err = true;
+      }
+      for (int i = 50; i < 100; i++) {
+        idb.set(String.format("ix:%d", i), String.format("%d\tgroup:%d", i, i % 5));
+      }
+      List<String> ixkeys = idb.index_lookup("group", "group:3", -1);
+      if (ixkeys == null || ixkeys.size() != 20 || !ixkeys.contains("ix:93")) {
+        dberrprint(idb, "DB::index_lookup");
+        err = true;
+      }
+      idb.set("ix:3", "3\tgroup:4");
+      idb.remove("ix:8");
+      idb.append("ix:13", "x");
+      ixkeys = idb.index_lookup("group", "group:3", -1);
+      if (ixkeys == null || ixkeys.size() != 17 || ixkeys.contains("ix:3")) {
+        dberrprint(idb, "DB::index_lookup");
+        err = true;
+      }
+      ixkeys = idb.index_lookup("group", "group:3", 5);
+      if (ixkeys == null || ixkeys.size() != 5) {
+        dberrprint(idb, "DB::index_lookup");
+        err = true;
+      }
+      if (!idb.begin_transaction(false)) {
+        dberrprint(idb, "DB::begin_transaction");
+        err = true;
+      }
+      idb.set("ix:23", "23\tgroup:1");
+      idb.set("ix:200", "200\tgroup:3");
+      idb.remove("ix:18");
+      if (!idb.end_transaction(false)) {
+        dberrprint(idb, "DB::end_transaction");
+        err = true;
+      }
+      ixkeys = idb.index_lookup("group", "group:3", -1);
+      if (ixkeys == null || ixkeys.size() != 17 || !ixkeys.contains("ix:23") ||
+          !ixkeys.contains("ix:18") || ixkeys.contains("ix:200")) {
+        dberrprint(idb, "DB::index_lookup");
+        err = true;
+      }
+      idb.clear();
+      ixkeys = idb.index_lookup("group", "group:4", -1);
+      if (ixkeys == null || ixkeys.size() != 0 || idb.index_lookup("none", "x", -1) != null) {
+        dberrprint(idb, "DB::index_lookup");
+        err = true;
+      }
+      if (!idb.close()) {
+        dberrprint(idb, "DB::close");
+        err = true;
+      }
+      printf("performing bulk increment:\n");
+      DB ndb = new DB();
+      if (!ndb.open("%", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(ndb, "DB::open");
+        err = true;
+      }
+      byte[][] nkeys = new byte[10][];
+      long[] nnums = new long[10];
+      double[] ndnums = new double[10];
+      for (int i = 0; i < nkeys.length; i++) {
+        nkeys[i] = String.format("cnt:%d", i % 4).getBytes();
+        nnums[i] = i;
+        ndnums[i] = 0.25;
+      }
+      long[] nresults = new long[10];
+      if (!ndb.increment_bulk(nkeys, nnums, nresults, 0, true) || nresults[9] != 15 ||
+          ndb.increment("cnt:0".getBytes(), 0, 0) != 12) {
+        dberrprint(ndb, "DB::increment_bulk");
+        err = true;
+      }
+      ndb.set("cnt:3", "x");
+      if (ndb.increment_bulk(nkeys, nnums, null, 0, true) ||
+          ndb.increment("cnt:1".getBytes(), 0, 0) != 15) {
+        dberrprint(ndb, "DB::increment_bulk");
+        err = true;
+      }
+      double[] ndresults = new double[10];
+      byte[][] ndkeys = new byte[][] { "dcnt:a".getBytes(), "dcnt:b".getBytes(),
+                                       "dcnt:a".getBytes() };
+      if (!ndb.increment_double_bulk(ndkeys, ndnums, ndresults, 1.0, false) ||
+          ndresults[2] != 1.5 || ndb.increment_double("dcnt:b".getBytes(), 0, 0) != 1.25) {
+        dberrprint(ndb, "DB::increment_double_bulk");
+        err = true;
+      }
+      if (!ndb.close()) {
+        dberrprint(ndb, "DB::close");
+        err = true;
+      }
+      printf("performing conditional bulk writes:\n");
+      DB wdb = new DB();
+      if (!wdb.open("%", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(wdb, "DB::open");
+        err = true;
+      }
+      byte[][] wkeys = new byte[10][];
+      byte[][] wvals = new byte[10][];
+      for (int i = 0; i < wkeys.length; i++) {
+        wkeys[i] = String.format("cw:%d", i).getBytes();
+        wvals[i] = String.format("%d", i).getBytes();
+      }
+      wdb.set("cw:3", "x");
+      if (wdb.add_bulk(wkeys, wvals, true) != null || wdb.count() != 1) {
+        dberrprint(wdb, "DB::add_bulk");
+        err = true;
+      }
+      byte[] wbits = wdb.add_bulk(wkeys, wvals, false);
+      if (wbits == null || wbits.length != 2 || wbits[0] != (byte)0xf7 || wbits[1] != 0x03 ||
+          wdb.count() != 10) {
+        dberrprint(wdb, "DB::add_bulk");
+        err = true;
+      }
+      byte[][] wnvals = new byte[10][];
+      for (int i = 0; i < wnvals.length; i++) {
+        wnvals[i] = i % 2 == 0 ? "even".getBytes() : null;
+      }
+      if (wdb.cas_bulk(wkeys, wvals, wnvals, true) != null || !"0".equals(wdb.get("cw:0"))) {
+        dberrprint(wdb, "DB::cas_bulk");
+        err = true;
+      }
+      wbits = wdb.cas_bulk(wkeys, wvals, wnvals, false);
+      if (wbits == null || wbits[0] != (byte)0xf7 || !"even".equals(wdb.get("cw:0")) ||
+          wdb.get("cw:1") != null || !"x".equals(wdb.get("cw:3")) || wdb.count() != 6) {
+        dberrprint(wdb, "DB::cas_bulk");
+        err = true;
+      }
+      if (!wdb.close()) {
+        dberrprint(wdb, "DB::close");
+        err = true;
+      }
+      printf("performing bulk existence check:\n");
+      DB xdb = new DB();
+      if (!xdb.open("%", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(xdb, "DB::open");
+        err = true;
+      }
+      byte[][] xkeys = new byte[70][];
+      for (int i = 0; i < xkeys.length; i++) {
+        xkeys[i] = String.format("ex:%d", i).getBytes();
+        if (i % 3 == 0) xdb.set(xkeys[i], new byte[i]);
+      }
+      int[] xsizes = new int[70];
+      if (xdb.check_bulk(xkeys, xsizes) != 24 || xsizes[66] != 66 || xsizes[67] != -1) {
+        dberrprint(xdb, "DB::check_bulk");
+        err = true;
+      }
+      long[] xbits = xdb.contains_bulk(xkeys);
+      if (xbits == null || xbits.length != 2 || (xbits[0] & 0xf) != 0x9 || xbits[1] != 0x24) {
+        dberrprint(xdb, "DB::contains_bulk");
+        err = true;
+      }
+      if (!xdb.close()) {
+        dberrprint(xdb, "DB::close");
+        err = true;
+      }
+      printf("performing range removal:\n");
+      String[] rnames = { "%", "*" };
+      for (String rname : rnames) {
+        DB rdb = new DB();
+        if (!rdb.open(rname, DB.OWRITER | DB.OCREATE)) {
+          dberrprint(rdb, "DB::open");
+          err = true;
+        }
+        for (int i = 0; i < 100; i++) {
+          rdb.set(String.format("t1:%03d", i), "1");
+          rdb.set(String.format("t2:%03d", i), "2");
+        }
+        if (rdb.remove_prefix("t1:") != 100 || rdb.count() != 100) {
+          dberrprint(rdb, "DB::remove_prefix");
+          err = true;
+        }
+        if (rdb.remove_range("t2:010".getBytes(), "t2:020".getBytes(), 3, 0) != 10 ||
+            rdb.count() != 90 || rdb.check("t2:009") < 0 || rdb.check("t2:020") < 0) {
+          dberrprint(rdb, "DB::remove_range");
+          err = true;
+        }
+        if (rdb.remove_range(null, "t2:050") != 40 || rdb.remove_range("t2:090", null) != 10 ||
+            rdb.count() != 40) {
+          dberrprint(rdb, "DB::remove_range");
+          err = true;
+        }
+        if (!rdb.close()) {
+          dberrprint(rdb, "DB::close");
+          err = true;
+        }
+      }
+      printf("performing native transformations:\n");
+      String[] unames = { "%", "*" };
+      for (String uname : unames) {
+        DB udb = new DB();
+        if (!udb.open(uname, DB.OWRITER | DB.OCREATE)) {
+          dberrprint(udb, "DB::open");
+          err = true;
+        }
+        for (int i = 0; i < 20; i++) {
+          udb.set(String.format("u:%02d", i), "a,b,c");
+        }
+        udb.set("n:1".getBytes(), ByteBuffer.allocate(8).putLong(5).array());
+        if (udb.update_where("u:05".getBytes(), "u:10".getBytes(), DB.TFIELD, 1, ',',
+                             "x".getBytes()) != 5 || !"a,x,c".equals(udb.get("u:05")) ||
+            !"a,b,c".equals(udb.get("u:10"))) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        if (udb.update_where("u:".getBytes(), "u;".getBytes(), DB.TAPPEND, 0, 0,
+                             ",d".getBytes()) != 20 || !"a,b,c,d".equals(udb.get("u:00"))) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        if (udb.update_where("u:".getBytes(), "u:01".getBytes(), DB.TPREPEND, 0, 0,
+                             "v".getBytes()) != 1 ||
+            !"va,b,c,d".equals(udb.get("u:00"))) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        if (udb.update_where("u:19".getBytes(), null, DB.TSET, 0, 0, "Z".getBytes()) != 1 ||
+            !"Z,b,c,d".equals(udb.get("u:19"))) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        long ucnt = udb.update_where("n:".getBytes(), "n;".getBytes(), DB.TINCINT, 0, 3, null);
+        byte[] uval = udb.get("n:1".getBytes());
+        if (ucnt != 1 || uval == null || ByteBuffer.wrap(uval).getLong() != 8) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        if (udb.update_where("u:10".getBytes(), "u:15".getBytes(), DB.TREMOVE, 0, 0, null,
+                             2, null) != 5 || udb.count() != 16) {
+          dberrprint(udb, "DB::update_where");
+          err = true;
+        }
+        if (!udb.close()) {
+          dberrprint(udb, "DB::close");
+          err = true;
+        }
+      }
+      printf("performing merge operators:\n");
+      DB mdb = new DB();
+      if (!mdb.open("%", DB.OWRITER | DB.OCREATE)) {
+        dberrprint(mdb, "DB::open");
+        err = true;
+      }
+      for (int i = 1; i <= 10; i++) {
+        byte[] mnum = ByteBuffer.allocate(8).putLong(i).array();
+        if (!mdb.merge_value("mg:int".getBytes(), DB.VADDINT, mnum) ||
+            !mdb.merge_value("mg:max".getBytes(), DB.VMAXINT, mnum)) {
+          dberrprint(mdb, "DB::merge_value");
+          err = true;
+        }
+      }
+      byte[] mval = mdb.get("mg:int".getBytes());
+      if (mval == null || ByteBuffer.wrap(mval).getLong() != 55) {
+        dberrprint(mdb, "DB::merge_value");
+        err = true;
+      }
+      mval = mdb.get("mg:max".getBytes());
+      if (mval == null || ByteBuffer.wrap(mval).getLong() != 10) {
+        dberrprint(mdb, "DB::merge_value");
+        err = true;
+      }
+      if (mdb.merge_value("mg:int".getBytes(), DB.VADDINT, "x".getBytes())) {
+        dberrprint(mdb, "DB::merge_value");
+        err = true;
+      }
+      mdb.merge_value("mg:set", DB.VUNION, "b\nd", 3);
+      mdb.merge_value("mg:set", DB.VUNION, "a\nc\nd", 3);
+      if (!"b\nc\nd".equals(mdb.get("mg:set"))) {
+        dberrprint(mdb, "DB::merge_value");
+        err = true;
+      }
+      byte[][] mrecs = new byte[20][];
+      for (int i = 0; i < 10; i++) {
+        mrecs[i*2] = String.format("mg:%d", i % 3).getBytes();
+        mrecs[i*2+1] = ByteBuffer.allocate(8).putDouble(0.5).array();
+      }
+      if (mdb.merge_value_bulk(mrecs, DB.VADDDBL, 0, true) != 10) {
+        dberrprint(mdb, "DB::merge_value_bulk");
+        err = true;
+      }
+      mval = mdb.get("mg:0".getBytes());
+      if (mval == null || ByteBuffer.wrap(mval).getDouble() != 2.0) {
+        dberrprint(mdb, "DB::merge_value_bulk");
+        err = true;
+      }
+      byte[][] mbad = { "mg:0".getBytes(), ByteBuffer.allocate(8).putDouble(1.0).array(),
+                        "mg:set".getBytes(), ByteBuffer.allocate(8).putDouble(1.0).array() };
+      if (mdb.merge_value_bulk(mbad, DB.VADDDBL, 0, true) != -1) {
+        dberrprint(mdb, "DB::merge_value_bulk");
+        err = true;
+      }
+      mval = mdb.get("mg:0".getBytes());
+      if (mval == null || ByteBuffer.wrap(mval).getDouble() != 2.0) {
+        dberrprint(mdb, "DB::merge_value_bulk");
+        err = true;
+      }
+      if (!mdb.close()) {
+        dberrprint(mdb, "DB::close");
+        err = true;
+      }
       String corepath = db.path();
       String suffix = null;
       if (corepath.endsWith(".kch")) {
@@ -1312,6 +1898,21 @@ public class Test {
           dberrprint(db, "DB::merge");
           err = true;
         }
+        class CheckerImpl implements ProgressChecker {
+          public boolean check(String name, String message, long curcnt, long allcnt) {
+            count_++;
+            return true;
+          }
+          long count() {
+            return count_;
+          }
+          private long count_ = 0;
+        }
+        CheckerImpl checker = new CheckerImpl();
+        if (!db.merge(srcary, DB.MADD, checker) || checker.count() < 2) {
+          dberrprint(db, "DB::merge");
+          err = true;
+        }
         for (int i = 0; i < copypaths.length; i++) {
           if (!srcary[i].close()) {
             dberrprint(srcary[i], "DB::close");
@@ -1319,6 +1920,528 @@ public class Test {
           }
           Utility.remove_files_recursively(copypaths[i]);
         }
+        DB[] mgsrcary = new DB[2];
+        for (int i = 0; i < mgsrcary.length; i++) {
+          mgsrcary[i] = new DB();
+          if (!mgsrcary[i].open("%", DB.OWRITER | DB.OCREATE)) {
+            dberrprint(mgsrcary[i], "DB::open");
+            err = true;
+          }
+          for (int j = i; j < i + 3; j++) {
+            mgsrcary[i].set(String.format("mg:%d", j), String.format("%d", i + 1));
+          }
+        }
+        int[] mgmodes = { DB.MSET, DB.MADD, DB.MREPLACE, DB.MAPPEND };
+        String[][] mgexpects = {
+          { "1", "2", "2", "2" },
+          { "0", "0", "1", "2" },
+          { "1", "2", null, null },
+          { "01", "012", "12", "2" },
+        };
+        for (int i = 0; i < mgmodes.length; i++) {
+          DB mgdb = new DB();
+          if (!mgdb.open("%", DB.OWRITER | DB.OCREATE)) {
+            dberrprint(mgdb, "DB::open");
+            err = true;
+          }
+          mgdb.set("mg:0", "0");
+          mgdb.set("mg:1", "0");
+          if (!mgdb.merge(mgsrcary, mgmodes[i])) {
+            dberrprint(mgdb, "DB::merge");
+            err = true;
+          }
+          for (int j = 0; j < mgexpects[i].length; j++) {
+            String value = mgdb.get(String.format("mg:%d", j));
+            if (mgexpects[i][j] == null ? value != null : !mgexpects[i][j].equals(value)) {
+              dberrprint(mgdb, "DB::merge");
+              err = true;
+            }
+          }
+          if (!mgdb.close()) {
+            dberrprint(mgdb, "DB::close");
+            err = true;
+          }
+        }
+        for (int i = 0; i < mgsrcary.length; i++) {
+          if (!mgsrcary[i].close()) {
+            dberrprint(mgsrcary[i], "DB::close");
+            err = true;
+          }
+        }
+        printf("performing sharded database:\n");
+        int shnum = 3;
+        String shpath = String.format("%s.shard-%%d%s", corepath, suffix);
+        ShardedDB shdb = new ShardedDB(shnum);
+        if (!shdb.open(shpath, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+          dberrprint(shdb, "ShardedDB::open");
+          err = true;
+        }
+        for (int i = 0; i < 100; i++) {
+          String key = String.format("%d", i);
+          if (!shdb.set(key, key)) {
+            dberrprint(shdb, "ShardedDB::set");
+            err = true;
+          }
+        }
+        byte[][] shrecs = new byte[200][];
+        for (int i = 0; i < shrecs.length; i++) {
+          shrecs[i] = String.format("bulk:%d", i / 2).getBytes();
+        }
+        if (shdb.set_bulk(shrecs, true) != shrecs.length / 2) {
+          dberrprint(shdb, "ShardedDB::set_bulk");
+          err = true;
+        }
+        byte[][] shkeys = new byte[shrecs.length / 2][];
+        for (int i = 0; i < shkeys.length; i++) {
+          shkeys[i] = shrecs[i * 2];
+        }
+        byte[][] shvals = shdb.get_bulk(shkeys, true);
+        if (shvals == null || shvals.length != shkeys.length * 2) {
+          dberrprint(shdb, "ShardedDB::get_bulk");
+          err = true;
+        }
+        if (shdb.count() != 200) {
+          dberrprint(shdb, "ShardedDB::count");
+          err = true;
+        }
+        long shcnt = 0;
+        Cursor shcur = shdb.cursor();
+        shcur.jump();
+        while (shcur.get_key(true) != null) {
+          shcnt++;
+        }
+        shcur.disable();
+        if (shcnt != 200) {
+          dberrprint(shdb, "Cursor::step");
+          err = true;
+        }
+        if (!shdb.synchronize(false, null)) {
+          dberrprint(shdb, "ShardedDB::synchronize");
+          err = true;
+        }
+        if (!shdb.close()) {
+          dberrprint(shdb, "ShardedDB::close");
+          err = true;
+        }
+        for (int i = 0; i < shnum; i++) {
+          Utility.remove_files_recursively(String.format(shpath, i));
+        }
+        printf("performing tiered database:\n");
+        String tipath = corepath + ".tier" + suffix;
+        TieredDB tidb = new TieredDB("*#capcnt=50", 16);
+        if (!tidb.open(tipath, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+          dberrprint(tidb, "TieredDB::open");
+          err = true;
+        }
+        for (int i = 0; i < 100; i++) {
+          String key = String.format("%d", i);
+          if (!tidb.set(key, key)) {
+            dberrprint(tidb, "TieredDB::set");
+            err = true;
+          }
+        }
+        if (!tidb.remove("0")) {
+          dberrprint(tidb, "TieredDB::remove");
+          err = true;
+        }
+        if (tidb.get("0") != null || !"1".equals(tidb.get("1"))) {
+          dberrprint(tidb, "TieredDB::get");
+          err = true;
+        }
+        Map<String, String> tistat = tidb.status();
+        if (tistat == null || Long.parseLong(tistat.get("tier_dirty")) > 16) {
+          dberrprint(tidb, "TieredDB::status");
+          err = true;
+        }
+        if (tidb.count() != 99) {
+          dberrprint(tidb, "TieredDB::count");
+          err = true;
+        }
+        if (!tidb.close()) {
+          dberrprint(tidb, "TieredDB::close");
+          err = true;
+        }
+        tidb = new TieredDB("*#capcnt=50");
+        if (!tidb.open(tipath, DB.OREADER)) {
+          dberrprint(tidb, "TieredDB::open");
+          err = true;
+        }
+        for (int pass = 0; pass < 2; pass++) {
+          if (!"99".equals(tidb.get("99"))) {
+            dberrprint(tidb, "TieredDB::get");
+            err = true;
+          }
+        }
+        tistat = tidb.status();
+        if (tistat == null || !"1".equals(tistat.get("tier_store_hits")) ||
+            !"1".equals(tistat.get("tier_cache_hits"))) {
+          dberrprint(tidb, "TieredDB::status");
+          err = true;
+        }
+        if (!tidb.close()) {
+          dberrprint(tidb, "TieredDB::close");
+          err = true;
+        }
+        Utility.remove_files_recursively(tipath);
+        printf("performing memtable database:\n");
+        String mtpath = corepath + ".memtable" + suffix;
+        for (int pass = 0; pass < 2; pass++) {
+          MemtableDB mtdb = new MemtableDB(pass < 1 ? "%" : ":", 4096);
+          if (!mtdb.open(mtpath, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+            dberrprint(mtdb, "MemtableDB::open");
+            err = true;
+          }
+          for (int i = 0; i < 1000; i++) {
+            String key = String.format("%d", (i * 7919) % 1000);
+            if (!mtdb.set(key, key)) {
+              dberrprint(mtdb, "MemtableDB::set");
+              err = true;
+            }
+          }
+          for (int i = 0; i < 100; i++) {
+            if (!mtdb.remove(String.format("%d", i))) {
+              dberrprint(mtdb, "MemtableDB::remove");
+              err = true;
+            }
+          }
+          if (mtdb.get("1") != null || !"999".equals(mtdb.get("999"))) {
+            dberrprint(mtdb, "MemtableDB::get");
+            err = true;
+          }
+          if (mtdb.count() != 900) {
+            dberrprint(mtdb, "MemtableDB::count");
+            err = true;
+          }
+          Map<String, String> mtstat = mtdb.status();
+          if (mtstat == null || Long.parseLong(mtstat.get("memtable_flushes")) < 1) {
+            dberrprint(mtdb, "MemtableDB::status");
+            err = true;
+          }
+          if (!mtdb.close()) {
+            dberrprint(mtdb, "MemtableDB::close");
+            err = true;
+          }
+          DB mtchk = new DB();
+          if (!mtchk.open(mtpath, DB.OREADER) || mtchk.count() != 900) {
+            dberrprint(mtchk, "DB::count");
+            err = true;
+          }
+          mtchk.close();
+        }
+        Utility.remove_files_recursively(mtpath);
+        printf("performing bulk load:\n");
+        String blsrc = corepath + ".bulk.tsv";
+        try {
+          Writer blwriter = new OutputStreamWriter(new FileOutputStream(blsrc), "UTF-8");
+          for (int i = 0; i < 1000; i++) {
+            int num = (i * 7919) % 500;
+            blwriter.write(String.format("%08d\t%d\n", num, i));
+          }
+          blwriter.write("\nbl\\tesc\tx\\ny\r\n");
+          blwriter.close();
+        } catch (IOException e) {
+          printf("%s: FileOutputStream: %s\n", Test.class.getName(), e);
+          err = true;
+        }
+        DB bldb = new DB();
+        if (!bldb.open("%", DB.OWRITER | DB.OCREATE)) {
+          dberrprint(bldb, "DB::open");
+          err = true;
+        }
+        class BulkCheckerImpl implements ProgressChecker {
+          public boolean check(String name, String message, long curcnt, long allcnt) {
+            count_++;
+            return true;
+          }
+          long count() {
+            return count_;
+          }
+          private long count_ = 0;
+        }
+        BulkCheckerImpl blchecker = new BulkCheckerImpl();
+        if (!bldb.bulk_load(blsrc, null, 2, blchecker) || blchecker.count() < 3) {
+          dberrprint(bldb, "DB::bulk_load");
+          err = true;
+        }
+        if (bldb.count() != 501 || !"679".equals(bldb.get("00000001")) ||
+            !"500".equals(bldb.get("00000000")) || !"x\ny".equals(bldb.get("bl\tesc"))) {
+          dberrprint(bldb, "DB::get");
+          err = true;
+        }
+        if (bldb.bulk_load(blsrc)) {
+          dberrprint(bldb, "DB::bulk_load");
+          err = true;
+        }
+        if (!bldb.close()) {
+          dberrprint(bldb, "DB::close");
+          err = true;
+        }
+        Utility.remove_files_recursively(blsrc);
+        printf("performing file import and export:\n");
+        DB iesrc = new DB();
+        if (!iesrc.open("+", DB.OWRITER | DB.OCREATE)) {
+          dberrprint(iesrc, "DB::open");
+          err = true;
+        }
+        for (int i = 0; i < 1000; i++) {
+          String key = String.format("%04d", i);
+          if (!iesrc.set(key, String.format("v\t%d\n\\\r\u0001", i))) {
+            dberrprint(iesrc, "DB::set");
+            err = true;
+          }
+        }
+        int[] ieformats = { DB.FTSV, DB.FBINARY, DB.FSNAPSHOT };
+        for (int i = 0; i < ieformats.length; i++) {
+          String iepath = String.format("%s.export-%d", corepath, ieformats[i]);
+          if (!iesrc.export_file(iepath, ieformats[i])) {
+            dberrprint(iesrc, "DB::export_file");
+            err = true;
+          }
+          DB iedst = new DB();
+          if (!iedst.open("*", DB.OWRITER | DB.OCREATE)) {
+            dberrprint(iedst, "DB::open");
+            err = true;
+          }
+          if (!iedst.import_file(iepath, ieformats[i], 4, 100)) {
+            dberrprint(iedst, "DB::import_file");
+            err = true;
+          }
+          if (iedst.count() != 1000 || !iesrc.get("0123").equals(iedst.get("0123"))) {
+            dberrprint(iedst, "DB::get");
+            err = true;
+          }
+          if (ieformats[i] != DB.FSNAPSHOT) {
+            if (!iesrc.export_file(iepath, ieformats[i], "0100", "0200") ||
+                !iedst.clear() || !iedst.import_file(iepath, ieformats[i]) ||
+                iedst.count() != 100 || iedst.get("0099") != null) {
+              dberrprint(iedst, "DB::import_file");
+              err = true;
+            }
+          }
+          if (!iedst.close()) {
+            dberrprint(iedst, "DB::close");
+            err = true;
+          }
+          Utility.remove_files_recursively(iepath);
+        }
+        if (!iesrc.close()) {
+          dberrprint(iesrc, "DB::close");
+          err = true;
+        }
+        printf("performing indexed database:\n");
+        String ixpath = corepath + ".index" + suffix;
+        IndexDB ixdb = new IndexDB();
+        if (!ixdb.tune_cache_limit(1024)) {
+          dberrprint(ixdb, "IndexDB::tune_cache_limit");
+          err = true;
+        }
+        if (!ixdb.open(ixpath, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+          dberrprint(ixdb, "IndexDB::open");
+          err = true;
+        }
+        for (int i = 0; i < 1000; i++) {
+          if (!ixdb.append(String.format("term:%d", i % 10), "0123456789")) {
+            dberrprint(ixdb, "IndexDB::append");
+            err = true;
+          }
+        }
+        if (!ixdb.synchronize(false, null)) {
+          dberrprint(ixdb, "IndexDB::synchronize");
+          err = true;
+        }
+        String ixval = ixdb.get("term:3");
+        if (ixval == null || ixval.length() != 1000) {
+          dberrprint(ixdb, "IndexDB::get");
+          err = true;
+        }
+        long ixcnt = 0;
+        Cursor ixcur = ixdb.cursor();
+        ixcur.jump();
+        while (ixcur.get_key(true) != null) {
+          ixcnt++;
+        }
+        ixcur.disable();
+        if (ixcnt != 10) {
+          dberrprint(ixdb, "Cursor::step");
+          err = true;
+        }
+        if (!ixdb.close()) {
+          dberrprint(ixdb, "IndexDB::close");
+          err = true;
+        }
+        Utility.remove_files_recursively(ixpath);
+        printf("performing text database:\n");
+        String txpath = corepath + ".text.kcx";
+        TextDB txdb = new TextDB();
+        if (!txdb.open(txpath, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+          dberrprint(txdb, "TextDB::open");
+          err = true;
+        }
+        for (int i = 0; i < 3; i++) {
+          if (!txdb.append_line(String.format("line:%d", i))) {
+            dberrprint(txdb, "TextDB::append_line");
+            err = true;
+          }
+        }
+        if (!txdb.append_lines("line:3\nline:4\nline:5\n".getBytes())) {
+          dberrprint(txdb, "TextDB::append_lines");
+          err = true;
+        }
+        byte[][] txrecs = txdb.read_lines(0, -1);
+        if (txrecs == null || txrecs.length != 12 || !"line:5".equals(new String(txrecs[11]))) {
+          dberrprint(txdb, "TextDB::read_lines");
+          err = true;
+        } else {
+          long txpos = TextDB.key_position(new String(txrecs[8]));
+          byte[][] txrest = txdb.read_lines(txpos, 1);
+          if (txrest == null || txrest.length != 2 || !"line:4".equals(new String(txrest[1]))) {
+            dberrprint(txdb, "TextDB::read_lines");
+            err = true;
+          }
+          Cursor txcur = txdb.cursor();
+          if (!txcur.jump(TextDB.position_key(txpos)) ||
+              !"line:4".equals(txcur.get_value_str(false))) {
+            dberrprint(txdb, "Cursor::jump");
+            err = true;
+          }
+          txcur.disable();
+        }
+        if (!txdb.close()) {
+          dberrprint(txdb, "TextDB::close");
+          err = true;
+        }
+        Utility.remove_files_recursively(txpath);
+        printf("performing bloom filter:\n");
+        String bfpath = corepath + ".bloom" + suffix;
+        for (int pass = 0; pass < 2; pass++) {
+          DB bfdb = new DB();
+          if (!bfdb.tune_bloom_filter(0, 0.01)) {
+            dberrprint(bfdb, "DB::tune_bloom_filter");
+            err = true;
+          }
+          int bfmode = DB.OWRITER | DB.OCREATE | (pass < 1 ? DB.OTRUNCATE : 0);
+          if (!bfdb.open(bfpath, bfmode)) {
+            dberrprint(bfdb, "DB::open");
+            err = true;
+          }
+          for (int i = 0; i < 1000; i++) {
+            String key = String.format("bf:%d", i);
+            if (pass < 1) bfdb.set(key, key);
+            if (bfdb.get(key) == null) {
+              dberrprint(bfdb, "DB::get");
+              err = true;
+            }
+            if (bfdb.get(String.format("bf:miss:%d", i)) != null) {
+              dberrprint(bfdb, "DB::get");
+              err = true;
+            }
+          }
+          Map<String, String> bfstatus = bfdb.status();
+          if (bfstatus == null || Utility.atoi(bfstatus.get("bloom_negatives")) < 900) {
+            dberrprint(bfdb, "DB::status");
+            err = true;
+          }
+          if (!bfdb.begin_transaction(false)) {
+            dberrprint(bfdb, "DB::begin_transaction");
+            err = true;
+          }
+          if (!bfdb.clear()) {
+            dberrprint(bfdb, "DB::clear");
+            err = true;
+          }
+          if (!bfdb.end_transaction(false)) {
+            dberrprint(bfdb, "DB::end_transaction");
+            err = true;
+          }
+          if (bfdb.get("bf:0") == null || bfdb.get("bf:999") == null) {
+            dberrprint(bfdb, "DB::get");
+            err = true;
+          }
+          if (!bfdb.close()) {
+            dberrprint(bfdb, "DB::close");
+            err = true;
+          }
+          if (!new File(bfpath + ".kcbf").exists()) {
+            dberrprint(bfdb, "DB::close");
+            err = true;
+          }
+        }
+        Utility.remove_files_recursively(bfpath);
+        Utility.remove_files_recursively(bfpath + ".kcbf");
+        printf("performing compressed snapshot:\n");
+        String snappath = corepath + ".kcss";
+        checker = new CheckerImpl();
+        if (!db.dump_snapshot(snappath, "fast", checker) || checker.count() < 1) {
+          dberrprint(db, "DB::dump_snapshot");
+          err = true;
+        }
+        DB snapdb = new DB();
+        if (!snapdb.open("-", DB.OWRITER | DB.OCREATE)) {
+          dberrprint(snapdb, "DB::open");
+          err = true;
+        }
+        if (!snapdb.load_snapshot(snappath, null) || snapdb.count() != db.count()) {
+          dberrprint(snapdb, "DB::load_snapshot");
+          err = true;
+        }
+        if (!snapdb.close()) {
+          dberrprint(snapdb, "DB::close");
+          err = true;
+        }
+        class CancelImpl implements ProgressChecker {
+          public boolean check(String name, String message, long curcnt, long allcnt) {
+            return false;
+          }
+        }
+        if (db.dump_snapshot(snappath, null, new CancelImpl())) {
+          dberrprint(db, "DB::dump_snapshot");
+          err = true;
+        }
+        Utility.remove_files_recursively(snappath);
+        printf("performing update log replication:\n");
+        String ulpath = corepath + ".ulog";
+        DB uldb = new DB();
+        if (!uldb.open_with_ulog("-", DB.OWRITER | DB.OCREATE, ulpath, 1024)) {
+          dberrprint(uldb, "DB::open_with_ulog");
+          err = true;
+        }
+        for (int i = 0; i < 100; i++) {
+          String key = String.format("ul:%d", i);
+          uldb.set(key, key);
+          if (i % 10 == 0) uldb.remove(key);
+        }
+        DB repdb = new DB();
+        if (!repdb.open("-", DB.OWRITER | DB.OCREATE)) {
+          dberrprint(repdb, "DB::open");
+          err = true;
+        }
+        ReplicationReader reader = new ReplicationReader(ulpath, 0);
+        int repnum;
+        while ((repnum = reader.apply(repdb, 30)) > 0) {
+          if (repnum > 30) {
+            dberrprint(repdb, "ReplicationReader::apply");
+            err = true;
+          }
+        }
+        if (repnum < 0 || repdb.count() != uldb.count()) {
+          dberrprint(repdb, "ReplicationReader::apply");
+          err = true;
+        }
+        uldb.set("ul:tail", "tail");
+        if (reader.apply(repdb, -1) != 1 || !"tail".equals(repdb.get("ul:tail"))) {
+          dberrprint(repdb, "ReplicationReader::apply");
+          err = true;
+        }
+        reader.disable();
+        if (!repdb.close()) {
+          dberrprint(repdb, "DB::close");
+          err = true;
+        }
+        if (!uldb.close()) {
+          dberrprint(uldb, "DB::close");
+          err = true;
+        }
+        Utility.remove_files_recursively(ulpath);
       }
       printf("executing mapreduce process:\n");
       class MapReduceImpl extends MapReduce {
@@ -1388,14 +2511,17 @@ public class Test {
     return err ? 1 : 0;
   }
   /** perform memsize command */
-  private static int procmemsize(long rnum, String path) {
+  private static int procmemsize(long rnum, String path, int ksiz, int vsiz, int bnum) {
     System.gc();
     long musage = memusagerss();
+    long jusage = memusage();
+    long jtotal = Runtime.getRuntime().totalMemory();
     double stime = Utility.time();
     long count = -1;
+    DB db = null;
     if (path == null) {
-      int bnum = rnum < Integer.MAX_VALUE ? (int)rnum : Integer.MAX_VALUE;
-      Map<String, String> map = new HashMap<String, String>(bnum, 100);
+      int cap = rnum < Integer.MAX_VALUE ? (int)rnum : Integer.MAX_VALUE;
+      Map<String, String> map = new HashMap<String, String>(cap, 100);
       for (long i = 0; i < rnum; i++) {
         String key = String.format("%08d", i);
         String value = String.format("%08d", i);
@@ -1403,24 +2529,175 @@ public class Test {
       }
       count = map.size();
     } else {
-      DB db = new DB();
+      db = new DB();
       if (db.open(path, DB.OWRITER | DB.OCREATE | DB.OTRUNCATE)) {
+        byte[] value = memvalue(vsiz);
         for (long i = 0; i < rnum; i++) {
-          String key = String.format("%08d", i);
-          String value = String.format("%08d", i);
-          db.set(key, value);
+          db.set(memkey(i, ksiz), value);
         }
         count = db.count();
-        db.close();
+      } else {
+        dberrprint(db, "DB::open");
       }
     }
     printf("count: %d\n", count);
     double etime = Utility.time();
     printf("time: %.3f\n", etime - stime);
     System.gc();
-    printf("usage: %.3f MB\n", (memusagerss() - musage) / 1024.0 / 1024.0);
+    long rss = memusagerss() - musage;
+    long heap = memusage() - jusage;
+    long nusage = rss - (Runtime.getRuntime().totalMemory() - jtotal);
+    printf("usage: %.3f MB\n", rss / 1024.0 / 1024.0);
+    if (count > 0) {
+      printf("rss per record: %.1f\n", (double)rss / count);
+      printf("java per record: %.1f\n", (double)heap / count);
+      printf("native per record: %.1f\n", (double)nusage / count);
+    }
+    if (db != null && count > 0 && bnum > 0) {
+      printf("set_bulk peak: %d\n", membulkpeak(db, rnum, ksiz, vsiz, bnum, true));
+      printf("get_bulk peak: %d\n", membulkpeak(db, rnum, ksiz, vsiz, bnum, false));
+    }
+    if (db != null) db.close();
     return 0;
   }
+  /** perform memsweep command */
+  private static int procmemsweep(List<String> paths, long[] rnums, long[] ksizs, long[] vsizs,
+                                  int bnum) {
+    printf("<Memory Footprint Sweep>\n  paths=%s  bulk=%d\n\n", paths, bnum);
+    boolean err = false;
+    String java = System.getProperty("java.home") + File.separator + "bin" + File.separator +
+        "java";
+    printf("%-12s %10s %6s %6s %10s %10s %10s %12s %12s\n", "path", "rnum", "ksiz", "vsiz",
+           "rss/rec", "java/rec", "native/rec", "set_bulk", "get_bulk");
+    for (String path : paths) {
+      for (long rnum : rnums) {
+        for (long ksiz : ksizs) {
+          for (long vsiz : vsizs) {
+            Utility.remove_files_recursively(path);
+            List<String> cmd = new ArrayList<String>();
+            cmd.add(java);
+            cmd.add("-cp");
+            cmd.add(System.getProperty("java.class.path"));
+            cmd.add("-Djava.library.path=" + System.getProperty("java.library.path"));
+            String sopath = System.getProperty("kyotocabinet.lib");
+            if (sopath != null) cmd.add("-Dkyotocabinet.lib=" + sopath);
+            cmd.add(Test.class.getName());
+            cmd.add("memsize");
+            cmd.add("-ks");
+            cmd.add(String.valueOf(ksiz));
+            cmd.add("-vs");
+            cmd.add(String.valueOf(vsiz));
+            cmd.add("-bulk");
+            cmd.add(String.valueOf(bnum));
+            cmd.add(String.valueOf(rnum));
+            cmd.add(path);
+            Map<String, String> res = new HashMap<String, String>();
+            try {
+              ProcessBuilder pb = new ProcessBuilder(cmd);
+              pb.redirectErrorStream(true);
+              Process proc = pb.start();
+              BufferedReader br =
+                  new BufferedReader(new InputStreamReader(proc.getInputStream()));
+              String line;
+              while ((line = br.readLine()) != null) {
+                int idx = line.indexOf(": ");
+                if (idx > 0) res.put(line.substring(0, idx), line.substring(idx + 2));
+              }
+              br.close();
+              if (proc.waitFor() != 0) err = true;
+            } catch (Exception e) {
+              e.printStackTrace();
+              err = true;
+            }
+            Utility.remove_files_recursively(path);
+            printf("%-12s %10d %6d %6d %10s %10s %10s %12s %12s\n", path, rnum, ksiz, vsiz,
+                   memfield(res, "rss per record"), memfield(res, "java per record"),
+                   memfield(res, "native per record"), memfield(res, "set_bulk peak"),
+                   memfield(res, "get_bulk peak"));
+          }
+        }
+      }
+    }
+    printf("%s\n\n", err ? "error" : "ok");
+    return err ? 1 : 0;
+  }
+  /** get the key of a record for memory measurement */
+  private static byte[] memkey(long num, int ksiz) {
+    String str = String.format("%0" + ksiz + "d", num);
+    if (str.length() > ksiz) str = str.substring(str.length() - ksiz);
+    return str.getBytes();
+  }
+  /** get the value of a record for memory measurement */
+  private static byte[] memvalue(int vsiz) {
+    byte[] value = new byte[vsiz];
+    Arrays.fill(value, (byte)'v');
+    return value;
+  }
+  /** get a field of the result of a memsize child process */
+  private static String memfield(Map<String, String> res, String name) {
+    String value = res.get(name);
+    return value != null ? value : "-";
+  }
+  /** measure the transient memory peak of bulk operations */
+  private static long membulkpeak(DB db, long rnum, int ksiz, int vsiz, int bnum,
+                                  boolean set) {
+    class Sampler extends Thread {
+      public void run() {
+        while (!done_) {
+          long rss = memusagerss();
+          if (rss > peak_) peak_ = rss;
+          try {
+            Thread.sleep(1);
+          } catch (java.lang.InterruptedException e) {}
+        }
+      }
+      public long peak() {
+        return peak_;
+      }
+      public void finish() {
+        done_ = true;
+      }
+      private volatile boolean done_ = false;
+      private volatile long peak_ = 0;
+    }
+    System.gc();
+    long base = memusagerss();
+    Sampler sampler = new Sampler();
+    sampler.start();
+    byte[] value = memvalue(vsiz);
+    for (long i = 0; i < rnum; i += bnum) {
+      int num = (int)Math.min(bnum, rnum - i);
+      if (set) {
+        byte[][] recs = new byte[num*2][];
+        for (int j = 0; j < num; j++) {
+          recs[j*2] = memkey(i + j, ksiz);
+          recs[j*2+1] = value;
+        }
+        if (db.set_bulk(recs, false) < 0) dberrprint(db, "DB::set_bulk");
+      } else {
+        byte[][] keys = new byte[num][];
+        for (int j = 0; j < num; j++) {
+          keys[j] = memkey(i + j, ksiz);
+        }
+        if (db.get_bulk(keys, false) == null) dberrprint(db, "DB::get_bulk");
+      }
+    }
+    sampler.finish();
+    try {
+      sampler.join();
+    } catch (java.lang.InterruptedException e) {}
+    return Math.max(sampler.peak() - base, 0);
+  }
+  /** parse a comma-separated list of numbers */
+  private static long[] numlist(String str) {
+    String[] elems = str.split(",");
+    long[] nums = new long[elems.length];
+    for (int i = 0; i < elems.length; i++) {
+      nums[i] = Utility.atoix(elems[i]);
+      if (nums[i] < 1) return null;
+    }
+    return nums;
+  }
   /** print formatted information string and flush the buffer */
   private static void printf(String format, Object... args) {
     STDOUT.printf(format, args);
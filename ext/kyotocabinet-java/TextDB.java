@@ -0,0 +1,99 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface of plain text database abstraction for appending and scanning lines.
+ * @note The database must be opened with a path whose suffix is ".kcx" or with the "type"
+ * parameter of "kcx".  Each record is a line of the text file and its key is the position of
+ * the line in the file, expressed as a 16-digit upper-case hexadecimal number.  Keys given to
+ * storing methods are ignored and every stored value is appended as a new line.  A scan can
+ * be resumed by jumping a cursor to the key of a position or by the read_lines method.
+ */
+public class TextDB extends DB {
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance.
+   */
+  public TextDB() {
+    this(0);
+  }
+  /**
+   * Create an instance with options.
+   * @param opts the optional features by bitwise-or: DB.GEXCEPTIONAL for the exceptional mode.
+   */
+  public TextDB(int opts) {
+    super(opts);
+  }
+  //----------------------------------------------------------------
+  // public methods
+  //----------------------------------------------------------------
+  /**
+   * Get the key of a position.
+   * @param pos the position in the file.
+   * @return the key of the position.
+   */
+  public static String position_key(long pos) {
+    return String.format("%016X", pos);
+  }
+  /**
+   * Get the position of a key.
+   * @param key the key of a record.
+   * @return the position in the file.
+   */
+  public static long key_position(String key) {
+    return Long.parseLong(key, 16);
+  }
+  /**
+   * Append a line.
+   * @param line the line.
+   * @return true on success, or false on failure.
+   * @note A line feed in the line separates multiple lines.
+   */
+  public boolean append_line(String line) {
+    return append_lines(str_to_ary(line));
+  }
+  /**
+   * Append lines packed in a buffer at once.
+   * @param lines the lines, each of which ends with a line feed.  The line feed of the last
+   * line can be omitted.
+   * @return true on success, or false on failure.
+   * @note The buffer is written by one write operation, which is much faster than appending
+   * each line.
+   */
+  public native boolean append_lines(byte[] lines);
+  /**
+   * Read lines from a position.
+   * @param pos the position in the file, which is that of a line.
+   * @param max the maximum number of lines to read.  If it is negative, no limit is specified.
+   * @return an array of the keys of the positions and the lines of the records read in order,
+   * or null on failure.  The keys and the lines are placed alternately.
+   * @note The position of the line following the last one is that of the last line plus its
+   * length plus one.
+   */
+  public native byte[][] read_lines(long pos, int max);
+}
+
+
+
+// END OF FILE
@@ -0,0 +1,81 @@
+/*************************************************************************************************
+ * Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+package kyotocabinet;
+
+import java.util.*;
+import java.io.*;
+import java.net.*;
+
+
+/**
+ * Interface of database abstraction with a cache tier over a persistent tier.
+ * @note The cache tier is an on-memory database specified by its own path, for example
+ * "*#capsiz=268435456" or "%#ktcapsiz=1048576", and the persistent tier is the database
+ * specified by the path given to the open method.  Reading a record looks up the cache tier
+ * first and promotes the record from the persistent tier into the cache tier on a miss.  In the
+ * write-through mode, every update is stored into the persistent tier before the cache tier.  In
+ * the write-back mode, updates are stored into the cache tier and queued as dirty records, which
+ * are written into the persistent tier by a background thread within a second or when half of
+ * the queue is filled.  Writers block while the queue is full.  Records evicted from the cache
+ * tier are thus never lost as the persistent tier always holds them or they are still queued.
+ * Iteration, cursors, counting, copying, and synchronization flush the queue first and work on
+ * the persistent tier.  Transactions are supported in the write-through mode only.  The status
+ * method reports "tier_cache_hits", "tier_store_hits", "tier_misses", "tier_dirty",
+ * "tier_flush_lag" in seconds, "tier_flushes", and "tier_flush_fails".
+ */
+public class TieredDB extends DB {
+  //----------------------------------------------------------------
+  // constructors and finalizer
+  //----------------------------------------------------------------
+  /**
+   * Create an instance in the write-through mode.
+   * @param cache the path of the cache tier.
+   */
+  public TieredDB(String cache) {
+    this(cache, 0, 0);
+  }
+  /**
+   * Create an instance.
+   * @param cache the path of the cache tier.
+   * @param dirty the maximum number of dirty records queued in the write-back mode.  If it is
+   * not more than 0, the write-through mode is used.
+   */
+  public TieredDB(String cache, int dirty) {
+    this(cache, dirty, 0);
+  }
+  /**
+   * Create an instance with options.
+   * @param cache the path of the cache tier.
+   * @param dirty the maximum number of dirty records queued in the write-back mode.  If it is
+   * not more than 0, the write-through mode is used.
+   * @param opts the optional features by bitwise-or: DB.GEXCEPTIONAL for the exceptional mode.
+   */
+  public TieredDB(String cache, int dirty, int opts) {
+    super(opts);
+    initialize(cache, Math.max(dirty, 0));
+  }
+  //----------------------------------------------------------------
+  // private methods
+  //----------------------------------------------------------------
+  /**
+   * Initialize the tiers.
+   */
+  private native void initialize(String cache, int dirty);
+}
+
+
+
+// END OF FILE
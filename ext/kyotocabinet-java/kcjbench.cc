@@ -0,0 +1,370 @@
+/*************************************************************************************************
+ * Micro benchmark of the overhead of the Java binding of Kyoto Cabinet.
+ *                                                               Copyright (C) 2009-2011 FAL Labs
+ * This file is part of Kyoto Cabinet.
+ * This program is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by the Free Software Foundation, either version
+ * 3 of the License, or any later version.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************************************/
+
+
+#include <kcpolydb.h>
+#include <jni.h>
+
+#include "kyotocabinet_DB.h"
+
+#define P_DB      "kyotocabinet/DB"
+
+namespace kc = kyotocabinet;
+
+
+/* precedent type declaration */
+struct BenchResult;
+typedef std::vector<jbyteArray> ArrayVector;
+typedef std::vector<jobjectArray> BatchVector;
+typedef std::vector<std::string> StringVector;
+
+
+/* function prototypes */
+static void usage();
+static void eprintf(const char* format, ...);
+static int32_t runmain(int argc, char** argv);
+static int32_t procmain(const char* path, int64_t rnum, int64_t vsiz, int64_t bnum,
+                        int32_t itnum, const char* classpath, const char* libpath);
+static JNIEnv* createjvm(JavaVM** jvmp, const char* classpath, const char* libpath);
+static jbyteArray newglobalarray(JNIEnv* env, const std::string& str);
+static void printresult(const char* name, const BenchResult& res, int64_t cnum);
+
+
+/* global variables */
+const char* g_progname;
+
+
+/**
+ * Elapsed time of a benchmark entry.
+ */
+struct BenchResult {
+  double jni;
+  double raw;
+  BenchResult() : jni(kc::inf()), raw(kc::inf()) {}
+  void update(double jtime, double rtime) {
+    if (jtime < jni) jni = jtime;
+    if (rtime < raw) raw = rtime;
+  }
+};
+
+
+/**
+ * Main routine.
+ */
+int main(int argc, char** argv) {
+  g_progname = argv[0];
+  return runmain(argc, argv);
+}
+
+
+/**
+ * Print the usage and exit.
+ */
+static void usage() {
+  eprintf("%s: micro benchmark of the overhead of the Java binding\n", g_progname);
+  eprintf("\n");
+  eprintf("usage:\n");
+  eprintf("  %s [-cp path] [-lp path] [-vs num] [-bs num] [-it num] path rnum\n", g_progname);
+  eprintf("\n");
+  std::exit(1);
+}
+
+
+/**
+ * Print formatted error information string and flush the buffer.
+ */
+static void eprintf(const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  char buf[kc::NUMBUFSIZ*32];
+  std::vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  std::cerr << buf;
+  std::cerr.flush();
+}
+
+
+/**
+ * Parse arguments of the main command.
+ */
+static int32_t runmain(int argc, char** argv) {
+  const char* path = NULL;
+  const char* rstr = NULL;
+  const char* classpath = "kyotocabinet.jar";
+  const char* libpath = ".";
+  int64_t vsiz = 8;
+  int64_t bnum = 100;
+  int32_t itnum = 3;
+  for (int32_t i = 1; i < argc; i++) {
+    if (!path && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "-cp")) {
+        if (++i >= argc) usage();
+        classpath = argv[i];
+      } else if (!std::strcmp(argv[i], "-lp")) {
+        if (++i >= argc) usage();
+        libpath = argv[i];
+      } else if (!std::strcmp(argv[i], "-vs")) {
+        if (++i >= argc) usage();
+        vsiz = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-bs")) {
+        if (++i >= argc) usage();
+        bnum = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-it")) {
+        if (++i >= argc) usage();
+        itnum = kc::atoix(argv[i]);
+      } else {
+        usage();
+      }
+    } else if (!path) {
+      path = argv[i];
+    } else if (!rstr) {
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path || !rstr) usage();
+  int64_t rnum = kc::atoix(rstr);
+  if (rnum < 1 || vsiz < 0 || bnum < 1 || itnum < 1) usage();
+  return procmain(path, rnum, vsiz, bnum, itnum, classpath, libpath);
+}
+
+
+/**
+ * Perform the main command.
+ */
+static int32_t procmain(const char* path, int64_t rnum, int64_t vsiz, int64_t bnum,
+                        int32_t itnum, const char* classpath, const char* libpath) {
+  std::printf("<JNI Overhead Benchmark>\n  path=%s  rnum=%lld  vsiz=%lld  bnum=%lld  itnum=%d\n\n",
+              path, (long long)rnum, (long long)vsiz, (long long)bnum, (int)itnum);
+  JavaVM* jvm;
+  JNIEnv* env = createjvm(&jvm, classpath, libpath);
+  if (!env) {
+    eprintf("%s: the Java VM could not be created\n", g_progname);
+    return 1;
+  }
+  jclass cls_db = env->FindClass(P_DB);
+  if (!cls_db) {
+    env->ExceptionDescribe();
+    jvm->DestroyJavaVM();
+    return 1;
+  }
+  jmethodID id_db_init = env->GetMethodID(cls_db, "<init>", "()V");
+  jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+  jobject jdb = env->NewObject(cls_db, id_db_init);
+  if (!jdb) {
+    env->ExceptionDescribe();
+    jvm->DestroyJavaVM();
+    return 1;
+  }
+  kc::PolyDB* db = (kc::PolyDB*)(intptr_t)env->GetLongField(jdb, id_db_ptr);
+  bool err = false;
+  jstring jpath = env->NewStringUTF(path);
+  uint32_t omode = kc::PolyDB::OWRITER | kc::PolyDB::OCREATE | kc::PolyDB::OTRUNCATE;
+  if (!Java_kyotocabinet_DB_open(env, jdb, jpath, omode)) {
+    eprintf("%s: %s: open error: %s\n", g_progname, path, db->error().name());
+    jvm->DestroyJavaVM();
+    return 1;
+  }
+  env->DeleteLocalRef(jpath);
+  std::printf("preparing records:\n");
+  StringVector keys, mkeys;
+  ArrayVector jkeys, jmkeys;
+  keys.reserve(rnum);
+  mkeys.reserve(rnum);
+  jkeys.reserve(rnum);
+  jmkeys.reserve(rnum);
+  for (int64_t i = 1; i <= rnum; i++) {
+    std::string key = kc::strprintf("%08lld", (long long)i);
+    std::string mkey = kc::strprintf("x%08lld", (long long)i);
+    keys.push_back(key);
+    mkeys.push_back(mkey);
+    jkeys.push_back(newglobalarray(env, key));
+    jmkeys.push_back(newglobalarray(env, mkey));
+  }
+  std::string value(vsiz, 'v');
+  jbyteArray jvalue = newglobalarray(env, value);
+  std::vector<StringVector> batches;
+  BatchVector jbatches;
+  jclass cls_byteary = env->FindClass("[B");
+  for (int64_t i = 0; i < rnum; i += bnum) {
+    int64_t num = std::min(bnum, rnum - i);
+    StringVector batch;
+    jobjectArray jbatch = env->NewObjectArray(num, cls_byteary, NULL);
+    for (int64_t j = 0; j < num; j++) {
+      batch.push_back(keys[i+j]);
+      env->SetObjectArrayElement(jbatch, j, jkeys[i+j]);
+    }
+    batches.push_back(batch);
+    jbatches.push_back((jobjectArray)env->NewGlobalRef(jbatch));
+    env->DeleteLocalRef(jbatch);
+  }
+  for (int64_t i = 0; !err && i < rnum; i++) {
+    if (!db->set(keys[i].data(), keys[i].size(), value.data(), value.size())) err = true;
+  }
+  BenchResult rset, rget, rmiss, rcheck, rbulk, rremove;
+  for (int32_t itcnt = 1; !err && itcnt <= itnum; itcnt++) {
+    std::printf("iteration %d:\n", (int)itcnt);
+    double stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      Java_kyotocabinet_DB_set(env, jdb, jkeys[i], jvalue);
+    }
+    double jtime = kc::time() - stime;
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      db->set(keys[i].data(), keys[i].size(), value.data(), value.size());
+    }
+    rset.update(jtime, kc::time() - stime);
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      jbyteArray jrv = Java_kyotocabinet_DB_get(env, jdb, jkeys[i]);
+      if (jrv) env->DeleteLocalRef(jrv);
+    }
+    jtime = kc::time() - stime;
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      size_t rsiz;
+      char* rbuf = db->get(keys[i].data(), keys[i].size(), &rsiz);
+      delete[] rbuf;
+    }
+    rget.update(jtime, kc::time() - stime);
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      jbyteArray jrv = Java_kyotocabinet_DB_get(env, jdb, jmkeys[i]);
+      if (jrv) env->DeleteLocalRef(jrv);
+    }
+    jtime = kc::time() - stime;
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      size_t rsiz;
+      char* rbuf = db->get(mkeys[i].data(), mkeys[i].size(), &rsiz);
+      delete[] rbuf;
+    }
+    rmiss.update(jtime, kc::time() - stime);
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      Java_kyotocabinet_DB_check(env, jdb, jkeys[i]);
+    }
+    jtime = kc::time() - stime;
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      db->check(keys[i].data(), keys[i].size());
+    }
+    rcheck.update(jtime, kc::time() - stime);
+    stime = kc::time();
+    for (size_t i = 0; i < jbatches.size(); i++) {
+      jobjectArray jrv = Java_kyotocabinet_DB_get_1bulk(env, jdb, jbatches[i], false);
+      if (jrv) env->DeleteLocalRef(jrv);
+    }
+    jtime = kc::time() - stime;
+    stime = kc::time();
+    for (size_t i = 0; i < batches.size(); i++) {
+      std::map<std::string, std::string> recs;
+      db->get_bulk(batches[i], &recs, false);
+    }
+    rbulk.update(jtime, kc::time() - stime);
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      Java_kyotocabinet_DB_remove(env, jdb, jkeys[i]);
+    }
+    jtime = kc::time() - stime;
+    for (int64_t i = 0; !err && i < rnum; i++) {
+      if (!db->set(keys[i].data(), keys[i].size(), value.data(), value.size())) err = true;
+    }
+    stime = kc::time();
+    for (int64_t i = 0; i < rnum; i++) {
+      db->remove(keys[i].data(), keys[i].size());
+    }
+    rremove.update(jtime, kc::time() - stime);
+    for (int64_t i = 0; !err && i < rnum; i++) {
+      if (!db->set(keys[i].data(), keys[i].size(), value.data(), value.size())) err = true;
+    }
+    if (env->ExceptionCheck()) {
+      env->ExceptionDescribe();
+      err = true;
+    }
+  }
+  if (err) eprintf("%s: %s: %s\n", g_progname, path, db->error().name());
+  std::printf("\nresult (best of %d, nanoseconds per call):\n", (int)itnum);
+  printresult("set", rset, rnum);
+  printresult("get", rget, rnum);
+  printresult("get (miss)", rmiss, rnum);
+  printresult("check", rcheck, rnum);
+  printresult("get_bulk", rbulk, jbatches.size());
+  printresult("remove", rremove, rnum);
+  for (size_t i = 0; i < jbatches.size(); i++) {
+    env->DeleteGlobalRef(jbatches[i]);
+  }
+  for (int64_t i = 0; i < rnum; i++) {
+    env->DeleteGlobalRef(jkeys[i]);
+    env->DeleteGlobalRef(jmkeys[i]);
+  }
+  env->DeleteGlobalRef(jvalue);
+  if (!Java_kyotocabinet_DB_close(env, jdb)) {
+    eprintf("%s: %s: close error: %s\n", g_progname, path, db->error().name());
+    err = true;
+  }
+  env->DeleteLocalRef(jdb);
+  jvm->DestroyJavaVM();
+  std::printf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+/**
+ * Create the Java VM embedded in this process.
+ */
+static JNIEnv* createjvm(JavaVM** jvmp, const char* classpath, const char* libpath) {
+  std::string cpopt = kc::strprintf("-Djava.class.path=%s", classpath);
+  std::string lpopt = kc::strprintf("-Djava.library.path=%s", libpath);
+  JavaVMOption options[2];
+  options[0].optionString = (char*)cpopt.c_str();
+  options[0].extraInfo = NULL;
+  options[1].optionString = (char*)lpopt.c_str();
+  options[1].extraInfo = NULL;
+  JavaVMInitArgs args;
+  args.version = JNI_VERSION_1_6;
+  args.nOptions = sizeof(options) / sizeof(*options);
+  args.options = options;
+  args.ignoreUnrecognized = JNI_FALSE;
+  JNIEnv* env;
+  if (JNI_CreateJavaVM(jvmp, (void**)&env, &args) != JNI_OK) return NULL;
+  return env;
+}
+
+
+/**
+ * Create a new byte array with a global reference.
+ */
+static jbyteArray newglobalarray(JNIEnv* env, const std::string& str) {
+  jbyteArray jary = env->NewByteArray(str.size());
+  env->SetByteArrayRegion(jary, 0, str.size(), (jbyte*)str.data());
+  jbyteArray jglobal = (jbyteArray)env->NewGlobalRef(jary);
+  env->DeleteLocalRef(jary);
+  return jglobal;
+}
+
+
+/**
+ * Print the result of a benchmark entry.
+ */
+static void printresult(const char* name, const BenchResult& res, int64_t cnum) {
+  double jns = res.jni * 1000000000.0 / cnum;
+  double rns = res.raw * 1000000000.0 / cnum;
+  std::printf("%-12s jni=%10.1f  raw=%10.1f  overhead=%10.1f\n", name, jns, rns, jns - rns);
+}
+
+
+
+// END OF FILE
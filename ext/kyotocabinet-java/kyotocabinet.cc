@@ -21,6 +21,12 @@
 #include "kyotocabinet_Error.h"
 #include "kyotocabinet_Cursor.h"
 #include "kyotocabinet_DB.h"
+#include "kyotocabinet_ShardedDB.h"
+#include "kyotocabinet_TieredDB.h"
+#include "kyotocabinet_MemtableDB.h"
+#include "kyotocabinet_IndexDB.h"
+#include "kyotocabinet_TextDB.h"
+#include "kyotocabinet_ReplicationReader.h"
 #include "kyotocabinet_MapReduce.h"
 #include "kyotocabinet_ValueIterator.h"
 
@@ -51,9 +57,39 @@ class SoftString;
 class SoftArray;
 class CursorBurrow;
 class SoftCursor;
+class GroupCommitter;
+class BackgroundSynchronizer;
+class WriteThrottle;
+class ChangeRing;
+class UpdateLog;
+class UpdateLogReader;
+class SecondaryIndex;
+class BloomFilter;
+class KeyFilter;
+class FrontCache;
+class ExternalDBHolder;
+class SoftDB;
 class SoftVisitor;
 class SoftFileProcessor;
+class SoftProgressChecker;
+class MergeVisitor;
 class SoftMapReduce;
+class ParallelMerger;
+class BulkLoader;
+class FileImporter;
+class FileExporter;
+class TransformVisitor;
+class RangeUpdater;
+class FastCompressor;
+class SnapshotWriter;
+class SnapshotReader;
+class SnapshotChecker;
+class WrapperDB;
+class SlottedDB;
+class ShardDB;
+class TierDB;
+class MemtableDB;
+class IndexAdapter;
 typedef std::map<std::string, std::string> StringMap;
 typedef std::vector<std::string> StringVector;
 
@@ -66,10 +102,22 @@ static jstring newstring(JNIEnv* env, const char* str);
 static jbyteArray newarray(JNIEnv* env, const char* buf, size_t size);
 static jobject maptojhash(JNIEnv* env, const StringMap* map);
 static jobject vectortojlist(JNIEnv* env, const StringVector* vec);
-static kc::PolyDB* getdbcore(JNIEnv* env, jobject jdb);
+static SoftDB* getdbcore(JNIEnv* env, jobject jdb);
 static void throwdberror(JNIEnv* env, jobject jdb);
 static SoftCursor* getcurcore(JNIEnv* env, jobject jcur);
 static jobject getcurdb(JNIEnv* env, jobject jcur);
+static UpdateLogReader* getrepcore(JNIEnv* env, jobject jrep);
+static kc::Compressor* newcompressor(const std::string& name);
+static bool dumpsnapshot(kc::BasicDB* db, const std::string& dest, const std::string& codec,
+                         kc::BasicDB::ProgressChecker* checker);
+static bool loadsnapshot(kc::BasicDB* db, const std::string& src,
+                         kc::BasicDB::ProgressChecker* checker);
+static void escapetsv(const char* buf, size_t size, std::string* dest);
+static void unescapetsv(const char* buf, size_t size, std::string* dest);
+static bool parsetsvline(const char* buf, size_t size, std::string* key, std::string* value);
+static bool readkeys(JNIEnv* env, jobjectArray jkeys, StringVector* keys);
+static bool endbulk(kc::BasicDB* db, bool commit);
+static bool istree(kc::BasicDB::Type type);
 
 
 /* global variables */
@@ -88,6 +136,7 @@ const char* const p_err_children[] = {
 };
 jbyteArray obj_vis_nop;
 jbyteArray obj_vis_remove;
+const char* const snap_magic = "KCJZ";
 
 
 /**
@@ -224,585 +273,7428 @@ class SoftCursor {
 
 
 /**
- * Wrapper of a visitor.
+ * Committer to apply updating operations of concurrent threads in a group.
  */
-class SoftVisitor : public kc::PolyDB::Visitor {
+class GroupCommitter {
  public:
-  explicit SoftVisitor(JNIEnv* env, jobject jvisitor, bool writable) :
-      env_(env), jvisitor_(jvisitor), writable_(writable),
-      cls_vis_(0), id_vis_visit_full_(0), id_vis_visit_empty_(0),
-      jrv_(NULL), rv_(NULL), jex_(NULL) {
-    cls_vis_ = env->GetObjectClass(jvisitor_);
-    id_vis_visit_full_ = env->GetMethodID(cls_vis_, "visit_full", "([B[B)[B");
-    id_vis_visit_empty_ = env->GetMethodID(cls_vis_, "visit_empty", "([B)[B");
+  /**
+   * Kinds of requests.
+   */
+  enum Kind {
+    RSET,
+    RREMOVE,
+    RSETBULK,
+    RREMOVEBULK
+  };
+  explicit GroupCommitter(kc::PolyDB* db) :
+      db_(db), mlock_(), cond_(), queue_(), enabled_(false), hard_(false), leading_(false) {}
+  void tune(bool enabled, bool hard) {
+    kc::ScopedMutex lock(&mlock_);
+    enabled_ = enabled;
+    hard_ = hard;
   }
-  ~SoftVisitor() {
-    cleanup();
+  bool enabled() {
+    return enabled_;
   }
-  jthrowable exception() {
-    return jex_;
+  bool set(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    Request req(RSET);
+    req.kbuf = kbuf;
+    req.ksiz = ksiz;
+    req.vbuf = vbuf;
+    req.vsiz = vsiz;
+    return submit(&req) > 0;
+  }
+  bool remove(const char* kbuf, size_t ksiz) {
+    Request req(RREMOVE);
+    req.kbuf = kbuf;
+    req.ksiz = ksiz;
+    return submit(&req) > 0;
+  }
+  int64_t set_bulk(const StringMap& recs) {
+    Request req(RSETBULK);
+    req.recs = &recs;
+    return submit(&req);
+  }
+  int64_t remove_bulk(const StringVector& keys) {
+    Request req(RREMOVEBULK);
+    req.keys = &keys;
+    return submit(&req);
   }
  private:
-  const char* visit_full(const char* kbuf, size_t ksiz,
-                         const char* vbuf, size_t vsiz, size_t* sp) {
-    cleanup();
-    jbyteArray jkey = newarray(env_, kbuf, ksiz);
-    jbyteArray jvalue = newarray(env_, vbuf, vsiz);
-    jbyteArray jrv = (jbyteArray)env_->CallObjectMethod(jvisitor_, id_vis_visit_full_,
-                                                        jkey, jvalue);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
-    }
-    env_->DeleteLocalRef(jkey);
-    env_->DeleteLocalRef(jvalue);
-    if (!jrv) return NOP;
-    if (env_->IsSameObject(jrv, obj_vis_nop)) {
-      env_->DeleteLocalRef(jrv);
-      return NOP;
-    }
-    if (!writable_) {
-      env_->DeleteLocalRef(jrv);
-      throwruntime(env_, "confliction with the read-only parameter");
-      jex = env_->ExceptionOccurred();
-      if (jex) {
-        if (jex_) env_->DeleteLocalRef(jex_);
-        jex_ = jex;
-        env_->ExceptionClear();
+  /**
+   * Request of a calling thread.
+   */
+  struct Request {
+    Kind kind;
+    const char* kbuf;
+    size_t ksiz;
+    const char* vbuf;
+    size_t vsiz;
+    const StringMap* recs;
+    const StringVector* keys;
+    int64_t result;
+    kc::PolyDB::Error::Code code;
+    std::string message;
+    bool done;
+    explicit Request(Kind kind_) :
+        kind(kind_), kbuf(NULL), ksiz(0), vbuf(NULL), vsiz(0), recs(NULL), keys(NULL),
+        result(0), code(kc::PolyDB::Error::SUCCESS), message(), done(false) {}
+  };
+  typedef std::vector<Request*> RequestList;
+  int64_t submit(Request* req) {
+    kc::ScopedMutex lock(&mlock_);
+    queue_.push_back(req);
+    while (!req->done) {
+      if (leading_) {
+        cond_.wait(&mlock_);
+        continue;
       }
-      return NOP;
-    }
-    if (env_->IsSameObject(jrv, obj_vis_remove)) {
-      env_->DeleteLocalRef(jrv);
-      return REMOVE;
+      leading_ = true;
+      bool hard = hard_;
+      RequestList reqs;
+      reqs.swap(queue_);
+      mlock_.unlock();
+      apply(reqs, hard);
+      mlock_.lock();
+      RequestList::iterator it = reqs.begin();
+      RequestList::iterator itend = reqs.end();
+      while (it != itend) {
+        (*it)->done = true;
+        it++;
+      }
+      leading_ = false;
+      cond_.broadcast();
     }
-    jrv_ = jrv;
-    rv_ = new SoftArray(env_, jrv);
-    *sp = rv_->size();
-    return rv_->ptr();
+    if (req->code != kc::PolyDB::Error::SUCCESS)
+      db_->set_error(_KCCODELINE_, req->code, req->message.c_str());
+    return req->result;
   }
-  const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
-    cleanup();
-    jbyteArray jkey = newarray(env_, kbuf, ksiz);
-    jbyteArray jrv = (jbyteArray)env_->CallObjectMethod(jvisitor_, id_vis_visit_empty_, jkey);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
-    }
-    env_->DeleteLocalRef(jkey);
-    if (!jrv) return NOP;
-    if (env_->IsSameObject(jrv, obj_vis_nop)) {
-      env_->DeleteLocalRef(jrv);
-      return NOP;
+  void apply(const RequestList& reqs, bool hard) {
+    if (!db_->begin_transaction(hard)) {
+      fail(reqs);
+      return;
     }
-    if (!writable_) {
-      env_->DeleteLocalRef(jrv);
-      throwruntime(env_, "confliction with the read-only parameter");
-      jex = env_->ExceptionOccurred();
-      if (jex) {
-        if (jex_) env_->DeleteLocalRef(jex_);
-        jex_ = jex;
-        env_->ExceptionClear();
+    RequestList::const_iterator it = reqs.begin();
+    RequestList::const_iterator itend = reqs.end();
+    while (it != itend) {
+      Request* req = *it;
+      switch (req->kind) {
+        case RSET: {
+          if (db_->set(req->kbuf, req->ksiz, req->vbuf, req->vsiz)) {
+            req->result = 1;
+          } else {
+            keep(req);
+          }
+          break;
+        }
+        case RREMOVE: {
+          if (db_->remove(req->kbuf, req->ksiz)) {
+            req->result = 1;
+          } else {
+            keep(req);
+          }
+          break;
+        }
+        case RSETBULK: {
+          StringMap::const_iterator rit = req->recs->begin();
+          StringMap::const_iterator ritend = req->recs->end();
+          while (rit != ritend) {
+            if (db_->set(rit->first.data(), rit->first.size(),
+                         rit->second.data(), rit->second.size())) {
+              req->result++;
+            } else {
+              keep(req);
+              req->result = -1;
+              break;
+            }
+            rit++;
+          }
+          break;
+        }
+        case RREMOVEBULK: {
+          StringVector::const_iterator kit = req->keys->begin();
+          StringVector::const_iterator kitend = req->keys->end();
+          while (kit != kitend) {
+            if (db_->remove(kit->data(), kit->size())) {
+              req->result++;
+            } else if (db_->error() != kc::PolyDB::Error::NOREC) {
+              keep(req);
+              req->result = -1;
+              break;
+            }
+            kit++;
+          }
+          break;
+        }
       }
-      return NOP;
-    }
-    if (env_->IsSameObject(jrv, obj_vis_remove)) {
-      env_->DeleteLocalRef(jrv);
-      return REMOVE;
+      it++;
     }
-    jrv_ = jrv;
-    rv_ = new SoftArray(env_, jrv);
-    *sp = rv_->size();
-    return rv_->ptr();
+    if (!db_->end_transaction(true)) fail(reqs);
   }
-  void cleanup() {
-    delete rv_;
-    rv_ = NULL;
-    if (jrv_) {
-      env_->DeleteLocalRef(jrv_);
-      jrv_ = NULL;
+  void keep(Request* req) {
+    kc::PolyDB::Error err = db_->error();
+    req->code = err.code();
+    req->message = err.message();
+  }
+  void fail(const RequestList& reqs) {
+    kc::PolyDB::Error err = db_->error();
+    RequestList::const_iterator it = reqs.begin();
+    RequestList::const_iterator itend = reqs.end();
+    while (it != itend) {
+      Request* req = *it;
+      req->result = req->kind == RSETBULK || req->kind == RREMOVEBULK ? -1 : 0;
+      req->code = err.code();
+      req->message = err.message();
+      it++;
     }
   }
-  JNIEnv* env_;
-  jobject jvisitor_;
-  bool writable_;
-  jclass cls_vis_;
-  jmethodID id_vis_visit_full_;
-  jmethodID id_vis_visit_empty_;
-  jbyteArray jrv_;
-  SoftArray* rv_;
-  jthrowable jex_;
+  kc::PolyDB* db_;
+  kc::Mutex mlock_;
+  kc::CondVar cond_;
+  RequestList queue_;
+  bool enabled_;
+  bool hard_;
+  bool leading_;
 };
 
 
 /**
- * Wrapper of a file processor.
+ * Synchronizer to write back updated records in the background.
  */
-class SoftFileProcessor : public kc::PolyDB::FileProcessor {
+class BackgroundSynchronizer {
  public:
-  explicit SoftFileProcessor(JNIEnv* env, jobject jproc) :
-      env_(env), jproc_(jproc), cls_fproc_(0), id_fproc_process_(0), jex_(NULL) {
-    cls_fproc_ = env->GetObjectClass(jproc_);
-    id_fproc_process_ = env->GetMethodID(cls_fproc_, "process", "(" L_STR "JJ)Z");
+  explicit BackgroundSynchronizer(kc::PolyDB* db) :
+      db_(db), mlock_(), cond_(), worker_(NULL), interval_(0), bsiz_(0), hard_(false),
+      stop_(false), urgent_(false), wseq_(0), wsiz_(0), sseq_(0), stime_(0), fails_(0),
+      code_(kc::PolyDB::Error::SUCCESS), message_() {}
+  ~BackgroundSynchronizer() {
+    stop();
   }
-  jthrowable exception() {
-    return jex_;
+  void tune(double interval, int64_t bsiz, bool hard) {
+    kc::ScopedMutex lock(&mlock_);
+    interval_ = interval;
+    bsiz_ = bsiz;
+    hard_ = hard;
+    cond_.broadcast();
+  }
+  bool tuned() {
+    kc::ScopedMutex lock(&mlock_);
+    return interval_ > 0 || bsiz_ > 0;
+  }
+  void start() {
+    kc::ScopedMutex lock(&mlock_);
+    if (worker_ || (interval_ <= 0 && bsiz_ <= 0)) return;
+    worker_ = new Worker(this);
+    worker_->start();
+  }
+  void stop() {
+    mlock_.lock();
+    Worker* worker = worker_;
+    if (!worker) {
+      mlock_.unlock();
+      return;
+    }
+    stop_ = true;
+    cond_.broadcast();
+    mlock_.unlock();
+    worker->join();
+    delete worker;
+    mlock_.lock();
+    worker_ = NULL;
+    stop_ = false;
+    cond_.broadcast();
+    mlock_.unlock();
+  }
+  void note(size_t size) {
+    int64_t osiz = wsiz_.add(size);
+    wseq_.add(1);
+    int64_t bsiz = bsiz_;
+    if (bsiz > 0 && osiz < bsiz && osiz + (int64_t)size >= bsiz) {
+      kc::ScopedMutex lock(&mlock_);
+      cond_.broadcast();
+    }
+  }
+  void mark() {
+    kc::ScopedMutex lock(&mlock_);
+    sseq_ = wseq_.get();
+    stime_ = kc::time();
+    wsiz_.set(0);
+    cond_.broadcast();
+  }
+  int64_t sequence() {
+    return wseq_.get();
+  }
+  int64_t synced_sequence() {
+    kc::ScopedMutex lock(&mlock_);
+    return sseq_;
+  }
+  double synced_time() {
+    kc::ScopedMutex lock(&mlock_);
+    return stime_;
+  }
+  bool synchronize_until(int64_t seq) {
+    kc::ScopedMutex lock(&mlock_);
+    int64_t wseq = wseq_.get();
+    if (seq > wseq) seq = wseq;
+    int64_t fails = fails_;
+    while (sseq_ < seq) {
+      if (!worker_ || stop_) {
+        bool hard = hard_;
+        mlock_.unlock();
+        bool rv = db_->synchronize(hard);
+        mlock_.lock();
+        if (!rv) return false;
+        if (wseq > sseq_) {
+          sseq_ = wseq;
+          stime_ = kc::time();
+        }
+        cond_.broadcast();
+        break;
+      }
+      urgent_ = true;
+      cond_.broadcast();
+      cond_.wait(&mlock_);
+      if (fails_ != fails) {
+        db_->set_error(_KCCODELINE_, code_, message_.c_str());
+        return false;
+      }
+    }
+    return true;
   }
  private:
-  bool process(const std::string& path, int64_t count, int64_t size) {
-    jstring jpath = newstring(env_, path.c_str());
-    bool rv = env_->CallBooleanMethod(jproc_, id_fproc_process_, jpath, count, size);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      jex_ = jex;
-      env_->ExceptionClear();
+  /**
+   * Thread to perform synchronization.
+   */
+  class Worker : public kc::Thread {
+   public:
+    explicit Worker(BackgroundSynchronizer* sync) : sync_(sync) {}
+    void run() {
+      sync_->work();
+    }
+   private:
+    BackgroundSynchronizer* sync_;
+  };
+  void work() {
+    kc::ScopedMutex lock(&mlock_);
+    double deadline = kc::time() + interval_;
+    while (!stop_) {
+      bool due = urgent_ || (bsiz_ > 0 && wsiz_.get() >= bsiz_);
+      if (!due && interval_ > 0) {
+        double left = deadline - kc::time();
+        if (left > 0) {
+          cond_.wait(&mlock_, left);
+          continue;
+        }
+        due = true;
+      }
+      if (!due) {
+        cond_.wait(&mlock_);
+        continue;
+      }
+      urgent_ = false;
+      deadline = kc::time() + interval_;
+      int64_t seq = wseq_.get();
+      wsiz_.set(0);
+      if (seq <= sseq_) continue;
+      bool hard = hard_;
+      mlock_.unlock();
+      bool rv = db_->synchronize(hard);
+      kc::PolyDB::Error err = db_->error();
+      mlock_.lock();
+      if (rv) {
+        if (seq > sseq_) {
+          sseq_ = seq;
+          stime_ = kc::time();
+        }
+      } else {
+        fails_++;
+        code_ = err.code();
+        message_ = err.message();
+      }
+      cond_.broadcast();
     }
-    env_->DeleteLocalRef(jpath);
-    return rv;
   }
-  JNIEnv* env_;
-  jobject jproc_;
-  jclass cls_fproc_;
-  jmethodID id_fproc_process_;
-  jthrowable jex_;
+  kc::PolyDB* db_;
+  kc::Mutex mlock_;
+  kc::CondVar cond_;
+  Worker* worker_;
+  double interval_;
+  int64_t bsiz_;
+  bool hard_;
+  bool stop_;
+  bool urgent_;
+  kc::AtomicInt64 wseq_;
+  kc::AtomicInt64 wsiz_;
+  int64_t sseq_;
+  double stime_;
+  int64_t fails_;
+  kc::PolyDB::Error::Code code_;
+  std::string message_;
 };
 
 
 /**
- * Wrapper of a MapReduce framework.
+ * Throttle to limit the rate of updating operations.
  */
-class SoftMapReduce : public kc::MapReduce {
+class WriteThrottle {
  public:
-  explicit SoftMapReduce(JNIEnv* env, jobject jmr) :
-      env_(env), jmr_(jmr), cls_mr_(0), id_mr_map_(0), id_mr_reduce_(0),
-      id_mr_preproc_(0), id_mr_midproc_(0), id_mr_postproc_(0),
-      cls_viter_(0), id_viter_init_(0), jex_(NULL) {
-    cls_mr_ = env->GetObjectClass(jmr_);
-    id_mr_map_ = env->GetMethodID(cls_mr_, "map", "([B[B)Z");
-    id_mr_reduce_ = env->GetMethodID(cls_mr_, "reduce", "([B" L_VITER ")Z");
-    id_mr_preproc_ = env->GetMethodID(cls_mr_, "preprocess", "()Z");
-    id_mr_midproc_ = env->GetMethodID(cls_mr_, "midprocess", "()Z");
-    id_mr_postproc_ = env->GetMethodID(cls_mr_, "postprocess", "()Z");
-    cls_viter_ = env->FindClass(P_VITER);
-    id_viter_init_ = env->GetMethodID(cls_viter_, "<init>", "()V");
-    jfieldID id_mr_ptr = env->GetFieldID(cls_mr_, "ptr_", "J");
-    env->SetLongField(jmr_, id_mr_ptr, (intptr_t)this);
+  explicit WriteThrottle() :
+      lock_(), orate_(0), brate_(0), prior_(0), otokens_(0), btokens_(0), stamp_(0),
+      readers_(0), tcount_(0), ttime_(0) {}
+  void tune(double orate, double brate, bool prior) {
+    kc::ScopedSpinLock lock(&lock_);
+    orate_ = orate;
+    brate_ = brate;
+    prior_.set(prior ? 1 : 0);
+    otokens_ = orate;
+    btokens_ = brate;
+    stamp_ = kc::time();
   }
-  jthrowable exception() {
-    return jex_;
+  bool enabled() {
+    return orate_ > 0 || brate_ > 0 || prior_.get() > 0;
   }
-  bool emit_public(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
-    return emit(kbuf, ksiz, vbuf, vsiz);
+  bool begin_read() {
+    if (prior_.get() < 1) return false;
+    readers_.add(1);
+    return true;
   }
- private:
-  bool map(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
-    jbyteArray jkey = newarray(env_, kbuf, ksiz);
-    jbyteArray jvalue = newarray(env_, vbuf, vsiz);
-    bool rv = env_->CallBooleanMethod(jmr_, id_mr_map_, jkey, jvalue);
-    env_->DeleteLocalRef(jkey);
-    env_->DeleteLocalRef(jvalue);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
-    }
-    return rv;
+  void end_read() {
+    readers_.add(-1);
   }
-  bool reduce(const char* kbuf, size_t ksiz, ValueIterator* iter) {
-    jbyteArray jkey = newarray(env_, kbuf, ksiz);
-    jobject jviter = env_->NewObject(cls_viter_, id_viter_init_);
-    jfieldID id_viter_ptr = env_->GetFieldID(cls_viter_, "ptr_", "J");
-    env_->SetLongField(jviter, id_viter_ptr, (intptr_t)iter);
-    bool rv = env_->CallBooleanMethod(jmr_, id_mr_reduce_, jkey, jviter);
-    env_->DeleteLocalRef(jviter);
-    env_->DeleteLocalRef(jkey);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
+  void admit() {
+    if (!enabled()) return;
+    double stime = 0;
+    if (prior_.get() > 0 && readers_.get() > 0) {
+      stime = kc::time();
+      double deadline = stime + PRIORWAIT;
+      while (readers_.get() > 0 && kc::time() < deadline) {
+        kc::Thread::yield();
+      }
+    }
+    while (true) {
+      double wait = 0;
+      lock_.lock();
+      refill();
+      if (orate_ > 0 && otokens_ < 0) wait = -otokens_ / orate_;
+      if (brate_ > 0 && btokens_ < 0) wait = std::max(wait, -btokens_ / brate_);
+      lock_.unlock();
+      if (wait <= 0) break;
+      if (stime <= 0) stime = kc::time();
+      kc::Thread::sleep(wait);
+    }
+    if (stime > 0) {
+      double etime = kc::time();
+      kc::ScopedSpinLock lock(&lock_);
+      tcount_++;
+      ttime_ += etime - stime;
     }
-    return rv;
   }
-  bool preprocess() {
-    bool rv = env_->CallBooleanMethod(jmr_, id_mr_preproc_);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
+  void charge(size_t size) {
+    if (orate_ <= 0 && brate_ <= 0) return;
+    kc::ScopedSpinLock lock(&lock_);
+    otokens_ -= 1;
+    btokens_ -= size;
+  }
+  void status(StringMap* strmap) {
+    if (!enabled()) return;
+    kc::ScopedSpinLock lock(&lock_);
+    (*strmap)["throttle_count"] = kc::strprintf("%lld", (long long)tcount_);
+    (*strmap)["throttle_time"] = kc::strprintf("%.6f", ttime_);
+    (*strmap)["throttle_readers"] = kc::strprintf("%lld", (long long)readers_.get());
+  }
+ private:
+  /** The maximum time for an updating operation to give way to reading operations. */
+  static const double PRIORWAIT;
+  void refill() {
+    double now = kc::time();
+    double elapsed = now - stamp_;
+    stamp_ = now;
+    if (elapsed <= 0) return;
+    if (orate_ > 0) otokens_ = std::min(orate_, otokens_ + orate_ * elapsed);
+    if (brate_ > 0) btokens_ = std::min(brate_, btokens_ + brate_ * elapsed);
+  }
+  kc::SpinLock lock_;
+  double orate_;
+  double brate_;
+  kc::AtomicInt64 prior_;
+  double otokens_;
+  double btokens_;
+  double stamp_;
+  kc::AtomicInt64 readers_;
+  int64_t tcount_;
+  double ttime_;
+};
+const double WriteThrottle::PRIORWAIT = 0.01;
+
+
+/**
+ * Ring buffer of captured changes.
+ */
+class ChangeRing {
+ public:
+  /**
+   * Policies when the buffer is full.
+   */
+  enum Policy {
+    PBLOCK,                              ///< block the writer
+    PDISCARD,                            ///< discard the new change
+    POVERWRITE                           ///< overwrite the oldest change
+  };
+  /**
+   * Types of changes.
+   */
+  enum Type {
+    TSET = 1,                            ///< a record is stored
+    TREMOVE = 2,                         ///< a record is removed
+    TCLEAR = 3                           ///< all records are removed
+  };
+  /** The size of the header of each packed change. */
+  static const size_t PACKHEADSIZ = 17;
+  explicit ChangeRing(size_t capacity, Policy policy) :
+      slots_(NULL), mask_(0), policy_(policy), head_(0), tail_(0), dropped_(0),
+      plock_(), pending_(), haspending_(false) {
+    size_t num = 1;
+    while (num < capacity) num <<= 1;
+    slots_ = new Slot[num];
+    mask_ = num - 1;
+    for (size_t i = 0; i < num; i++) {
+      slots_[i].seq.set(i);
     }
-    return rv;
   }
-  bool midprocess() {
-    bool rv = env_->CallBooleanMethod(jmr_, id_mr_midproc_);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
+  ~ChangeRing() {
+    delete[] slots_;
+  }
+  void push(Type type, const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    while (true) {
+      int64_t pos = head_.get();
+      Slot* slot = slots_ + (pos & mask_);
+      int64_t seq = slot->seq.get();
+      if (seq == pos) {
+        if (head_.cas(pos, pos + 1)) {
+          slot->type = type;
+          slot->key.assign(kbuf ? kbuf : "", ksiz);
+          slot->value.assign(vbuf ? vbuf : "", vsiz);
+          slot->seq.add(1);
+          return;
+        }
+      } else if (seq < pos) {
+        switch (policy_) {
+          case PDISCARD: {
+            dropped_.add(1);
+            return;
+          }
+          case POVERWRITE: {
+            Change change;
+            if (take(&change)) dropped_.add(1);
+            break;
+          }
+          default: {
+            kc::Thread::yield();
+            break;
+          }
+        }
+      }
     }
-    return rv;
   }
-  bool postprocess() {
-    bool rv = env_->CallBooleanMethod(jmr_, id_mr_postproc_);
-    jthrowable jex = env_->ExceptionOccurred();
-    if (jex) {
-      if (jex_) env_->DeleteLocalRef(jex_);
-      jex_ = jex;
-      env_->ExceptionClear();
+  int32_t poll(char* buf, size_t size, int32_t max, size_t* sp) {
+    kc::ScopedSpinLock lock(&plock_);
+    char* wp = buf;
+    int32_t num = 0;
+    while (num < max) {
+      if (!haspending_) {
+        if (!take(&pending_)) break;
+        haspending_ = true;
+      }
+      size_t rsiz = PACKHEADSIZ + pending_.key.size() + pending_.value.size();
+      if (rsiz > size - (wp - buf)) {
+        if (num < 1) num = -1;
+        break;
+      }
+      kc::writefixnum(wp, pending_.seq, 8);
+      wp[8] = pending_.type;
+      kc::writefixnum(wp + 9, pending_.key.size(), 4);
+      kc::writefixnum(wp + 13, pending_.value.size(), 4);
+      wp += PACKHEADSIZ;
+      std::memcpy(wp, pending_.key.data(), pending_.key.size());
+      wp += pending_.key.size();
+      std::memcpy(wp, pending_.value.data(), pending_.value.size());
+      wp += pending_.value.size();
+      haspending_ = false;
+      num++;
     }
-    return rv;
+    *sp = wp - buf;
+    return num;
   }
-  bool log(const char* name, const char* message) {
-    return true;
+  void status(StringMap* strmap) {
+    int64_t head = head_.get();
+    int64_t tail = tail_.get();
+    (*strmap)["cdc_sequence"] = kc::strprintf("%lld", (long long)head);
+    (*strmap)["cdc_pending"] = kc::strprintf("%lld", (long long)(head - tail));
+    (*strmap)["cdc_dropped"] = kc::strprintf("%lld", (long long)dropped_.get());
   }
  private:
-  JNIEnv* env_;
-  jobject jmr_;
-  jclass cls_mr_;
-  jmethodID id_mr_map_;
-  jmethodID id_mr_reduce_;
-  jmethodID id_mr_preproc_;
-  jmethodID id_mr_midproc_;
-  jmethodID id_mr_postproc_;
-  jclass cls_viter_;
-  jmethodID id_viter_init_;
-  jthrowable jex_;
+  /**
+   * Slot of the buffer.  The sequence number tells whether the slot is free for the writer of
+   * a position or filled for the reader of it.  It is advanced by addition rather than set,
+   * because only addition implies a full memory barrier.
+   */
+  struct Slot {
+    kc::AtomicInt64 seq;
+    Type type;
+    std::string key;
+    std::string value;
+  };
+  /**
+   * Change taken out of the buffer.
+   */
+  struct Change {
+    int64_t seq;
+    Type type;
+    std::string key;
+    std::string value;
+  };
+  bool take(Change* change) {
+    while (true) {
+      int64_t pos = tail_.get();
+      Slot* slot = slots_ + (pos & mask_);
+      int64_t seq = slot->seq.get();
+      if (seq == pos + 1) {
+        if (tail_.cas(pos, pos + 1)) {
+          change->seq = pos + 1;
+          change->type = slot->type;
+          change->key.swap(slot->key);
+          change->value.swap(slot->value);
+          slot->seq.add(mask_);
+          return true;
+        }
+      } else if (seq < pos + 1) {
+        return false;
+      }
+    }
+  }
+  Slot* slots_;
+  int64_t mask_;
+  Policy policy_;
+  kc::AtomicInt64 head_;
+  kc::AtomicInt64 tail_;
+  kc::AtomicInt64 dropped_;
+  kc::SpinLock plock_;
+  Change pending_;
+  bool haspending_;
+};
+
+
+/**
+ * Update log written into a directory of rotated files.
+ */
+class UpdateLog {
+ public:
+  /** The magic data of each record. */
+  static const uint8_t RECMAGIC = 0xc9;
+  /** The size of the header of each record. */
+  static const size_t RECHEADSIZ = 18;
+  /** The suffix of log files. */
+  static const char* const FILESUFFIX;
+  explicit UpdateLog() :
+      lock_(), dir_(), limsiz_(0), file_(), opened_(false), stamp_(0), fails_(0) {}
+  ~UpdateLog() {
+    close();
+  }
+  bool open(const std::string& dir, int64_t limsiz) {
+    kc::ScopedMutex lock(&lock_);
+    kc::File::Status sbuf;
+    if (!kc::File::status(dir, &sbuf)) {
+      if (!kc::File::make_directory(dir)) return false;
+    } else if (!sbuf.isdir) {
+      return false;
+    }
+    dir_ = dir;
+    limsiz_ = limsiz;
+    StringVector files;
+    list_files(dir_, &files);
+    if (!files.empty()) stamp_ = file_stamp(files.back());
+    return true;
+  }
+  bool close() {
+    kc::ScopedMutex lock(&lock_);
+    if (!opened_) return true;
+    opened_ = false;
+    return file_.close();
+  }
+  bool write(uint8_t type, const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    kc::ScopedMutex lock(&lock_);
+    uint64_t ts = (uint64_t)(kc::time() * 1000000);
+    if (ts <= stamp_) ts = stamp_ + 1;
+    stamp_ = ts;
+    if (!opened_ || (limsiz_ > 0 && file_.size() >= limsiz_)) {
+      if (opened_) {
+        opened_ = false;
+        file_.close();
+      }
+      if (!file_.open(file_path(dir_, ts), kc::File::OWRITER | kc::File::OCREATE)) {
+        fails_++;
+        return false;
+      }
+      opened_ = true;
+    }
+    size_t rsiz = RECHEADSIZ + ksiz + vsiz;
+    char* rbuf = new char[rsiz];
+    char* wp = rbuf;
+    *(wp++) = RECMAGIC;
+    kc::writefixnum(wp, ts, 8);
+    wp += 8;
+    *(wp++) = type;
+    kc::writefixnum(wp, ksiz, 4);
+    wp += 4;
+    kc::writefixnum(wp, vsiz, 4);
+    wp += 4;
+    if (ksiz > 0) std::memcpy(wp, kbuf, ksiz);
+    wp += ksiz;
+    if (vsiz > 0) std::memcpy(wp, vbuf, vsiz);
+    bool err = false;
+    if (!file_.append(rbuf, rsiz)) {
+      fails_++;
+      err = true;
+    }
+    delete[] rbuf;
+    return !err;
+  }
+  bool synchronize(bool hard) {
+    kc::ScopedMutex lock(&lock_);
+    if (!opened_) return true;
+    return file_.synchronize(hard);
+  }
+  void status(StringMap* strmap) {
+    kc::ScopedMutex lock(&lock_);
+    (*strmap)["ulog_path"] = dir_;
+    (*strmap)["ulog_timestamp"] = kc::strprintf("%llu", (unsigned long long)stamp_);
+    (*strmap)["ulog_fails"] = kc::strprintf("%lld", (long long)fails_);
+  }
+  static std::string file_path(const std::string& dir, uint64_t ts) {
+    return kc::strprintf("%s%c%020llu%s", dir.c_str(), kc::File::PATHCHR,
+                         (unsigned long long)ts, FILESUFFIX);
+  }
+  static uint64_t file_stamp(const std::string& path) {
+    size_t pos = path.find_last_of(kc::File::PATHCHR);
+    pos = pos == std::string::npos ? 0 : pos + 1;
+    return kc::atoi(path.c_str() + pos);
+  }
+  static void list_files(const std::string& dir, StringVector* files) {
+    files->clear();
+    StringVector names;
+    if (!kc::File::read_directory(dir, &names)) return;
+    size_t sfxsiz = std::strlen(FILESUFFIX);
+    for (size_t i = 0; i < names.size(); i++) {
+      const std::string& name = names[i];
+      if (name.size() <= sfxsiz || name.compare(name.size() - sfxsiz, sfxsiz, FILESUFFIX))
+        continue;
+      files->push_back(dir + kc::File::PATHCHR + name);
+    }
+    std::sort(files->begin(), files->end());
+  }
+ private:
+  kc::Mutex lock_;
+  std::string dir_;
+  int64_t limsiz_;
+  kc::File file_;
+  bool opened_;
+  uint64_t stamp_;
+  int64_t fails_;
+};
+const char* const UpdateLog::FILESUFFIX = ".ulog";
+
+
+/**
+ * Reader of an update log.
+ */
+class UpdateLogReader {
+ public:
+  /**
+   * Record of the log.
+   */
+  struct Record {
+    uint64_t ts;
+    uint8_t type;
+    std::string key;
+    std::string value;
+  };
+  /**
+   * Position in the log.
+   */
+  struct Position {
+    std::string path;
+    int64_t off;
+    uint64_t ts;
+  };
+  explicit UpdateLogReader(const std::string& dir, uint64_t ts) : dir_(dir), ifs_(), pos_() {
+    pos_.off = 0;
+    pos_.ts = ts;
+  }
+  Position tell() {
+    return pos_;
+  }
+  void seek(const Position& pos) {
+    if (pos.path != pos_.path) ifs_.close();
+    pos_ = pos;
+  }
+  void close() {
+    ifs_.close();
+  }
+  int32_t read(Record* rec, uint64_t until) {
+    while (true) {
+      if (pos_.path.empty() && !locate()) return 0;
+      if (!ifs_.is_open()) {
+        ifs_.open(pos_.path.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!ifs_) {
+          ifs_.close();
+          return -1;
+        }
+      }
+      int32_t rv = read_record(rec);
+      if (rv < 0) return -1;
+      if (rv == 0) {
+        if (!advance()) return 0;
+        continue;
+      }
+      if (rec->ts <= pos_.ts) {
+        pos_.off += rv;
+        continue;
+      }
+      if (rec->ts > until) return 0;
+      pos_.off += rv;
+      pos_.ts = rec->ts;
+      return 1;
+    }
+  }
+ private:
+  bool locate() {
+    StringVector files;
+    UpdateLog::list_files(dir_, &files);
+    if (files.empty()) return false;
+    size_t idx = 0;
+    for (size_t i = 1; i < files.size(); i++) {
+      if (UpdateLog::file_stamp(files[i]) > pos_.ts) break;
+      idx = i;
+    }
+    pos_.path = files[idx];
+    pos_.off = 0;
+    return true;
+  }
+  bool advance() {
+    StringVector files;
+    UpdateLog::list_files(dir_, &files);
+    std::vector<std::string>::iterator it =
+        std::upper_bound(files.begin(), files.end(), pos_.path);
+    if (it == files.end()) return false;
+    ifs_.close();
+    pos_.path = *it;
+    pos_.off = 0;
+    return true;
+  }
+  int32_t read_record(Record* rec) {
+    ifs_.clear();
+    ifs_.seekg(pos_.off);
+    char hbuf[UpdateLog::RECHEADSIZ];
+    ifs_.read(hbuf, sizeof(hbuf));
+    if (ifs_.gcount() < (std::streamsize)sizeof(hbuf)) return 0;
+    if ((uint8_t)hbuf[0] != UpdateLog::RECMAGIC) return -1;
+    rec->ts = kc::readfixnum(hbuf + 1, 8);
+    rec->type = hbuf[9];
+    size_t ksiz = kc::readfixnum(hbuf + 10, 4);
+    size_t vsiz = kc::readfixnum(hbuf + 14, 4);
+    rec->key.resize(ksiz);
+    rec->value.resize(vsiz);
+    if (ksiz > 0) ifs_.read(&rec->key[0], ksiz);
+    if (ifs_.gcount() < (std::streamsize)ksiz) return 0;
+    if (vsiz > 0) ifs_.read(&rec->value[0], vsiz);
+    if (ifs_.gcount() < (std::streamsize)vsiz) return 0;
+    return sizeof(hbuf) + ksiz + vsiz;
+  }
+  std::string dir_;
+  std::ifstream ifs_;
+  Position pos_;
+};
+
+
+/**
+ * Secondary index stored in another database.
+ */
+class SecondaryIndex {
+ public:
+  /**
+   * Kinds of extractors.
+   */
+  enum Kind {
+    KRANGE,                              ///< byte range of the value
+    KFIELD,                              ///< delimiter-separated field of the value
+    KINTEGER                             ///< fixed-width big-endian integer in the value
+  };
+  explicit SecondaryIndex(const std::string& name, Kind kind, int32_t first, int32_t second) :
+      name_(name), kind_(kind), first_(first), second_(second), db_(), fails_(0),
+      plock_(), deferring_(false), pending_() {}
+  const std::string& name() {
+    return name_;
+  }
+  kc::PolyDB* db() {
+    return &db_;
+  }
+  int64_t fails() {
+    return fails_.get();
+  }
+  bool extract(const char* vbuf, size_t vsiz, std::string* dest) {
+    if (!vbuf) return false;
+    switch (kind_) {
+      case KRANGE: {
+        size_t off = first_ > 0 ? first_ : 0;
+        if (off > vsiz) return false;
+        size_t len = vsiz - off;
+        if (second_ > 0 && (size_t)second_ < len) len = second_;
+        dest->assign(vbuf + off, len);
+        return true;
+      }
+      case KFIELD: {
+        const char* rp = vbuf;
+        const char* ep = vbuf + vsiz;
+        for (int32_t i = 0; i < second_; i++) {
+          rp = (const char*)std::memchr(rp, (char)first_, ep - rp);
+          if (!rp) return false;
+          rp++;
+        }
+        const char* fp = (const char*)std::memchr(rp, (char)first_, ep - rp);
+        dest->assign(rp, (fp ? fp : ep) - rp);
+        return true;
+      }
+      case KINTEGER: {
+        size_t off = first_ > 0 ? first_ : 0;
+        size_t width = second_ > 0 && second_ < 8 ? second_ : 8;
+        if (off + width > vsiz) return false;
+        char nbuf[sizeof(uint64_t)];
+        kc::writefixnum(nbuf, kc::readfixnum(vbuf + off, width), sizeof(nbuf));
+        dest->assign(nbuf, sizeof(nbuf));
+        return true;
+      }
+    }
+    return false;
+  }
+  bool deferring() {
+    return deferring_;
+  }
+  /**
+   * Record the state of the primary database when the index is detached.
+   */
+  bool stamp(int64_t count, int64_t size, int64_t mtime) {
+    char sbuf[STAMPSIZ];
+    kc::writefixnum(sbuf, count, 8);
+    kc::writefixnum(sbuf + 8, size, 8);
+    kc::writefixnum(sbuf + 16, mtime, 8);
+    return db_.set("", 0, sbuf, sizeof(sbuf));
+  }
+  /**
+   * Remove the stamp and check whether it matches the state of the primary database.  The
+   * stamp record has the empty key, which no index entry has.
+   */
+  bool unstamp(int64_t count, int64_t size, int64_t mtime) {
+    size_t ssiz;
+    char* sbuf = db_.get("", 0, &ssiz);
+    if (!sbuf) return false;
+    bool rv = mtime >= 0 && ssiz == STAMPSIZ &&
+        (int64_t)kc::readfixnum(sbuf, 8) == count &&
+        (int64_t)kc::readfixnum(sbuf + 8, 8) == size &&
+        (int64_t)kc::readfixnum(sbuf + 16, 8) == mtime;
+    delete[] sbuf;
+    if (!db_.remove("", 0)) rv = false;
+    return rv;
+  }
+  /**
+   * End the transaction of the index database begun in step with the primary database.
+   */
+  void end_transaction(bool commit) {
+    if (!db_.end_transaction(commit)) fails_.add(1);
+  }
+  /**
+   * Hold updates instead of applying them until the end of deferring.
+   */
+  void begin_defer() {
+    kc::ScopedMutex lock(&plock_);
+    deferring_ = true;
+  }
+  /**
+   * Apply the held updates in order and stop deferring.
+   */
+  void end_defer() {
+    kc::ScopedMutex lock(&plock_);
+    std::vector<Update>::iterator it = pending_.begin();
+    std::vector<Update>::iterator itend = pending_.end();
+    while (it != itend) {
+      if (it->clear) {
+        if (!db_.clear()) fails_.add(1);
+      } else {
+        apply(it->key.data(), it->key.size(),
+              it->ohit ? it->oval.data() : NULL, it->oval.size(),
+              it->nhit ? it->nval.data() : NULL, it->nval.size());
+      }
+      ++it;
+    }
+    pending_.clear();
+    deferring_ = false;
+  }
+  void update(const char* kbuf, size_t ksiz, const char* obuf, size_t osiz,
+              const char* nbuf, size_t nsiz) {
+    if (deferring_) {
+      kc::ScopedMutex lock(&plock_);
+      if (deferring_) {
+        pending_.push_back(Update());
+        Update& upd = pending_.back();
+        upd.clear = false;
+        upd.key.assign(kbuf, ksiz);
+        upd.ohit = obuf != NULL;
+        if (obuf) upd.oval.assign(obuf, osiz);
+        upd.nhit = nbuf != NULL;
+        if (nbuf) upd.nval.assign(nbuf, nsiz);
+        return;
+      }
+    }
+    apply(kbuf, ksiz, obuf, osiz, nbuf, nsiz);
+  }
+  void clear() {
+    if (deferring_) {
+      kc::ScopedMutex lock(&plock_);
+      if (deferring_) {
+        pending_.push_back(Update());
+        pending_.back().clear = true;
+        return;
+      }
+    }
+    db_.clear();
+  }
+  void apply(const char* kbuf, size_t ksiz, const char* obuf, size_t osiz,
+             const char* nbuf, size_t nsiz) {
+    std::string oval, nval;
+    bool ohit = extract(obuf, osiz, &oval);
+    bool nhit = extract(nbuf, nsiz, &nval);
+    if (ohit && nhit && oval == nval) return;
+    if (ohit) {
+      std::string ikey = prefix(oval.data(), oval.size());
+      ikey.append(kbuf, ksiz);
+      if (!db_.remove(ikey) && db_.error() != kc::PolyDB::Error::NOREC) fails_.add(1);
+    }
+    if (nhit) {
+      std::string ikey = prefix(nval.data(), nval.size());
+      ikey.append(kbuf, ksiz);
+      if (!db_.set(ikey, "")) fails_.add(1);
+    }
+  }
+  bool lookup(const char* vbuf, size_t vsiz, int64_t max, StringVector* keys) {
+    std::string pfx = prefix(vbuf, vsiz);
+    if (db_.match_prefix(pfx, keys, max) < 0) return false;
+    for (size_t i = 0; i < keys->size(); i++) {
+      (*keys)[i].erase(0, pfx.size());
+    }
+    return true;
+  }
+ private:
+  /** The size of the stamp of the primary database. */
+  static const size_t STAMPSIZ = 24;
+  /**
+   * Update held while deferring.
+   */
+  struct Update {
+    bool clear;
+    std::string key;
+    bool ohit;
+    std::string oval;
+    bool nhit;
+    std::string nval;
+  };
+  static std::string prefix(const char* vbuf, size_t vsiz) {
+    char hbuf[sizeof(uint32_t)];
+    kc::writefixnum(hbuf, vsiz, sizeof(hbuf));
+    std::string pfx(hbuf, sizeof(hbuf));
+    pfx.append(vbuf, vsiz);
+    return pfx;
+  }
+  std::string name_;
+  Kind kind_;
+  int32_t first_;
+  int32_t second_;
+  kc::PolyDB db_;
+  kc::AtomicInt64 fails_;
+  kc::Mutex plock_;
+  bool deferring_;
+  std::vector<Update> pending_;
+};
+
+
+/**
+ * Bloom filter of keys.
+ */
+class BloomFilter {
+ public:
+  /** The magic data of the persisted filter. */
+  static const char* const MAGIC;
+  /** The size of the header of the persisted filter. */
+  static const size_t HEADSIZ = 52;
+  explicit BloomFilter(int64_t num, double fprate) : words_(NULL), bnum_(0), hnum_(0), knum_(0) {
+    if (num < 1) num = 1;
+    double bits = -num * std::log(fprate) / (std::log(2.0) * std::log(2.0));
+    bnum_ = ((uint64_t)bits / 64 + 1) * 64;
+    hnum_ = (uint64_t)(bnum_ * std::log(2.0) / num + 0.5);
+    if (hnum_ < 1) hnum_ = 1;
+    if (hnum_ > 16) hnum_ = 16;
+    words_ = new kc::AtomicInt64[bnum_/64];
+  }
+  ~BloomFilter() {
+    delete[] words_;
+  }
+  void add(const char* kbuf, size_t ksiz) {
+    uint64_t hash = kc::hashmurmur(kbuf, ksiz);
+    uint64_t step = kc::hashfnv(kbuf, ksiz) | 1;
+    for (uint64_t i = 0; i < hnum_; i++) {
+      uint64_t idx = (hash + i * step) % bnum_;
+      kc::AtomicInt64* word = words_ + (idx >> 6);
+      int64_t mask = (int64_t)((uint64_t)1 << (idx & 63));
+      while (true) {
+        int64_t cur = word->get();
+        if ((cur & mask) || word->cas(cur, cur | mask)) break;
+      }
+    }
+    knum_.add(1);
+  }
+  bool check(const char* kbuf, size_t ksiz) {
+    uint64_t hash = kc::hashmurmur(kbuf, ksiz);
+    uint64_t step = kc::hashfnv(kbuf, ksiz) | 1;
+    for (uint64_t i = 0; i < hnum_; i++) {
+      uint64_t idx = (hash + i * step) % bnum_;
+      if (!(words_[idx>>6].get() & (int64_t)((uint64_t)1 << (idx & 63)))) return false;
+    }
+    return true;
+  }
+  uint64_t bits() {
+    return bnum_;
+  }
+  uint64_t hashes() {
+    return hnum_;
+  }
+  int64_t keys() {
+    return knum_.get();
+  }
+  double fprate() {
+    return std::pow(1 - std::exp(-(double)hnum_ * knum_.get() / bnum_), (double)hnum_);
+  }
+  bool save(const std::string& path, int64_t count, int64_t size, int64_t mtime) {
+    size_t wnum = bnum_ / 64;
+    size_t fsiz = HEADSIZ + wnum * sizeof(uint64_t);
+    char* fbuf = new char[fsiz];
+    char* wp = fbuf;
+    std::memcpy(wp, MAGIC, 4);
+    kc::writefixnum(wp + 4, count, 8);
+    kc::writefixnum(wp + 12, size, 8);
+    kc::writefixnum(wp + 20, mtime, 8);
+    kc::writefixnum(wp + 28, bnum_, 8);
+    kc::writefixnum(wp + 36, hnum_, 8);
+    kc::writefixnum(wp + 44, knum_.get(), 8);
+    wp += HEADSIZ;
+    for (size_t i = 0; i < wnum; i++) {
+      kc::writefixnum(wp, words_[i].get(), sizeof(uint64_t));
+      wp += sizeof(uint64_t);
+    }
+    bool rv = kc::File::write_file(path, fbuf, fsiz);
+    delete[] fbuf;
+    return rv;
+  }
+  static BloomFilter* load(const std::string& path, int64_t count, int64_t size,
+                           int64_t mtime) {
+    int64_t fsiz;
+    char* fbuf = kc::File::read_file(path, &fsiz);
+    if (!fbuf) return NULL;
+    BloomFilter* filter = NULL;
+    if (fsiz >= (int64_t)HEADSIZ && !std::memcmp(fbuf, MAGIC, 4) &&
+        (int64_t)kc::readfixnum(fbuf + 4, 8) == count &&
+        (int64_t)kc::readfixnum(fbuf + 12, 8) == size &&
+        (int64_t)kc::readfixnum(fbuf + 20, 8) == mtime) {
+      uint64_t bnum = kc::readfixnum(fbuf + 28, 8);
+      uint64_t hnum = kc::readfixnum(fbuf + 36, 8);
+      if (bnum > 0 && bnum % 64 == 0 && hnum > 0 && hnum <= 16 &&
+          fsiz == (int64_t)(HEADSIZ + bnum / 64 * sizeof(uint64_t))) {
+        filter = new BloomFilter(bnum, hnum);
+        filter->knum_.set(kc::readfixnum(fbuf + 44, 8));
+        const char* rp = fbuf + HEADSIZ;
+        for (uint64_t i = 0; i < bnum / 64; i++) {
+          filter->words_[i].set(kc::readfixnum(rp, sizeof(uint64_t)));
+          rp += sizeof(uint64_t);
+        }
+      }
+    }
+    delete[] fbuf;
+    return filter;
+  }
+ private:
+  explicit BloomFilter(uint64_t bnum, uint64_t hnum) :
+      words_(new kc::AtomicInt64[bnum/64]), bnum_(bnum), hnum_(hnum), knum_(0) {}
+  kc::AtomicInt64* words_;
+  uint64_t bnum_;
+  uint64_t hnum_;
+  kc::AtomicInt64 knum_;
+};
+const char* const BloomFilter::MAGIC = "KCJC";
+
+
+/**
+ * Filter to skip lookups of missing keys.
+ */
+class KeyFilter {
+ public:
+  explicit KeyFilter(kc::PolyDB* db) :
+      db_(db), lock_(), wlock_(), expected_(0), fprate_(0), cur_(NULL), next_(NULL),
+      worker_(NULL), running_(0), removed_(0), negatives_(0), rebuilds_(0), dbpath_(),
+      path_(), scount_(0), ssize_(0), writable_(false) {}
+  ~KeyFilter() {
+    close(false);
+  }
+  void tune(int64_t expected, double fprate) {
+    expected_ = expected;
+    fprate_ = fprate;
+  }
+  bool tuned() {
+    return fprate_ > 0 && fprate_ < 1;
+  }
+  bool enabled() {
+    return cur_ != NULL;
+  }
+  void open(uint32_t mode, int64_t mtime) {
+    if (!tuned()) return;
+    writable_ = mode & kc::PolyDB::OWRITER;
+    int64_t count = db_->count();
+    int64_t size = db_->size();
+    std::string path = db_->path() + SIDECARSUFFIX;
+    BloomFilter* filter = NULL;
+    if (kc::File::status(db_->path())) {
+      dbpath_ = db_->path();
+      path_ = path;
+      if (mtime >= 0) filter = BloomFilter::load(path, count, size, mtime);
+      if (writable_) kc::File::remove(path);
+    }
+    if (!filter) filter = build(count);
+    kc::ScopedSpinRWLock lock(&lock_, true);
+    cur_ = filter;
+    removed_.set(0);
+  }
+  void detach() {
+    join();
+    scount_ = db_->count();
+    ssize_ = db_->size();
+  }
+  bool close(bool save) {
+    join();
+    bool err = false;
+    if (cur_ && save && writable_ && !path_.empty()) {
+      int64_t mtime = KeyFilter::mtime(dbpath_);
+      kc::ScopedSpinRWLock lock(&lock_, false);
+      if (mtime < 0 || !cur_->save(path_, scount_, ssize_, mtime)) err = true;
+    }
+    kc::ScopedSpinRWLock lock(&lock_, true);
+    delete cur_;
+    cur_ = NULL;
+    dbpath_.clear();
+    path_.clear();
+    return !err;
+  }
+  static int64_t mtime(const std::string& path) {
+    kc::File::Status sbuf;
+    if (!kc::File::status(path.substr(0, path.find('#')), &sbuf)) return -1;
+    return sbuf.mtime;
+  }
+  bool check(const char* kbuf, size_t ksiz) {
+    kc::ScopedSpinRWLock lock(&lock_, false);
+    if (!cur_ || cur_->check(kbuf, ksiz)) return true;
+    negatives_.add(1);
+    return false;
+  }
+  void add(const char* kbuf, size_t ksiz) {
+    kc::ScopedSpinRWLock lock(&lock_, false);
+    if (cur_) cur_->add(kbuf, ksiz);
+    if (next_) next_->add(kbuf, ksiz);
+  }
+  void remove() {
+    int64_t removed = removed_.add(1) + 1;
+    int64_t keys;
+    {
+      kc::ScopedSpinRWLock lock(&lock_, false);
+      if (!cur_) return;
+      keys = cur_->keys();
+    }
+    if (removed >= REBUILDMIN && removed * 2 > keys) refresh();
+  }
+  /**
+   * Rebuild the filter in the background unless it is being rebuilt.
+   */
+  void refresh() {
+    if (!running_.cas(0, 1)) return;
+    kc::ScopedMutex lock(&wlock_);
+    if (worker_) {
+      worker_->join();
+      delete worker_;
+    }
+    worker_ = new Worker(this);
+    worker_->start();
+  }
+  void clear() {
+    kc::ScopedSpinRWLock lock(&lock_, true);
+    if (!cur_) return;
+    delete cur_;
+    cur_ = new BloomFilter(sizing(0), fprate_);
+    removed_.set(0);
+  }
+  void status(StringMap* strmap) {
+    kc::ScopedSpinRWLock lock(&lock_, false);
+    if (!cur_) return;
+    (*strmap)["bloom_bits"] = kc::strprintf("%llu", (unsigned long long)cur_->bits());
+    (*strmap)["bloom_hashes"] = kc::strprintf("%llu", (unsigned long long)cur_->hashes());
+    (*strmap)["bloom_keys"] = kc::strprintf("%lld", (long long)cur_->keys());
+    (*strmap)["bloom_memory"] = kc::strprintf("%llu", (unsigned long long)(cur_->bits() / 8));
+    (*strmap)["bloom_fprate"] = kc::strprintf("%.6f", cur_->fprate());
+    (*strmap)["bloom_removed"] = kc::strprintf("%lld", (long long)removed_.get());
+    (*strmap)["bloom_negatives"] = kc::strprintf("%lld", (long long)negatives_.get());
+    (*strmap)["bloom_rebuilds"] = kc::strprintf("%lld", (long long)rebuilds_.get());
+  }
+ private:
+  /** The suffix of the sidecar file. */
+  static const char* const SIDECARSUFFIX;
+  /** The minimum number of removed keys to trigger rebuilding. */
+  static const int64_t REBUILDMIN = 1024;
+  /**
+   * Thread to rebuild the filter.
+   */
+  class Worker : public kc::Thread {
+   public:
+    explicit Worker(KeyFilter* filter) : filter_(filter) {}
+    void run() {
+      filter_->rebuild();
+    }
+   private:
+    KeyFilter* filter_;
+  };
+  int64_t sizing(int64_t count) {
+    int64_t num = count * 2;
+    if (num < expected_) num = expected_;
+    if (num < (1 << 16)) num = 1 << 16;
+    return num;
+  }
+  BloomFilter* build(int64_t count) {
+    BloomFilter* filter = new BloomFilter(sizing(count), fprate_);
+    scan(filter);
+    return filter;
+  }
+  void scan(BloomFilter* filter) {
+    kc::PolyDB::Cursor* cur = db_->cursor();
+    cur->jump();
+    char* kbuf;
+    size_t ksiz;
+    while ((kbuf = cur->get_key(&ksiz, true)) != NULL) {
+      filter->add(kbuf, ksiz);
+      delete[] kbuf;
+    }
+    delete cur;
+  }
+  void rebuild() {
+    BloomFilter* filter = new BloomFilter(sizing(db_->count()), fprate_);
+    {
+      kc::ScopedSpinRWLock lock(&lock_, true);
+      next_ = filter;
+      removed_.set(0);
+    }
+    scan(filter);
+    {
+      kc::ScopedSpinRWLock lock(&lock_, true);
+      if (cur_) {
+        delete cur_;
+        cur_ = next_;
+      } else {
+        delete next_;
+      }
+      next_ = NULL;
+    }
+    rebuilds_.add(1);
+    running_.set(0);
+  }
+  void join() {
+    kc::ScopedMutex lock(&wlock_);
+    if (!worker_) return;
+    worker_->join();
+    delete worker_;
+    worker_ = NULL;
+  }
+  kc::PolyDB* db_;
+  kc::SpinRWLock lock_;
+  kc::Mutex wlock_;
+  int64_t expected_;
+  double fprate_;
+  BloomFilter* cur_;
+  BloomFilter* next_;
+  Worker* worker_;
+  kc::AtomicInt64 running_;
+  kc::AtomicInt64 removed_;
+  kc::AtomicInt64 negatives_;
+  kc::AtomicInt64 rebuilds_;
+  std::string dbpath_;
+  std::string path_;
+  int64_t scount_;
+  int64_t ssize_;
+  bool writable_;
+};
+const char* const KeyFilter::SIDECARSUFFIX = ".kcbf";
+
+
+/**
+ * Front cache of hot records.
+ */
+class FrontCache {
+ public:
+  explicit FrontCache() : capacity_(0), hits_(0), misses_(0), evictions_(0) {
+    for (size_t i = 0; i < SLOTNUM; i++) {
+      Slot* slot = slots_ + i;
+      slot->recs = NULL;
+      slot->size = 0;
+      slot->gen = 0;
+    }
+  }
+  ~FrontCache() {
+    for (size_t i = 0; i < SLOTNUM; i++) {
+      delete slots_[i].recs;
+    }
+  }
+  void tune(int64_t capacity) {
+    capacity_ = capacity > 0 ? capacity : 0;
+    size_t bnum = capacity_ / SLOTNUM / RECBASESIZ + 1;
+    for (size_t i = 0; i < SLOTNUM; i++) {
+      Slot* slot = slots_ + i;
+      kc::ScopedSpinLock lock(&slot->lock);
+      delete slot->recs;
+      slot->recs = capacity_ > 0 ? new RecordMap(bnum) : NULL;
+      slot->size = 0;
+      slot->gen++;
+    }
+  }
+  bool enabled() {
+    return capacity_ > 0;
+  }
+  int64_t generation(const char* kbuf, size_t ksiz) {
+    Slot* slot = slots_ + kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    kc::ScopedSpinLock lock(&slot->lock);
+    return slot->gen;
+  }
+  bool get(const char* kbuf, size_t ksiz, std::string* value) {
+    Slot* slot = slots_ + kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    std::string key(kbuf, ksiz);
+    kc::ScopedSpinLock lock(&slot->lock);
+    if (!slot->recs) return false;
+    std::string* rec = slot->recs->get(key, RecordMap::MLAST);
+    if (!rec) {
+      misses_.add(1);
+      return false;
+    }
+    value->assign(*rec);
+    hits_.add(1);
+    return true;
+  }
+  void put(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz, int64_t gen) {
+    int64_t rsiz = RECBASESIZ + ksiz + vsiz;
+    if (rsiz > capacity_ / (int64_t)SLOTNUM) return;
+    Slot* slot = slots_ + kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    std::string key(kbuf, ksiz);
+    kc::ScopedSpinLock lock(&slot->lock);
+    if (!slot->recs || slot->gen != gen) return;
+    std::string* rec = slot->recs->get(key, RecordMap::MLAST);
+    if (rec) {
+      slot->size -= RECBASESIZ + ksiz + rec->size();
+      rec->assign(vbuf, vsiz);
+    } else {
+      slot->recs->set(key, std::string(vbuf, vsiz), RecordMap::MLAST);
+    }
+    slot->size += rsiz;
+    while (slot->size > capacity_ / (int64_t)SLOTNUM && slot->recs->count() > 0) {
+      const std::string* fkey = slot->recs->first_key();
+      const std::string* fvalue = slot->recs->first_value();
+      if (!fkey || !fvalue) break;
+      std::string okey = *fkey;
+      slot->size -= RECBASESIZ + okey.size() + fvalue->size();
+      slot->recs->remove(okey);
+      evictions_.add(1);
+    }
+  }
+  void invalidate(const char* kbuf, size_t ksiz) {
+    Slot* slot = slots_ + kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    std::string key(kbuf, ksiz);
+    kc::ScopedSpinLock lock(&slot->lock);
+    slot->gen++;
+    if (!slot->recs) return;
+    std::string* rec = slot->recs->get(key, RecordMap::MCURRENT);
+    if (!rec) return;
+    slot->size -= RECBASESIZ + ksiz + rec->size();
+    slot->recs->remove(key);
+  }
+  void clear() {
+    for (size_t i = 0; i < SLOTNUM; i++) {
+      Slot* slot = slots_ + i;
+      kc::ScopedSpinLock lock(&slot->lock);
+      slot->gen++;
+      if (slot->recs) slot->recs->clear();
+      slot->size = 0;
+    }
+  }
+  void status(StringMap* strmap) {
+    if (!enabled()) return;
+    int64_t count = 0;
+    int64_t size = 0;
+    for (size_t i = 0; i < SLOTNUM; i++) {
+      Slot* slot = slots_ + i;
+      kc::ScopedSpinLock lock(&slot->lock);
+      if (slot->recs) count += slot->recs->count();
+      size += slot->size;
+    }
+    (*strmap)["fcache_count"] = kc::strprintf("%lld", (long long)count);
+    (*strmap)["fcache_size"] = kc::strprintf("%lld", (long long)size);
+    (*strmap)["fcache_hits"] = kc::strprintf("%lld", (long long)hits_.get());
+    (*strmap)["fcache_misses"] = kc::strprintf("%lld", (long long)misses_.get());
+    (*strmap)["fcache_evictions"] = kc::strprintf("%lld", (long long)evictions_.get());
+  }
+ private:
+  /** The number of slots. */
+  static const size_t SLOTNUM = 16;
+  /** The base size of each record for accounting. */
+  static const int64_t RECBASESIZ = 64;
+  typedef kc::LinkedHashMap<std::string, std::string> RecordMap;
+  /**
+   * Slot of records.
+   */
+  struct Slot {
+    kc::SpinLock lock;
+    RecordMap* recs;
+    int64_t size;
+    int64_t gen;
+  };
+  Slot slots_[SLOTNUM];
+  int64_t capacity_;
+  kc::AtomicInt64 hits_;
+  kc::AtomicInt64 misses_;
+  kc::AtomicInt64 evictions_;
+};
+
+
+/**
+ * Holder of an external database.  It is a base class preceding kc::PolyDB so that the
+ * external database is deleted after the destructor of kc::PolyDB has closed it.
+ */
+class ExternalDBHolder {
+ protected:
+  explicit ExternalDBHolder(kc::BasicDB* edb) : edb_(edb) {}
+  ~ExternalDBHolder() {
+    delete edb_;
+  }
+  kc::BasicDB* edb_;
 };
 
 
 /**
- * Throw a runtime error.
+ * Wrapper of a database.
+ */
+class SoftDB : private ExternalDBHolder, public kc::PolyDB {
+ public:
+  explicit SoftDB() :
+      ExternalDBHolder(NULL), gcom_(this), bsync_(this), throttle_(), cdc_(NULL), ulog_(NULL),
+      olock_(ORDERSLOTNUM), tlock_(), tran_(false), pending_(), ilock_(), indices_(),
+      kfilter_(this), kcleared_(false), fcache_(), opened_(false),
+      omtime_(-1), touched_(false) {}
+  explicit SoftDB(kc::BasicDB* edb) :
+      ExternalDBHolder(edb), kc::PolyDB(edb), gcom_(this), bsync_(this), throttle_(),
+      cdc_(NULL), ulog_(NULL), olock_(ORDERSLOTNUM), tlock_(), tran_(false), pending_(),
+      ilock_(), indices_(), kfilter_(this), kcleared_(false), fcache_(), opened_(false),
+      omtime_(-1), touched_(false) {}
+  ~SoftDB() {
+    bsync_.stop();
+    close_indices(-1, -1, -1);
+    delete cdc_;
+    delete ulog_;
+  }
+  bool open(const std::string& path = ":", uint32_t mode = OWRITER | OCREATE) {
+    int64_t mtime = KeyFilter::mtime(path);
+    if (!kc::PolyDB::open(path, mode)) return false;
+    opened_ = true;
+    omtime_ = mtime;
+    touched_ = false;
+    kfilter_.open(mode, mtime);
+    if (mode & OWRITER) bsync_.start();
+    return true;
+  }
+  bool close() {
+    bsync_.stop();
+    kfilter_.detach();
+    std::string path = this->path();
+    int64_t count = this->count();
+    int64_t size = this->size();
+    if (!kc::PolyDB::close()) {
+      kfilter_.close(false);
+      return false;
+    }
+    bool saved = kfilter_.close(true);
+    fcache_.clear();
+    opened_ = false;
+    bsync_.mark();
+    if (!close_indices(count, size, KeyFilter::mtime(path))) {
+      set_error(_KCCODELINE_, Error::SYSTEM, "closing an index failed");
+      return false;
+    }
+    if (ulog_) {
+      bool err = !ulog_->close();
+      delete ulog_;
+      ulog_ = NULL;
+      if (err) {
+        set_error(_KCCODELINE_, Error::SYSTEM, "closing the update log failed");
+        return false;
+      }
+    }
+    if (!saved) {
+      set_error(_KCCODELINE_, Error::SYSTEM, "saving the bloom filter failed");
+      return false;
+    }
+    return true;
+  }
+  bool open_with_ulog(const std::string& path, uint32_t mode,
+                      const std::string& dir, int64_t limsiz) {
+    if (opened_) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    UpdateLog* ulog = new UpdateLog;
+    if (!ulog->open(dir, limsiz)) {
+      delete ulog;
+      set_error(_KCCODELINE_, Error::NOREPOS, "opening the update log failed");
+      return false;
+    }
+    ulog_ = ulog;
+    if (!open(path, mode)) {
+      ulog_ = NULL;
+      delete ulog;
+      return false;
+    }
+    return true;
+  }
+  bool synchronize(bool hard = false, FileProcessor* proc = NULL,
+                   ProgressChecker* checker = NULL) {
+    if (!kc::PolyDB::synchronize(hard, proc, checker)) return false;
+    if (ulog_ && !ulog_->synchronize(hard)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, "synchronizing the update log failed");
+      return false;
+    }
+    return true;
+  }
+  bool accept(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable = true) {
+    if (!writable) {
+      std::string value;
+      if (fcache_.enabled() && fcache_.get(kbuf, ksiz, &value)) {
+        size_t sp;
+        visitor->visit_full(kbuf, ksiz, value.data(), value.size(), &sp);
+        return true;
+      }
+      if (!kfilter_.check(kbuf, ksiz)) {
+        size_t sp;
+        visitor->visit_empty(kbuf, ksiz, &sp);
+        return true;
+      }
+      ScopedRead read(&throttle_);
+      if (!fcache_.enabled()) return kc::PolyDB::accept(kbuf, ksiz, visitor, false);
+      int64_t gen = fcache_.generation(kbuf, ksiz);
+      FillVisitor filler(visitor, &value);
+      if (!kc::PolyDB::accept(kbuf, ksiz, &filler, false)) return false;
+      if (filler.hit()) fcache_.put(kbuf, ksiz, value.data(), value.size(), gen);
+      return true;
+    }
+    throttle_.admit();
+    ScopedOrder order(this, kbuf, ksiz);
+    WatchVisitor watcher(this, visitor);
+    bool rv = kc::PolyDB::accept(kbuf, ksiz, &watcher, true);
+    watcher.publish(rv);
+    return rv;
+  }
+  bool accept_bulk(const std::vector<std::string>& keys, Visitor* visitor,
+                   bool writable = true) {
+    if (!writable) {
+      ScopedRead read(&throttle_);
+      return kc::PolyDB::accept_bulk(keys, visitor, false);
+    }
+    throttle_.admit();
+    ScopedOrder order(this, keys);
+    WatchVisitor watcher(this, visitor);
+    bool rv = kc::PolyDB::accept_bulk(keys, &watcher, true);
+    watcher.publish(rv);
+    return rv;
+  }
+  bool iterate(Visitor* visitor, bool writable = true, ProgressChecker* checker = NULL) {
+    if (!writable) return kc::PolyDB::iterate(visitor, false, checker);
+    throttle_.admit();
+    ScopedOrder order(this);
+    WatchVisitor watcher(this, visitor);
+    bool rv = kc::PolyDB::iterate(&watcher, true, checker);
+    watcher.publish(rv);
+    return rv;
+  }
+  bool clear() {
+    ScopedOrder order(this);
+    if (!kc::PolyDB::clear()) return false;
+    notify(NULL, 0, NULL, 0, NULL, 0);
+    if (logging()) {
+      ChangeList changes(1);
+      changes.back().type = ChangeRing::TCLEAR;
+      emit(&changes);
+    }
+    return true;
+  }
+  bool begin_transaction(bool hard = false) {
+    while (!begin_transaction_try(hard)) {
+      if (error() != Error::LOGIC) return false;
+      kc::Thread::chill();
+    }
+    return true;
+  }
+  bool begin_transaction_try(bool hard = false) {
+    ScopedOrder order(this);
+    if (!kc::PolyDB::begin_transaction_try(hard)) return false;
+    kc::ScopedSpinRWLock lock(&ilock_, false);
+    std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+    std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+    while (it != itend) {
+      SecondaryIndex* index = *it;
+      if (index->deferring()) {
+        set_error(_KCCODELINE_, Error::LOGIC, "an index is being built");
+        break;
+      }
+      if (!index->db()->begin_transaction(hard)) {
+        Error e = index->db()->error();
+        set_error(_KCCODELINE_, e.code(), e.message());
+        break;
+      }
+      ++it;
+    }
+    if (it != itend) {
+      Error e = error();
+      while (it != indices_.begin()) {
+        --it;
+        (*it)->end_transaction(false);
+      }
+      kc::PolyDB::end_transaction(false);
+      set_error(_KCCODELINE_, e.code(), e.message());
+      return false;
+    }
+    tran_ = true;
+    return true;
+  }
+  bool end_transaction(bool commit = true) {
+    ScopedOrder order(this);
+    bool rv = kc::PolyDB::end_transaction(commit);
+    if (!tran_) return rv;
+    {
+      kc::ScopedSpinRWLock lock(&ilock_, false);
+      std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+      std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+      while (it != itend) {
+        (*it)->end_transaction(rv && commit);
+        ++it;
+      }
+      tran_ = false;
+    }
+    if (!commit) fcache_.clear();
+    if (kcleared_) {
+      if (rv && commit) kfilter_.refresh();
+      kcleared_ = false;
+    }
+    ChangeList changes;
+    changes.swap(pending_);
+    if (rv && commit) emit(&changes);
+    return rv;
+  }
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    if (edb_) return edb_->copy(dest, checker);
+    return kc::PolyDB::copy(dest, checker);
+  }
+  bool status(std::map<std::string, std::string>* strmap) {
+    if (!kc::PolyDB::status(strmap)) return false;
+    throttle_.status(strmap);
+    if (cdc_) cdc_->status(strmap);
+    if (ulog_) ulog_->status(strmap);
+    kfilter_.status(strmap);
+    fcache_.status(strmap);
+    kc::ScopedSpinRWLock lock(&ilock_, false);
+    std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+    std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+    while (it != itend) {
+      SecondaryIndex* index = *it;
+      (*strmap)["index_" + index->name()] = kc::strprintf("%lld", (long long)index->db()->count());
+      (*strmap)["index_fails_" + index->name()] = kc::strprintf("%lld", (long long)index->fails());
+      ++it;
+    }
+    return true;
+  }
+  Cursor* cursor() {
+    return new WatchCursor(this);
+  }
+  /**
+   * Interface to append a value to a record without reading it.
+   */
+  class Appender {
+   public:
+    virtual ~Appender() {}
+    virtual bool append(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) = 0;
+  };
+  /**
+   * Append a value to a record by the appender.  If the secondary indices, the change data
+   * capture, or the update log need the whole new value, the record is read and rewritten by the
+   * visitor interface instead.
+   */
+  bool append(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz, Appender* appender) {
+    throttle_.admit();
+    {
+      kc::ScopedSpinRWLock lock(&ilock_, false);
+      if (indices_.empty() && !logging()) {
+        if (!appender->append(kbuf, ksiz, vbuf, vsiz)) return false;
+        touched_ = true;
+        bsync_.note(ksiz + vsiz);
+        throttle_.charge(ksiz + vsiz);
+        if (fcache_.enabled()) fcache_.invalidate(kbuf, ksiz);
+        if (kfilter_.enabled()) kfilter_.add(kbuf, ksiz);
+        return true;
+      }
+    }
+    return kc::PolyDB::append(kbuf, ksiz, vbuf, vsiz);
+  }
+  GroupCommitter* committer() {
+    return gcom_.enabled() ? &gcom_ : NULL;
+  }
+  void tune_group_commit(bool enabled, bool hard) {
+    gcom_.tune(enabled, hard);
+  }
+  BackgroundSynchronizer* synchronizer() {
+    return &bsync_;
+  }
+  void tune_background_sync(double interval, int64_t bsiz, bool hard) {
+    bsync_.tune(interval, bsiz, hard);
+    if (!bsync_.tuned()) {
+      bsync_.stop();
+    } else if (type() != TYPEVOID) {
+      bsync_.start();
+    }
+  }
+  void tune_throttle(double orate, double brate, bool prior) {
+    throttle_.tune(orate, brate, prior);
+  }
+  bool tune_change_capture(size_t capacity, ChangeRing::Policy policy) {
+    if (opened_) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    delete cdc_;
+    cdc_ = capacity > 0 ? new ChangeRing(capacity, policy) : NULL;
+    return true;
+  }
+  ChangeRing* change_ring() {
+    return cdc_;
+  }
+  bool tune_bloom_filter(int64_t expected, double fprate) {
+    if (opened_) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    kfilter_.tune(expected, fprate);
+    return true;
+  }
+  bool tune_front_cache(int64_t capacity) {
+    if (opened_) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    fcache_.tune(capacity);
+    return true;
+  }
+  bool add_index(const std::string& name, const std::string& path,
+                 SecondaryIndex::Kind kind, int32_t first, int32_t second) {
+    if (!opened_) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    SecondaryIndex* index = new SecondaryIndex(name, kind, first, second);
+    kc::PolyDB* idb = index->db();
+    {
+      kc::ScopedSpinRWLock lock(&ilock_, true);
+      if (tran_) {
+        set_error(_KCCODELINE_, Error::LOGIC, "in a transaction");
+        delete index;
+        return false;
+      }
+      if (find_index(name)) {
+        set_error(_KCCODELINE_, Error::DUPREC, "duplicated index");
+        delete index;
+        return false;
+      }
+      if (!idb->open(path, OWRITER | OCREATE)) {
+        Error e = idb->error();
+        set_error(_KCCODELINE_, e.code(), e.message());
+        delete index;
+        return false;
+      }
+      bool fresh = !touched_ && index->unstamp(count(), size(), omtime_);
+      if (fresh) {
+        indices_.push_back(index);
+        return true;
+      }
+      if (!idb->clear()) {
+        Error e = idb->error();
+        set_error(_KCCODELINE_, e.code(), e.message());
+        idb->close();
+        delete index;
+        return false;
+      }
+      index->begin_defer();
+      indices_.push_back(index);
+    }
+    IndexBuilder builder(index);
+    bool ok = kc::PolyDB::iterate(&builder, false);
+    kc::ScopedSpinRWLock lock(&ilock_, true);
+    if (!ok) {
+      indices_.erase(std::find(indices_.begin(), indices_.end(), index));
+      idb->close();
+      delete index;
+      return false;
+    }
+    index->end_defer();
+    return true;
+  }
+  bool index_lookup(const std::string& name, const char* vbuf, size_t vsiz, int64_t max,
+                    StringVector* keys) {
+    kc::ScopedSpinRWLock lock(&ilock_, false);
+    SecondaryIndex* index = find_index(name);
+    if (!index) {
+      set_error(_KCCODELINE_, Error::NOREC, "no such index");
+      return false;
+    }
+    if (index->deferring()) {
+      set_error(_KCCODELINE_, Error::LOGIC, "the index is being built");
+      return false;
+    }
+    if (!index->lookup(vbuf, vsiz, max, keys)) {
+      Error e = index->db()->error();
+      set_error(_KCCODELINE_, e.code(), e.message());
+      return false;
+    }
+    return true;
+  }
+  static Visitor* reveal_visitor(Visitor* visitor) {
+    WatchVisitor* watcher = dynamic_cast<WatchVisitor*>(visitor);
+    return watcher ? watcher->visitor() : visitor;
+  }
+ private:
+  /** The number of slots of the lock ordering emitted changes. */
+  static const size_t ORDERSLOTNUM = 64;
+  /**
+   * Change to be emitted into the change ring and the update log.
+   */
+  struct Change {
+    ChangeRing::Type type;
+    std::string key;
+    std::string value;
+  };
+  typedef std::vector<Change> ChangeList;
+  /**
+   * Scoped lock to emit the changes of the same records in the order they are stored.  It
+   * locks nothing unless changes are emitted.
+   */
+  class ScopedOrder {
+   public:
+    explicit ScopedOrder(SoftDB* db, const char* kbuf, size_t ksiz) :
+        db_(db), slots_(), all_(false) {
+      if (!db_->logging()) return;
+      slots_.push_back(kc::hashmurmur(kbuf, ksiz) % ORDERSLOTNUM);
+      db_->olock_.lock(slots_.front());
+    }
+    explicit ScopedOrder(SoftDB* db, const std::vector<std::string>& keys) :
+        db_(db), slots_(), all_(false) {
+      if (!db_->logging()) return;
+      std::vector<std::string>::const_iterator it = keys.begin();
+      std::vector<std::string>::const_iterator itend = keys.end();
+      while (it != itend) {
+        slots_.push_back(kc::hashmurmur(it->data(), it->size()) % ORDERSLOTNUM);
+        ++it;
+      }
+      std::sort(slots_.begin(), slots_.end());
+      slots_.erase(std::unique(slots_.begin(), slots_.end()), slots_.end());
+      for (size_t i = 0; i < slots_.size(); i++) {
+        db_->olock_.lock(slots_[i]);
+      }
+    }
+    explicit ScopedOrder(SoftDB* db) : db_(db), slots_(), all_(false) {
+      if (!db_->logging()) return;
+      db_->olock_.lock_all();
+      all_ = true;
+    }
+    ~ScopedOrder() {
+      if (all_) db_->olock_.unlock_all();
+      for (size_t i = slots_.size(); i > 0; i--) {
+        db_->olock_.unlock(slots_[i-1]);
+      }
+    }
+   private:
+    SoftDB* db_;
+    std::vector<size_t> slots_;
+    bool all_;
+  };
+  /**
+   * Scoped marker of a reading operation.
+   */
+  class ScopedRead {
+   public:
+    explicit ScopedRead(WriteThrottle* throttle) :
+        throttle_(throttle), counted_(throttle->begin_read()) {}
+    ~ScopedRead() {
+      if (counted_) throttle_->end_read();
+    }
+   private:
+    WriteThrottle* throttle_;
+    bool counted_;
+  };
+  /**
+   * Wrapper of a visitor to watch updated records.
+   */
+  class WatchVisitor : public Visitor {
+   public:
+    explicit WatchVisitor(SoftDB* db, Visitor* visitor) :
+        db_(db), visitor_(visitor), created_(), changes_() {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      const char* rv = visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+      if (rv == REMOVE) {
+        db_->notify(kbuf, ksiz, NULL, 0, vbuf, vsiz);
+        capture(ChangeRing::TREMOVE, kbuf, ksiz, NULL, 0);
+      } else if (rv != NOP) {
+        db_->notify(kbuf, ksiz, rv, *sp, vbuf, vsiz);
+        capture(ChangeRing::TSET, kbuf, ksiz, rv, *sp);
+      }
+      return rv;
+    }
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      const char* rv = visitor_->visit_empty(kbuf, ksiz, sp);
+      if (rv != NOP && rv != REMOVE) {
+        db_->notify(kbuf, ksiz, rv, *sp, NULL, 0);
+        capture(ChangeRing::TSET, kbuf, ksiz, rv, *sp);
+        if (db_->kfilter_.enabled()) created_.push_back(std::string(kbuf, ksiz));
+      }
+      return rv;
+    }
+    void visit_before() {
+      visitor_->visit_before();
+    }
+    void visit_after() {
+      visitor_->visit_after();
+    }
+    Visitor* visitor() {
+      return visitor_;
+    }
+    /**
+     * Add created keys to the key filter and emit the captured changes after the operation.
+     */
+    void publish(bool ok) {
+      StringVector::iterator it = created_.begin();
+      StringVector::iterator itend = created_.end();
+      while (it != itend) {
+        db_->kfilter_.add(it->data(), it->size());
+        ++it;
+      }
+      if (ok && !changes_.empty()) db_->emit(&changes_);
+    }
+   private:
+    void capture(ChangeRing::Type type, const char* kbuf, size_t ksiz,
+                 const char* vbuf, size_t vsiz) {
+      if (!db_->logging()) return;
+      changes_.push_back(Change());
+      Change& change = changes_.back();
+      change.type = type;
+      change.key.assign(kbuf, ksiz);
+      if (vbuf) change.value.assign(vbuf, vsiz);
+    }
+    SoftDB* db_;
+    Visitor* visitor_;
+    StringVector created_;
+    ChangeList changes_;
+  };
+  /**
+   * Visitor to capture the value for the front cache.
+   */
+  class FillVisitor : public Visitor {
+   public:
+    explicit FillVisitor(Visitor* visitor, std::string* value) :
+        visitor_(visitor), value_(value), hit_(false) {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      value_->assign(vbuf, vsiz);
+      hit_ = true;
+      return visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+    }
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      return visitor_->visit_empty(kbuf, ksiz, sp);
+    }
+    bool hit() {
+      return hit_;
+    }
+   private:
+    Visitor* visitor_;
+    std::string* value_;
+    bool hit_;
+  };
+  /**
+   * Visitor to build a secondary index from the existing records.
+   */
+  class IndexBuilder : public Visitor {
+   public:
+    explicit IndexBuilder(SecondaryIndex* index) : index_(index) {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      index_->apply(kbuf, ksiz, NULL, 0, vbuf, vsiz);
+      return NOP;
+    }
+   private:
+    SecondaryIndex* index_;
+  };
+  /**
+   * Cursor to watch updated records.
+   */
+  class WatchCursor : public Cursor {
+   public:
+    explicit WatchCursor(SoftDB* db) : Cursor(db), db_(db) {}
+    bool accept(Visitor* visitor, bool writable = true, bool step = false) {
+      if (!writable) return Cursor::accept(visitor, false, step);
+      db_->throttle_.admit();
+      ScopedOrder order(db_);
+      WatchVisitor watcher(db_, visitor);
+      bool rv = Cursor::accept(&watcher, true, step);
+      watcher.publish(rv);
+      return rv;
+    }
+   private:
+    SoftDB* db_;
+  };
+  /**
+   * Notify an updated record.  A null value buffer means removal, and a null key buffer means
+   * clearing the whole database.  The old value buffer is null if the record did not exist.
+   */
+  void notify(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz,
+              const char* obuf, size_t osiz) {
+    touched_ = true;
+    bsync_.note(ksiz + vsiz);
+    throttle_.charge(ksiz + vsiz);
+    update_indices(kbuf, ksiz, vbuf, vsiz, obuf, osiz);
+    if (fcache_.enabled()) {
+      if (kbuf) {
+        fcache_.invalidate(kbuf, ksiz);
+      } else {
+        fcache_.clear();
+      }
+    }
+    if (kfilter_.enabled()) {
+      if (!kbuf) {
+        if (tran_) {
+          kcleared_ = true;
+        } else {
+          kfilter_.clear();
+        }
+      } else if (!vbuf) {
+        kfilter_.remove();
+      }
+    }
+  }
+  bool logging() {
+    return cdc_ || ulog_;
+  }
+  /**
+   * Emit stored changes into the change ring and the update log.  Changes during a transaction
+   * are held until it is committed, since kc rolls back the updates by every thread on abort.
+   */
+  void emit(ChangeList* changes) {
+    if (tran_) {
+      kc::ScopedMutex lock(&tlock_);
+      pending_.insert(pending_.end(), changes->begin(), changes->end());
+      changes->clear();
+      return;
+    }
+    ChangeList::iterator it = changes->begin();
+    ChangeList::iterator itend = changes->end();
+    while (it != itend) {
+      const char* kbuf = it->type == ChangeRing::TCLEAR ? NULL : it->key.data();
+      const char* vbuf = it->type == ChangeRing::TSET ? it->value.data() : NULL;
+      if (cdc_) cdc_->push(it->type, kbuf, it->key.size(), vbuf, it->value.size());
+      if (ulog_) ulog_->write(it->type, kbuf, it->key.size(), vbuf, it->value.size());
+      ++it;
+    }
+    changes->clear();
+  }
+  void update_indices(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz,
+                      const char* obuf, size_t osiz) {
+    kc::ScopedSpinRWLock lock(&ilock_, false);
+    std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+    std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+    while (it != itend) {
+      SecondaryIndex* index = *it;
+      if (kbuf) {
+        index->update(kbuf, ksiz, obuf, osiz, vbuf, vsiz);
+      } else {
+        index->clear();
+      }
+      ++it;
+    }
+  }
+  SecondaryIndex* find_index(const std::string& name) {
+    std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+    std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+    while (it != itend) {
+      if ((*it)->name() == name) return *it;
+      ++it;
+    }
+    return NULL;
+  }
+  /**
+   * Close the secondary indices, stamping them with the final state of the database if it is
+   * known.
+   */
+  bool close_indices(int64_t count, int64_t size, int64_t mtime) {
+    kc::ScopedSpinRWLock lock(&ilock_, true);
+    bool err = false;
+    std::vector<SecondaryIndex*>::iterator it = indices_.begin();
+    std::vector<SecondaryIndex*>::iterator itend = indices_.end();
+    while (it != itend) {
+      SecondaryIndex* index = *it;
+      if (count >= 0 && size >= 0 && mtime >= 0 && !index->deferring() &&
+          !index->stamp(count, size, mtime)) err = true;
+      if (!index->db()->close()) err = true;
+      delete index;
+      ++it;
+    }
+    indices_.clear();
+    return !err;
+  }
+  GroupCommitter gcom_;
+  BackgroundSynchronizer bsync_;
+  WriteThrottle throttle_;
+  ChangeRing* cdc_;
+  UpdateLog* ulog_;
+  kc::SlottedMutex olock_;
+  kc::Mutex tlock_;
+  bool tran_;
+  ChangeList pending_;
+  kc::SpinRWLock ilock_;
+  std::vector<SecondaryIndex*> indices_;
+  KeyFilter kfilter_;
+  bool kcleared_;
+  FrontCache fcache_;
+  bool opened_;
+  int64_t omtime_;
+  bool touched_;
+};
+
+
+/**
+ * Wrapper of a visitor.
+ */
+class SoftVisitor : public kc::PolyDB::Visitor {
+ public:
+  explicit SoftVisitor(JNIEnv* env, jobject jvisitor, bool writable) :
+      env_(env), jvisitor_(jvisitor), writable_(writable),
+      cls_vis_(0), id_vis_visit_full_(0), id_vis_visit_empty_(0),
+      jrv_(NULL), rv_(NULL), jex_(NULL) {
+    cls_vis_ = env->GetObjectClass(jvisitor_);
+    id_vis_visit_full_ = env->GetMethodID(cls_vis_, "visit_full", "([B[B)[B");
+    id_vis_visit_empty_ = env->GetMethodID(cls_vis_, "visit_empty", "([B)[B");
+  }
+  ~SoftVisitor() {
+    cleanup();
+  }
+  jthrowable exception() {
+    return jex_;
+  }
+ private:
+  const char* visit_full(const char* kbuf, size_t ksiz,
+                         const char* vbuf, size_t vsiz, size_t* sp) {
+    cleanup();
+    jbyteArray jkey = newarray(env_, kbuf, ksiz);
+    jbyteArray jvalue = newarray(env_, vbuf, vsiz);
+    jbyteArray jrv = (jbyteArray)env_->CallObjectMethod(jvisitor_, id_vis_visit_full_,
+                                                        jkey, jvalue);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    env_->DeleteLocalRef(jkey);
+    env_->DeleteLocalRef(jvalue);
+    if (!jrv) return NOP;
+    if (env_->IsSameObject(jrv, obj_vis_nop)) {
+      env_->DeleteLocalRef(jrv);
+      return NOP;
+    }
+    if (!writable_) {
+      env_->DeleteLocalRef(jrv);
+      throwruntime(env_, "confliction with the read-only parameter");
+      jex = env_->ExceptionOccurred();
+      if (jex) {
+        if (jex_) env_->DeleteLocalRef(jex_);
+        jex_ = jex;
+        env_->ExceptionClear();
+      }
+      return NOP;
+    }
+    if (env_->IsSameObject(jrv, obj_vis_remove)) {
+      env_->DeleteLocalRef(jrv);
+      return REMOVE;
+    }
+    jrv_ = jrv;
+    rv_ = new SoftArray(env_, jrv);
+    *sp = rv_->size();
+    return rv_->ptr();
+  }
+  const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+    cleanup();
+    jbyteArray jkey = newarray(env_, kbuf, ksiz);
+    jbyteArray jrv = (jbyteArray)env_->CallObjectMethod(jvisitor_, id_vis_visit_empty_, jkey);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    env_->DeleteLocalRef(jkey);
+    if (!jrv) return NOP;
+    if (env_->IsSameObject(jrv, obj_vis_nop)) {
+      env_->DeleteLocalRef(jrv);
+      return NOP;
+    }
+    if (!writable_) {
+      env_->DeleteLocalRef(jrv);
+      throwruntime(env_, "confliction with the read-only parameter");
+      jex = env_->ExceptionOccurred();
+      if (jex) {
+        if (jex_) env_->DeleteLocalRef(jex_);
+        jex_ = jex;
+        env_->ExceptionClear();
+      }
+      return NOP;
+    }
+    if (env_->IsSameObject(jrv, obj_vis_remove)) {
+      env_->DeleteLocalRef(jrv);
+      return REMOVE;
+    }
+    jrv_ = jrv;
+    rv_ = new SoftArray(env_, jrv);
+    *sp = rv_->size();
+    return rv_->ptr();
+  }
+  void cleanup() {
+    delete rv_;
+    rv_ = NULL;
+    if (jrv_) {
+      env_->DeleteLocalRef(jrv_);
+      jrv_ = NULL;
+    }
+  }
+  JNIEnv* env_;
+  jobject jvisitor_;
+  bool writable_;
+  jclass cls_vis_;
+  jmethodID id_vis_visit_full_;
+  jmethodID id_vis_visit_empty_;
+  jbyteArray jrv_;
+  SoftArray* rv_;
+  jthrowable jex_;
+};
+
+
+/**
+ * Wrapper of a file processor.
+ */
+class SoftFileProcessor : public kc::PolyDB::FileProcessor {
+ public:
+  explicit SoftFileProcessor(JNIEnv* env, jobject jproc) :
+      env_(env), jproc_(jproc), cls_fproc_(0), id_fproc_process_(0), jex_(NULL) {
+    cls_fproc_ = env->GetObjectClass(jproc_);
+    id_fproc_process_ = env->GetMethodID(cls_fproc_, "process", "(" L_STR "JJ)Z");
+  }
+  jthrowable exception() {
+    return jex_;
+  }
+ private:
+  bool process(const std::string& path, int64_t count, int64_t size) {
+    jstring jpath = newstring(env_, path.c_str());
+    bool rv = env_->CallBooleanMethod(jproc_, id_fproc_process_, jpath, count, size);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    env_->DeleteLocalRef(jpath);
+    return rv;
+  }
+  JNIEnv* env_;
+  jobject jproc_;
+  jclass cls_fproc_;
+  jmethodID id_fproc_process_;
+  jthrowable jex_;
+};
+
+
+/**
+ * Wrapper of a progress checker.
+ */
+class SoftProgressChecker : public kc::PolyDB::ProgressChecker {
+ public:
+  explicit SoftProgressChecker(JNIEnv* env, jobject jchecker) :
+      env_(env), jchecker_(jchecker), cls_chk_(0), id_chk_check_(0), jex_(NULL) {
+    cls_chk_ = env->GetObjectClass(jchecker_);
+    id_chk_check_ = env->GetMethodID(cls_chk_, "check", "(" L_STR L_STR "JJ)Z");
+  }
+  jthrowable exception() {
+    return jex_;
+  }
+ private:
+  bool check(const char* name, const char* message, int64_t curcnt, int64_t allcnt) {
+    if (jex_) return false;
+    jstring jname = newstring(env_, name);
+    jstring jmessage = newstring(env_, message);
+    bool rv = env_->CallBooleanMethod(jchecker_, id_chk_check_, jname, jmessage, curcnt, allcnt);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      jex_ = jex;
+      env_->ExceptionClear();
+      rv = false;
+    }
+    env_->DeleteLocalRef(jmessage);
+    env_->DeleteLocalRef(jname);
+    return rv;
+  }
+  JNIEnv* env_;
+  jobject jchecker_;
+  jclass cls_chk_;
+  jmethodID id_chk_check_;
+  jthrowable jex_;
+};
+
+
+/**
+ * Visitor to merge operands into the values by a native operator.
+ */
+class MergeVisitor : public kc::PolyDB::Visitor {
+ public:
+  /** The operator to add 64-bit integers. */
+  static const int32_t VADDINT = 0;
+  /** The operator to add double-precision floating-point numbers. */
+  static const int32_t VADDDBL = 1;
+  /** The operator to keep the lexically greatest value. */
+  static const int32_t VMAX = 2;
+  /** The operator to keep the lexically least value. */
+  static const int32_t VMIN = 3;
+  /** The operator to keep the greatest 64-bit integer. */
+  static const int32_t VMAXINT = 4;
+  /** The operator to keep the least 64-bit integer. */
+  static const int32_t VMININT = 5;
+  /** The operator to perform bitwise-or. */
+  static const int32_t VOR = 6;
+  /** The operator to unite sorted lists of unique elements. */
+  static const int32_t VUNION = 7;
+  explicit MergeVisitor(int32_t op, int64_t limit) :
+      op_(op), limit_(limit), operands_(), result_(), num_(0), failed_(false) {}
+  static bool valid(int32_t op) {
+    return op >= VADDINT && op <= VUNION;
+  }
+  /**
+   * Check whether every pushed operand is of the size the operator needs.
+   */
+  bool valid() {
+    if (!numeric()) return true;
+    OperandMap::iterator it = operands_.begin();
+    OperandMap::iterator itend = operands_.end();
+    while (it != itend) {
+      std::deque<std::string>::iterator oit = it->second.begin();
+      std::deque<std::string>::iterator oitend = it->second.end();
+      while (oit != oitend) {
+        if (oit->size() != NUMSIZ) return false;
+        ++oit;
+      }
+      ++it;
+    }
+    return true;
+  }
+  void push(const char* kbuf, size_t ksiz, const char* obuf, size_t osiz) {
+    operands_[std::string(kbuf, ksiz)].push_back(std::string(obuf, osiz));
+  }
+  int64_t num() {
+    return num_;
+  }
+  bool failed() {
+    return failed_;
+  }
+ private:
+  /** The size of a numeric value. */
+  static const size_t NUMSIZ = sizeof(int64_t);
+  typedef std::map<std::string, std::deque<std::string> > OperandMap;
+  const char* visit_full(const char* kbuf, size_t ksiz,
+                         const char* vbuf, size_t vsiz, size_t* sp) {
+    std::string operand;
+    if (!next(kbuf, ksiz, &operand)) return NOP;
+    const char* rv = merge(vbuf, vsiz, operand);
+    if (rv == NOP) return NOP;
+    *sp = result_.size();
+    return rv;
+  }
+  const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+    std::string operand;
+    if (!next(kbuf, ksiz, &operand)) return NOP;
+    if (numeric() && operand.size() != NUMSIZ) {
+      failed_ = true;
+      return NOP;
+    }
+    result_.clear();
+    if (op_ == VUNION) {
+      unite(NULL, 0, operand);
+    } else {
+      result_.swap(operand);
+    }
+    *sp = result_.size();
+    return result_.data();
+  }
+  bool numeric() {
+    return op_ == VADDINT || op_ == VADDDBL || op_ == VMAXINT || op_ == VMININT;
+  }
+  bool next(const char* kbuf, size_t ksiz, std::string* operand) {
+    if (failed_) return false;
+    OperandMap::iterator it = operands_.find(std::string(kbuf, ksiz));
+    if (it == operands_.end() || it->second.empty()) return false;
+    operand->swap(it->second.front());
+    it->second.pop_front();
+    num_++;
+    return true;
+  }
+  const char* merge(const char* vbuf, size_t vsiz, const std::string& operand) {
+    result_.clear();
+    switch (op_) {
+      case VADDINT:
+      case VADDDBL:
+      case VMAXINT:
+      case VMININT: {
+        if (vsiz != NUMSIZ || operand.size() != NUMSIZ) {
+          failed_ = true;
+          return NOP;
+        }
+        int64_t onum = (int64_t)kc::readfixnum(vbuf, NUMSIZ);
+        int64_t anum = (int64_t)kc::readfixnum(operand.data(), NUMSIZ);
+        int64_t rnum;
+        if (op_ == VADDINT) {
+          rnum = (int64_t)((uint64_t)onum + (uint64_t)anum);
+        } else if (op_ == VADDDBL) {
+          double odbl, adbl;
+          std::memcpy(&odbl, &onum, sizeof(odbl));
+          std::memcpy(&adbl, &anum, sizeof(adbl));
+          double rdbl = odbl + adbl;
+          std::memcpy(&rnum, &rdbl, sizeof(rnum));
+        } else if (op_ == VMAXINT ? anum > onum : anum < onum) {
+          rnum = anum;
+        } else {
+          return NOP;
+        }
+        char nbuf[NUMSIZ];
+        kc::writefixnum(nbuf, rnum, NUMSIZ);
+        result_.assign(nbuf, NUMSIZ);
+        break;
+      }
+      case VMAX:
+      case VMIN: {
+        int32_t rv = std::string(vbuf, vsiz).compare(operand);
+        if (op_ == VMAX ? rv >= 0 : rv <= 0) return NOP;
+        result_ = operand;
+        break;
+      }
+      case VOR: {
+        if (operand.size() > vsiz) {
+          result_ = operand;
+        } else {
+          result_.assign(vbuf, vsiz);
+        }
+        const char* sbuf = operand.size() > vsiz ? vbuf : operand.data();
+        size_t ssiz = std::min(vsiz, operand.size());
+        for (size_t i = 0; i < ssiz; i++) {
+          result_[i] |= sbuf[i];
+        }
+        break;
+      }
+      case VUNION: {
+        unite(vbuf, vsiz, operand);
+        if (result_.size() == vsiz && !std::memcmp(result_.data(), vbuf, vsiz)) return NOP;
+        break;
+      }
+      default: {
+        failed_ = true;
+        return NOP;
+      }
+    }
+    return result_.data();
+  }
+  void unite(const char* vbuf, size_t vsiz, const std::string& operand) {
+    std::set<std::string> elems;
+    split(vbuf, vsiz, &elems);
+    split(operand.data(), operand.size(), &elems);
+    while (limit_ > 0 && (int64_t)elems.size() > limit_) {
+      elems.erase(elems.begin());
+    }
+    std::set<std::string>::iterator it = elems.begin();
+    std::set<std::string>::iterator itend = elems.end();
+    while (it != itend) {
+      if (!result_.empty()) result_.append(1, '\n');
+      result_.append(*it);
+      ++it;
+    }
+  }
+  static void split(const char* buf, size_t size, std::set<std::string>* elems) {
+    const char* ep = buf + size;
+    while (buf < ep) {
+      const char* pv = (const char*)std::memchr(buf, '\n', ep - buf);
+      if (!pv) pv = ep;
+      if (pv > buf) elems->insert(std::string(buf, pv - buf));
+      buf = pv + 1;
+    }
+  }
+  int32_t op_;
+  int64_t limit_;
+  OperandMap operands_;
+  std::string result_;
+  int64_t num_;
+  bool failed_;
+};
+
+
+/**
+ * Wrapper of a MapReduce framework.
+ */
+class SoftMapReduce : public kc::MapReduce {
+ public:
+  explicit SoftMapReduce(JNIEnv* env, jobject jmr) :
+      env_(env), jmr_(jmr), cls_mr_(0), id_mr_map_(0), id_mr_reduce_(0),
+      id_mr_preproc_(0), id_mr_midproc_(0), id_mr_postproc_(0),
+      cls_viter_(0), id_viter_init_(0), jex_(NULL) {
+    cls_mr_ = env->GetObjectClass(jmr_);
+    id_mr_map_ = env->GetMethodID(cls_mr_, "map", "([B[B)Z");
+    id_mr_reduce_ = env->GetMethodID(cls_mr_, "reduce", "([B" L_VITER ")Z");
+    id_mr_preproc_ = env->GetMethodID(cls_mr_, "preprocess", "()Z");
+    id_mr_midproc_ = env->GetMethodID(cls_mr_, "midprocess", "()Z");
+    id_mr_postproc_ = env->GetMethodID(cls_mr_, "postprocess", "()Z");
+    cls_viter_ = env->FindClass(P_VITER);
+    id_viter_init_ = env->GetMethodID(cls_viter_, "<init>", "()V");
+    jfieldID id_mr_ptr = env->GetFieldID(cls_mr_, "ptr_", "J");
+    env->SetLongField(jmr_, id_mr_ptr, (intptr_t)this);
+  }
+  jthrowable exception() {
+    return jex_;
+  }
+  bool emit_public(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    return emit(kbuf, ksiz, vbuf, vsiz);
+  }
+ private:
+  bool map(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    jbyteArray jkey = newarray(env_, kbuf, ksiz);
+    jbyteArray jvalue = newarray(env_, vbuf, vsiz);
+    bool rv = env_->CallBooleanMethod(jmr_, id_mr_map_, jkey, jvalue);
+    env_->DeleteLocalRef(jkey);
+    env_->DeleteLocalRef(jvalue);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    return rv;
+  }
+  bool reduce(const char* kbuf, size_t ksiz, ValueIterator* iter) {
+    jbyteArray jkey = newarray(env_, kbuf, ksiz);
+    jobject jviter = env_->NewObject(cls_viter_, id_viter_init_);
+    jfieldID id_viter_ptr = env_->GetFieldID(cls_viter_, "ptr_", "J");
+    env_->SetLongField(jviter, id_viter_ptr, (intptr_t)iter);
+    bool rv = env_->CallBooleanMethod(jmr_, id_mr_reduce_, jkey, jviter);
+    env_->DeleteLocalRef(jviter);
+    env_->DeleteLocalRef(jkey);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    return rv;
+  }
+  bool preprocess() {
+    bool rv = env_->CallBooleanMethod(jmr_, id_mr_preproc_);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    return rv;
+  }
+  bool midprocess() {
+    bool rv = env_->CallBooleanMethod(jmr_, id_mr_midproc_);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    return rv;
+  }
+  bool postprocess() {
+    bool rv = env_->CallBooleanMethod(jmr_, id_mr_postproc_);
+    jthrowable jex = env_->ExceptionOccurred();
+    if (jex) {
+      if (jex_) env_->DeleteLocalRef(jex_);
+      jex_ = jex;
+      env_->ExceptionClear();
+    }
+    return rv;
+  }
+  bool log(const char* name, const char* message) {
+    return true;
+  }
+ private:
+  JNIEnv* env_;
+  jobject jmr_;
+  jclass cls_mr_;
+  jmethodID id_mr_map_;
+  jmethodID id_mr_reduce_;
+  jmethodID id_mr_preproc_;
+  jmethodID id_mr_midproc_;
+  jmethodID id_mr_postproc_;
+  jclass cls_viter_;
+  jmethodID id_viter_init_;
+  jthrowable jex_;
+};
+
+
+/**
+ * Merger to combine records of multiple databases with parallel prefetching.
+ */
+class ParallelMerger {
+ public:
+  explicit ParallelMerger(kc::BasicDB* db, kc::BasicDB** srcary, size_t srcnum,
+                          kc::PolyDB::MergeMode mode, kc::BasicDB::ProgressChecker* checker) :
+      db_(db), srcary_(srcary), srcnum_(srcnum), mode_(mode), checker_(checker) {}
+  bool execute() {
+    int64_t allcnt = 0;
+    for (size_t i = 0; i < srcnum_; i++) {
+      int64_t count = srcary_[i]->count();
+      if (count > 0) allcnt += count;
+    }
+    if (checker_ && !checker_->check("merge", "beginning", 0, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      return false;
+    }
+    std::vector<Prefetcher*> fetchers;
+    fetchers.reserve(srcnum_);
+    for (size_t i = 0; i < srcnum_; i++) {
+      Prefetcher* fetcher = new Prefetcher(srcary_[i]);
+      fetcher->start();
+      fetchers.push_back(fetcher);
+    }
+    std::vector<Source> srcs(srcnum_);
+    LineQueue lines;
+    for (size_t i = 0; i < srcnum_; i++) {
+      Source* src = &srcs[i];
+      src->fetcher = fetchers[i];
+      if (advance(src)) lines.push(Line(&src->batch->at(src->pos).first, i));
+    }
+    bool err = false;
+    int64_t curcnt = 0;
+    while (!lines.empty()) {
+      Line line = lines.top();
+      lines.pop();
+      Source* src = &srcs[line.idx];
+      const Record& rec = src->batch->at(src->pos);
+      if (!apply(rec)) {
+        err = true;
+        break;
+      }
+      curcnt++;
+      if (checker_ && curcnt % CHECKUNIT == 0 &&
+          !checker_->check("merge", "processing", curcnt, allcnt)) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+        err = true;
+        break;
+      }
+      src->pos++;
+      if (advance(src)) lines.push(Line(&src->batch->at(src->pos).first, line.idx));
+    }
+    for (size_t i = 0; i < srcnum_; i++) {
+      Source* src = &srcs[i];
+      Prefetcher* fetcher = src->fetcher;
+      fetcher->stop();
+      fetcher->join();
+      if (!err && fetcher->code() != kc::BasicDB::Error::SUCCESS) {
+        db_->set_error(_KCCODELINE_, fetcher->code(), fetcher->message());
+        err = true;
+      }
+      delete src->batch;
+      delete fetcher;
+    }
+    if (!err && checker_ && !checker_->check("merge", "ending", curcnt, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      err = true;
+    }
+    return !err;
+  }
+ private:
+  /** The number of records between progress checks. */
+  static const int64_t CHECKUNIT = 1024;
+  /** The maximum number of records in a batch. */
+  static const size_t BATCHNUM = 1024;
+  /** The maximum size of records in a batch. */
+  static const size_t BATCHSIZ = 1 << 20;
+  /** The maximum number of batches queued for each source. */
+  static const size_t QUEUEMAX = 4;
+  typedef std::pair<std::string, std::string> Record;
+  typedef std::vector<Record> RecordBatch;
+  /**
+   * Thread to read records of a source database in advance.
+   */
+  class Prefetcher : public kc::Thread {
+   public:
+    explicit Prefetcher(kc::BasicDB* src) :
+        src_(src), mlock_(), cond_(), queue_(), stop_(false), done_(false),
+        code_(kc::BasicDB::Error::SUCCESS), message_() {}
+    ~Prefetcher() {
+      while (!queue_.empty()) {
+        delete queue_.front();
+        queue_.pop_front();
+      }
+    }
+    void run() {
+      kc::BasicDB::Cursor* cur = src_->cursor();
+      bool ok = cur->jump();
+      if (!ok) fail(cur->error());
+      while (ok) {
+        RecordBatch* batch = new RecordBatch;
+        batch->reserve(BATCHNUM);
+        size_t bsiz = 0;
+        while (batch->size() < BATCHNUM && bsiz < BATCHSIZ) {
+          batch->push_back(Record());
+          Record& rec = batch->back();
+          if (!cur->get(&rec.first, &rec.second, true)) {
+            batch->pop_back();
+            fail(cur->error());
+            ok = false;
+            break;
+          }
+          bsiz += rec.first.size() + rec.second.size();
+        }
+        kc::ScopedMutex lock(&mlock_);
+        while (queue_.size() >= QUEUEMAX && !stop_) {
+          cond_.wait(&mlock_);
+        }
+        if (stop_ || batch->empty()) {
+          delete batch;
+          break;
+        }
+        queue_.push_back(batch);
+        cond_.broadcast();
+      }
+      delete cur;
+      kc::ScopedMutex lock(&mlock_);
+      done_ = true;
+      cond_.broadcast();
+    }
+    RecordBatch* pop() {
+      kc::ScopedMutex lock(&mlock_);
+      while (queue_.empty() && !done_) {
+        cond_.wait(&mlock_);
+      }
+      if (queue_.empty()) return NULL;
+      RecordBatch* batch = queue_.front();
+      queue_.pop_front();
+      cond_.broadcast();
+      return batch;
+    }
+    void stop() {
+      kc::ScopedMutex lock(&mlock_);
+      stop_ = true;
+      cond_.broadcast();
+    }
+    kc::BasicDB::Error::Code code() {
+      return code_;
+    }
+    const char* message() {
+      return message_.c_str();
+    }
+   private:
+    void fail(const kc::BasicDB::Error& err) {
+      if (err == kc::BasicDB::Error::NOREC) return;
+      code_ = err.code();
+      message_ = err.message();
+    }
+    kc::BasicDB* src_;
+    kc::Mutex mlock_;
+    kc::CondVar cond_;
+    std::deque<RecordBatch*> queue_;
+    bool stop_;
+    bool done_;
+    kc::BasicDB::Error::Code code_;
+    std::string message_;
+  };
+  /**
+   * Reading state of a source database.
+   */
+  struct Source {
+    Prefetcher* fetcher;
+    RecordBatch* batch;
+    size_t pos;
+    Source() : fetcher(NULL), batch(NULL), pos(0) {}
+  };
+  /**
+   * Head record of a source database.
+   */
+  struct Line {
+    const std::string* key;
+    size_t idx;
+    Line(const std::string* key_, size_t idx_) : key(key_), idx(idx_) {}
+    bool operator <(const Line& right) const {
+      int32_t rv = key->compare(*right.key);
+      if (rv != 0) return rv > 0;
+      return idx > right.idx;
+    }
+  };
+  typedef std::priority_queue<Line> LineQueue;
+  bool advance(Source* src) {
+    if (src->batch && src->pos < src->batch->size()) return true;
+    delete src->batch;
+    src->batch = src->fetcher->pop();
+    src->pos = 0;
+    return src->batch != NULL;
+  }
+  bool apply(const Record& rec) {
+    const std::string& key = rec.first;
+    const std::string& value = rec.second;
+    switch (mode_) {
+      case kc::PolyDB::MSET: {
+        return db_->set(key.data(), key.size(), value.data(), value.size());
+      }
+      case kc::PolyDB::MADD: {
+        if (db_->add(key.data(), key.size(), value.data(), value.size())) return true;
+        return db_->error() == kc::BasicDB::Error::DUPREC;
+      }
+      case kc::PolyDB::MREPLACE: {
+        if (db_->replace(key.data(), key.size(), value.data(), value.size())) return true;
+        return db_->error() == kc::BasicDB::Error::NOREC;
+      }
+      case kc::PolyDB::MAPPEND: {
+        return db_->append(key.data(), key.size(), value.data(), value.size());
+      }
+    }
+    db_->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "invalid merge mode");
+    return false;
+  }
+  kc::BasicDB* db_;
+  kc::BasicDB** srcary_;
+  size_t srcnum_;
+  kc::PolyDB::MergeMode mode_;
+  kc::BasicDB::ProgressChecker* checker_;
+};
+
+
+/**
+ * Loader of unsorted records into an empty tree database with an external sort.
+ */
+class BulkLoader {
+ public:
+  explicit BulkLoader(kc::PolyDB* db, const std::string& src, const std::string& tmpdir,
+                      size_t thnum, kc::BasicDB::ProgressChecker* checker) :
+      db_(db), src_(src), tmpdir_(tmpdir), thnum_(thnum > 0 ? thnum : 1), checker_(checker),
+      paths_(), sorters_(), stime_(0) {}
+  ~BulkLoader() {
+    std::vector<Sorter*>::iterator it = sorters_.begin();
+    std::vector<Sorter*>::iterator itend = sorters_.end();
+    while (it != itend) {
+      (*it)->join();
+      delete *it;
+      ++it;
+    }
+    std::vector<std::string>::iterator pit = paths_.begin();
+    std::vector<std::string>::iterator pitend = paths_.end();
+    while (pit != pitend) {
+      kc::File::remove(*pit);
+      ++pit;
+    }
+  }
+  bool execute() {
+    if (!istree(db_->type())) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::NOIMPL, "not a tree database");
+      return false;
+    }
+    if (db_->count() != 0) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "not an empty database");
+      return false;
+    }
+    std::ifstream ifs;
+    ifs.open(src_.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!ifs) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::NOREPOS, "open failed");
+      return false;
+    }
+    kc::File::Status sbuf;
+    int64_t allsiz = kc::File::status(src_, &sbuf) ? sbuf.size : 0;
+    stime_ = kc::time();
+    if (!check("sorting", 0, allsiz)) return false;
+    if (tmpdir_.empty()) {
+      size_t pos = src_.rfind(kc::File::PATHCHR);
+      tmpdir_ = pos == std::string::npos ? std::string(kc::File::CDIRSTR) : src_.substr(0, pos);
+      if (tmpdir_.empty()) tmpdir_ = kc::File::PATHSTR;
+    }
+    RecordBatch* batch = new RecordBatch;
+    size_t bsiz = 0;
+    int64_t cursiz = 0;
+    int64_t allcnt = 0;
+    std::string line, key, value;
+    while (std::getline(ifs, line)) {
+      cursiz += line.size() + 1;
+      if (!parsetsvline(line.data(), line.size(), &key, &value)) continue;
+      batch->push_back(Record());
+      Record& rec = batch->back();
+      rec.first.swap(key);
+      rec.second.swap(value);
+      bsiz += rec.first.size() + rec.second.size() + sizeof(rec);
+      allcnt++;
+      if (bsiz >= RUNSIZ) {
+        if (!spill(batch)) return false;
+        batch = new RecordBatch;
+        bsiz = 0;
+        if (!check("sorting", cursiz, allsiz)) {
+          delete batch;
+          return false;
+        }
+      }
+    }
+    if (ifs.bad()) {
+      delete batch;
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "read failed");
+      return false;
+    }
+    bool err = false;
+    if (paths_.empty()) {
+      std::stable_sort(batch->begin(), batch->end(), RecordLess());
+      if (!check("loading", 0, allcnt)) err = true;
+      RecordBatch::iterator it = batch->begin();
+      RecordBatch::iterator itend = batch->end();
+      int64_t curcnt = 0;
+      while (!err && it != itend) {
+        if (!db_->set(it->first, it->second)) err = true;
+        curcnt++;
+        if (!err && curcnt % CHECKUNIT == 0 && !check("loading", curcnt, allcnt)) err = true;
+        ++it;
+      }
+      delete batch;
+    } else {
+      if (!spill(batch) || !wait(0) || !merge(allcnt)) err = true;
+    }
+    if (!err && !db_->synchronize(false)) err = true;
+    if (!err && !check("ending", allcnt, allcnt)) err = true;
+    return !err;
+  }
+ private:
+  /** The number of records between progress checks. */
+  static const int64_t CHECKUNIT = 1024;
+  /** The maximum size of records in a sorted run. */
+  static const size_t RUNSIZ = 64 << 20;
+  /** The size of the buffer to read a sorted run. */
+  static const size_t IOBUFSIZ = 1 << 20;
+  typedef std::pair<std::string, std::string> Record;
+  typedef std::vector<Record> RecordBatch;
+  /**
+   * Comparator of records by the key.
+   */
+  struct RecordLess {
+    bool operator ()(const Record& left, const Record& right) const {
+      return left.first < right.first;
+    }
+  };
+  /**
+   * Thread to sort records and write them into a run file.
+   */
+  class Sorter : public kc::Thread {
+   public:
+    explicit Sorter(RecordBatch* batch, const std::string& path) :
+        batch_(batch), path_(path), ok_(false) {}
+    ~Sorter() {
+      delete batch_;
+    }
+    void run() {
+      std::stable_sort(batch_->begin(), batch_->end(), RecordLess());
+      std::ofstream ofs;
+      ofs.open(path_.c_str(), std::ios_base::out | std::ios_base::binary |
+               std::ios_base::trunc);
+      if (!ofs) return;
+      RecordBatch::iterator it = batch_->begin();
+      RecordBatch::iterator itend = batch_->end();
+      while (it != itend) {
+        char hbuf[kc::NUMBUFSIZ];
+        char* wp = hbuf;
+        wp += kc::writevarnum(wp, it->first.size());
+        wp += kc::writevarnum(wp, it->second.size());
+        ofs.write(hbuf, wp - hbuf);
+        ofs.write(it->first.data(), it->first.size());
+        ofs.write(it->second.data(), it->second.size());
+        ++it;
+      }
+      ofs.close();
+      ok_ = !ofs.fail();
+      RecordBatch().swap(*batch_);
+    }
+    bool ok() {
+      return ok_;
+    }
+   private:
+    RecordBatch* batch_;
+    std::string path_;
+    bool ok_;
+  };
+  /**
+   * Reader of a run file.
+   */
+  class RunReader {
+   public:
+    explicit RunReader() : ifs_(), buf_(new char[IOBUFSIZ]), rec_(), ok_(false) {}
+    ~RunReader() {
+      delete[] buf_;
+    }
+    bool open(const std::string& path) {
+      ifs_.rdbuf()->pubsetbuf(buf_, IOBUFSIZ);
+      ifs_.open(path.c_str(), std::ios_base::in | std::ios_base::binary);
+      return ifs_.good();
+    }
+    bool next() {
+      uint64_t ksiz, vsiz;
+      ok_ = readnum(&ksiz) && readnum(&vsiz);
+      if (!ok_) return false;
+      rec_.first.resize(ksiz);
+      rec_.second.resize(vsiz);
+      if (ksiz > 0) ifs_.read(&rec_.first[0], ksiz);
+      if (vsiz > 0) ifs_.read(&rec_.second[0], vsiz);
+      ok_ = !ifs_.fail();
+      return ok_;
+    }
+    bool broken() {
+      return !ifs_.eof() && ifs_.fail();
+    }
+    const Record& record() {
+      return rec_;
+    }
+   private:
+    bool readnum(uint64_t* np) {
+      uint64_t num = 0;
+      int32_t c;
+      do {
+        c = ifs_.get();
+        if (c == EOF) return false;
+        num = (num << 7) + (c & 0x7f);
+      } while (c >= 0x80);
+      *np = num;
+      return true;
+    }
+    std::ifstream ifs_;
+    char* buf_;
+    Record rec_;
+    bool ok_;
+  };
+  /**
+   * Head record of a run file.
+   */
+  struct Line {
+    const std::string* key;
+    size_t idx;
+    Line(const std::string* key_, size_t idx_) : key(key_), idx(idx_) {}
+    bool operator <(const Line& right) const {
+      int32_t rv = key->compare(*right.key);
+      if (rv != 0) return rv > 0;
+      return idx > right.idx;
+    }
+  };
+  typedef std::priority_queue<Line> LineQueue;
+  bool check(const char* phase, int64_t curcnt, int64_t allcnt) {
+    if (!checker_) return true;
+    std::string message = phase;
+    if (curcnt > 0 && allcnt > curcnt) {
+      double elapsed = kc::time() - stime_;
+      kc::strprintf(&message, " (eta=%.1fs)", elapsed * (allcnt - curcnt) / curcnt);
+    }
+    if (checker_->check("bulk_load", message.c_str(), curcnt, allcnt)) return true;
+    db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+    return false;
+  }
+  bool spill(RecordBatch* batch) {
+    if (!wait(thnum_ - 1)) {
+      delete batch;
+      return false;
+    }
+    std::string path = kc::strprintf("%s%ckcjbulk-%lld-%lld.run", tmpdir_.c_str(),
+                                     kc::File::PATHCHR, (long long)kc::getpid(),
+                                     (long long)paths_.size());
+    paths_.push_back(path);
+    Sorter* sorter = new Sorter(batch, path);
+    sorter->start();
+    sorters_.push_back(sorter);
+    return true;
+  }
+  bool wait(size_t max) {
+    bool err = false;
+    while (sorters_.size() > max) {
+      Sorter* sorter = sorters_.front();
+      sorter->join();
+      if (!sorter->ok()) err = true;
+      delete sorter;
+      sorters_.erase(sorters_.begin());
+    }
+    if (err) db_->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "writing a run failed");
+    return !err;
+  }
+  bool merge(int64_t allcnt) {
+    if (!check("loading", 0, allcnt)) return false;
+    size_t rnum = paths_.size();
+    std::vector<RunReader*> readers;
+    readers.reserve(rnum);
+    LineQueue lines;
+    bool err = false;
+    for (size_t i = 0; i < rnum; i++) {
+      RunReader* reader = new RunReader;
+      readers.push_back(reader);
+      if (!reader->open(paths_[i])) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "opening a run failed");
+        err = true;
+      } else if (reader->next()) {
+        lines.push(Line(&reader->record().first, i));
+      }
+    }
+    int64_t curcnt = 0;
+    while (!err && !lines.empty()) {
+      Line line = lines.top();
+      lines.pop();
+      RunReader* reader = readers[line.idx];
+      const Record& rec = reader->record();
+      if (!db_->set(rec.first, rec.second)) {
+        err = true;
+        break;
+      }
+      curcnt++;
+      if (curcnt % CHECKUNIT == 0 && !check("loading", curcnt, allcnt)) {
+        err = true;
+        break;
+      }
+      if (reader->next()) {
+        lines.push(Line(&reader->record().first, line.idx));
+      } else if (reader->broken()) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::BROKEN, "reading a run failed");
+        err = true;
+      }
+    }
+    for (size_t i = 0; i < rnum; i++) {
+      delete readers[i];
+    }
+    return !err;
+  }
+  kc::PolyDB* db_;
+  std::string src_;
+  std::string tmpdir_;
+  size_t thnum_;
+  kc::BasicDB::ProgressChecker* checker_;
+  std::vector<std::string> paths_;
+  std::vector<Sorter*> sorters_;
+  double stime_;
+};
+
+
+/**
+ * Importer of records from a file with parallel parsers.
+ */
+class FileImporter {
+ public:
+  /** The format of tab-separated values. */
+  static const int32_t FTSV = 0;
+  /** The format of length-prefixed binary records. */
+  static const int32_t FBINARY = 1;
+  /** The format of the snapshot. */
+  static const int32_t FSNAPSHOT = 2;
+  explicit FileImporter(kc::PolyDB* db, const std::string& path, int32_t format,
+                        size_t thnum, size_t batchnum, kc::BasicDB::ProgressChecker* checker) :
+      db_(db), path_(path), format_(format), thnum_(thnum > 0 ? thnum : 1),
+      batchnum_(batchnum > 0 ? batchnum : 1), checker_(checker), mlock_(), cond_(), queue_(),
+      done_(false), code_(kc::BasicDB::Error::SUCCESS), message_() {}
+  ~FileImporter() {
+    while (!queue_.empty()) {
+      delete queue_.front();
+      queue_.pop_front();
+    }
+  }
+  bool execute() {
+    if (format_ == FSNAPSHOT) return loadsnapshot(db_, path_, checker_);
+    if (format_ != FTSV && format_ != FBINARY) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "invalid format");
+      return false;
+    }
+    kc::File file;
+    if (!file.open(path_, kc::File::OREADER | kc::File::ONOLOCK, MAPSIZ)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::NOREPOS, file.error());
+      return false;
+    }
+    int64_t allsiz = file.size();
+    if (checker_ && !checker_->check("import_file", "beginning", 0, allsiz)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      file.close();
+      return false;
+    }
+    std::vector<Parser*> parsers;
+    for (size_t i = 0; i < thnum_; i++) {
+      Parser* parser = new Parser(this);
+      parser->start();
+      parsers.push_back(parser);
+    }
+    bool err = false;
+    std::string* chunk = new std::string;
+    int64_t off = 0;
+    while (off < allsiz) {
+      size_t rsiz = std::min((int64_t)CHUNKSIZ, allsiz - off);
+      size_t osiz = chunk->size();
+      chunk->resize(osiz + rsiz);
+      if (!file.read(off, &(*chunk)[osiz], rsiz)) {
+        fail(kc::BasicDB::Error::SYSTEM, file.error());
+        err = true;
+        break;
+      }
+      off += rsiz;
+      size_t csiz = cut(*chunk, off >= allsiz);
+      if (csiz < 1) continue;
+      std::string* rest = new std::string(*chunk, csiz);
+      chunk->resize(csiz);
+      if (!push(chunk)) {
+        delete rest;
+        chunk = NULL;
+        err = true;
+        break;
+      }
+      chunk = rest;
+      if (checker_ && !checker_->check("import_file", "processing", off, allsiz)) {
+        fail(kc::BasicDB::Error::LOGIC, "checker failed");
+        err = true;
+        break;
+      }
+    }
+    if (chunk && !chunk->empty() && !err) {
+      fail(kc::BasicDB::Error::BROKEN, "truncated record");
+      err = true;
+    }
+    delete chunk;
+    mlock_.lock();
+    done_ = true;
+    cond_.broadcast();
+    mlock_.unlock();
+    for (size_t i = 0; i < parsers.size(); i++) {
+      parsers[i]->join();
+      delete parsers[i];
+    }
+    file.close();
+    if (code_ != kc::BasicDB::Error::SUCCESS) {
+      db_->set_error(_KCCODELINE_, code_, message_.c_str());
+      return false;
+    }
+    if (checker_ && !checker_->check("import_file", "ending", allsiz, allsiz)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      return false;
+    }
+    return !err;
+  }
+ private:
+  /** The size of the file region mapped into memory. */
+  static const int64_t MAPSIZ = 1LL << 30;
+  /** The size of each chunk read from the file. */
+  static const int64_t CHUNKSIZ = 8 << 20;
+  /** The size of the binary record header. */
+  static const size_t BINHEADSIZ = 8;
+  /**
+   * Thread to parse chunks and store the records.
+   */
+  class Parser : public kc::Thread {
+   public:
+    explicit Parser(FileImporter* importer) : importer_(importer) {}
+    void run() {
+      importer_->work();
+    }
+   private:
+    FileImporter* importer_;
+  };
+  size_t cut(const std::string& chunk, bool last) {
+    if (format_ == FTSV) {
+      if (last) return chunk.size();
+      size_t pos = chunk.rfind('\n');
+      return pos == std::string::npos ? 0 : pos + 1;
+    }
+    size_t pos = 0;
+    while (pos + BINHEADSIZ <= chunk.size()) {
+      uint64_t ksiz = kc::readfixnum(chunk.data() + pos, 4);
+      uint64_t vsiz = kc::readfixnum(chunk.data() + pos + 4, 4);
+      uint64_t rsiz = BINHEADSIZ + ksiz + vsiz;
+      if (pos + rsiz > chunk.size()) break;
+      pos += rsiz;
+    }
+    return pos;
+  }
+  bool push(std::string* chunk) {
+    kc::ScopedMutex lock(&mlock_);
+    while (queue_.size() >= thnum_ * 2 && code_ == kc::BasicDB::Error::SUCCESS) {
+      cond_.wait(&mlock_);
+    }
+    if (code_ != kc::BasicDB::Error::SUCCESS) {
+      delete chunk;
+      return false;
+    }
+    queue_.push_back(chunk);
+    cond_.broadcast();
+    return true;
+  }
+  std::string* pop() {
+    kc::ScopedMutex lock(&mlock_);
+    while (queue_.empty() && !done_ && code_ == kc::BasicDB::Error::SUCCESS) {
+      cond_.wait(&mlock_);
+    }
+    if (queue_.empty() || code_ != kc::BasicDB::Error::SUCCESS) return NULL;
+    std::string* chunk = queue_.front();
+    queue_.pop_front();
+    cond_.broadcast();
+    return chunk;
+  }
+  void fail(kc::BasicDB::Error::Code code, const char* message) {
+    kc::ScopedMutex lock(&mlock_);
+    if (code_ == kc::BasicDB::Error::SUCCESS) {
+      code_ = code;
+      message_ = message;
+    }
+    cond_.broadcast();
+  }
+  void work() {
+    std::string* chunk;
+    while ((chunk = pop()) != NULL) {
+      bool ok = parse(*chunk);
+      delete chunk;
+      if (!ok) break;
+    }
+  }
+  bool parse(const std::string& chunk) {
+    StringMap recs;
+    const char* rp = chunk.data();
+    const char* ep = rp + chunk.size();
+    std::string key, value;
+    while (rp < ep) {
+      if (format_ == FTSV) {
+        const char* lp = (const char*)std::memchr(rp, '\n', ep - rp);
+        if (!lp) lp = ep;
+        if (parsetsvline(rp, lp - rp, &key, &value)) recs[key] = value;
+        rp = lp + 1;
+      } else {
+        size_t ksiz = kc::readfixnum(rp, 4);
+        size_t vsiz = kc::readfixnum(rp + 4, 4);
+        rp += BINHEADSIZ;
+        key.assign(rp, ksiz);
+        rp += ksiz;
+        recs[key].assign(rp, vsiz);
+        rp += vsiz;
+      }
+      if (recs.size() >= batchnum_ && !store(&recs)) return false;
+    }
+    return store(&recs);
+  }
+  bool store(StringMap* recs) {
+    if (recs->empty()) return true;
+    if (db_->set_bulk(*recs, false) < 0) {
+      kc::BasicDB::Error e = db_->error();
+      fail(e.code(), e.message());
+      return false;
+    }
+    recs->clear();
+    return true;
+  }
+  kc::PolyDB* db_;
+  std::string path_;
+  int32_t format_;
+  size_t thnum_;
+  size_t batchnum_;
+  kc::BasicDB::ProgressChecker* checker_;
+  kc::Mutex mlock_;
+  kc::CondVar cond_;
+  std::deque<std::string*> queue_;
+  bool done_;
+  kc::BasicDB::Error::Code code_;
+  std::string message_;
+};
+
+
+/**
+ * Exporter of records into a file.
+ */
+class FileExporter {
+ public:
+  explicit FileExporter(kc::PolyDB* db, const std::string& path, int32_t format,
+                        const std::string* begin, const std::string* end,
+                        kc::BasicDB::ProgressChecker* checker) :
+      db_(db), path_(path), format_(format), begin_(begin), end_(end), checker_(checker) {}
+  bool execute() {
+    if (format_ == FileImporter::FSNAPSHOT) {
+      if (begin_ || end_) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID,
+                       "range is not supported for snapshots");
+        return false;
+      }
+      return dumpsnapshot(db_, path_, "", checker_);
+    }
+    if (format_ != FileImporter::FTSV && format_ != FileImporter::FBINARY) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "invalid format");
+      return false;
+    }
+    std::ofstream ofs;
+    char* obuf = new char[IOBUFSIZ];
+    ofs.rdbuf()->pubsetbuf(obuf, IOBUFSIZ);
+    ofs.open(path_.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!ofs) {
+      delete[] obuf;
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::NOREPOS, "open failed");
+      return false;
+    }
+    int64_t allcnt = db_->count();
+    bool err = false;
+    if (checker_ && !checker_->check("export_file", "beginning", 0, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      err = true;
+    }
+    bool ordered = istree(db_->type());
+    kc::PolyDB::Cursor* cur = db_->cursor();
+    bool ok = !err && (ordered && begin_ ? cur->jump(*begin_) : cur->jump());
+    if (!ok && !err && cur->error() != kc::BasicDB::Error::NOREC) {
+      db_->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+      err = true;
+    }
+    int64_t curcnt = 0;
+    std::string key, value, line;
+    while (ok && !err) {
+      if (!cur->get(&key, &value, true)) {
+        if (cur->error() != kc::BasicDB::Error::NOREC) {
+          db_->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+          err = true;
+        }
+        break;
+      }
+      curcnt++;
+      if (checker_ && curcnt % CHECKUNIT == 0 &&
+          !checker_->check("export_file", "processing", curcnt, allcnt)) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+        err = true;
+        break;
+      }
+      if (end_ && key.compare(*end_) >= 0) {
+        if (ordered) break;
+        continue;
+      }
+      if (begin_ && key.compare(*begin_) < 0) continue;
+      if (format_ == FileImporter::FTSV) {
+        line.clear();
+        escapetsv(key.data(), key.size(), &line);
+        line.append(1, '\t');
+        escapetsv(value.data(), value.size(), &line);
+        line.append(1, '\n');
+        ofs.write(line.data(), line.size());
+      } else {
+        char hbuf[8];
+        kc::writefixnum(hbuf, key.size(), 4);
+        kc::writefixnum(hbuf + 4, value.size(), 4);
+        ofs.write(hbuf, sizeof(hbuf));
+        ofs.write(key.data(), key.size());
+        ofs.write(value.data(), value.size());
+      }
+    }
+    delete cur;
+    ofs.close();
+    delete[] obuf;
+    if (!err && ofs.fail()) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "write failed");
+      err = true;
+    }
+    if (!err && checker_ && !checker_->check("export_file", "ending", curcnt, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      err = true;
+    }
+    return !err;
+  }
+ private:
+  /** The number of records between progress checks. */
+  static const int64_t CHECKUNIT = 1024;
+  /** The size of the output buffer. */
+  static const size_t IOBUFSIZ = 1 << 20;
+  kc::PolyDB* db_;
+  std::string path_;
+  int32_t format_;
+  const std::string* begin_;
+  const std::string* end_;
+  kc::BasicDB::ProgressChecker* checker_;
+};
+
+
+/**
+ * Visitor to transform the values of records natively.
+ */
+class TransformVisitor : public kc::PolyDB::Visitor {
+ public:
+  /** The transformation to overwrite the bytes at a position. */
+  static const int32_t TSET = 0;
+  /** The transformation to append bytes. */
+  static const int32_t TAPPEND = 1;
+  /** The transformation to prepend bytes. */
+  static const int32_t TPREPEND = 2;
+  /** The transformation to replace a delimiter-separated field. */
+  static const int32_t TFIELD = 3;
+  /** The transformation to remove the record. */
+  static const int32_t TREMOVE = 4;
+  /** The transformation to add a number to a 64-bit big-endian integer at a position. */
+  static const int32_t TINCINT = 5;
+  explicit TransformVisitor(int32_t op, int64_t pos, int64_t num, const std::string& data) :
+      op_(op), pos_(pos), num_(num), data_(data), begin_(NULL), end_(NULL), result_(),
+      count_(0), removed_(false) {}
+  static bool valid(int32_t op) {
+    return op >= TSET && op <= TINCINT;
+  }
+  bool grows() {
+    return op_ == TSET || op_ == TAPPEND || op_ == TPREPEND || op_ == TFIELD;
+  }
+  void limit(const std::string* begin, const std::string* end) {
+    begin_ = begin;
+    end_ = end;
+  }
+  int64_t count() {
+    return count_;
+  }
+  bool removed() {
+    return removed_;
+  }
+ private:
+  /** The size of a numeric value. */
+  static const size_t NUMSIZ = sizeof(int64_t);
+  const char* visit_full(const char* kbuf, size_t ksiz,
+                         const char* vbuf, size_t vsiz, size_t* sp) {
+    removed_ = false;
+    if ((begin_ && std::string(kbuf, ksiz).compare(*begin_) < 0) ||
+        (end_ && std::string(kbuf, ksiz).compare(*end_) >= 0)) return NOP;
+    const char* rv = transform(vbuf, vsiz);
+    if (rv == NOP) return NOP;
+    count_++;
+    if (rv == REMOVE) {
+      removed_ = true;
+      return REMOVE;
+    }
+    *sp = result_.size();
+    return rv;
+  }
+  const char* transform(const char* vbuf, size_t vsiz) {
+    if (pos_ < 0 || pos_ > (int64_t)kc::MEMMAXSIZ) return NOP;
+    size_t pos = pos_;
+    result_.clear();
+    switch (op_) {
+      case TSET: {
+        result_.assign(vbuf, vsiz);
+        if (pos + data_.size() > vsiz) result_.resize(pos + data_.size(), '\0');
+        result_.replace(pos, data_.size(), data_);
+        break;
+      }
+      case TAPPEND: {
+        result_.append(vbuf, vsiz);
+        result_.append(data_);
+        break;
+      }
+      case TPREPEND: {
+        result_.append(data_);
+        result_.append(vbuf, vsiz);
+        break;
+      }
+      case TFIELD: {
+        const char* ep = vbuf + vsiz;
+        const char* rp = vbuf;
+        for (size_t i = 0; i < pos; i++) {
+          rp = (const char*)std::memchr(rp, (char)num_, ep - rp);
+          if (!rp) return NOP;
+          rp++;
+        }
+        const char* fp = (const char*)std::memchr(rp, (char)num_, ep - rp);
+        if (!fp) fp = ep;
+        result_.append(vbuf, rp - vbuf);
+        result_.append(data_);
+        result_.append(fp, ep - fp);
+        break;
+      }
+      case TREMOVE: {
+        return REMOVE;
+      }
+      case TINCINT: {
+        if (pos + NUMSIZ > vsiz) return NOP;
+        int64_t onum = (int64_t)kc::readfixnum(vbuf + pos, NUMSIZ);
+        result_.assign(vbuf, vsiz);
+        kc::writefixnum(&result_[pos], (uint64_t)onum + (uint64_t)num_, NUMSIZ);
+        break;
+      }
+      default: {
+        return NOP;
+      }
+    }
+    if (result_.size() == vsiz && !std::memcmp(result_.data(), vbuf, vsiz)) return NOP;
+    return result_.data();
+  }
+  int32_t op_;
+  int64_t pos_;
+  int64_t num_;
+  std::string data_;
+  const std::string* begin_;
+  const std::string* end_;
+  std::string result_;
+  int64_t count_;
+  bool removed_;
+};
+
+
+/**
+ * Updater of the records in a key range by a cursor committing in bounded chunks.  Tree
+ * databases are walked only through the range.  The others are walked entirely, or iterated
+ * at once when the values may grow, since a grown record may be moved ahead of the cursor.
+ */
+class RangeUpdater {
+ public:
+  explicit RangeUpdater(kc::PolyDB* db, const std::string* begin, const std::string* end,
+                        TransformVisitor* visitor, int64_t unit, double pause,
+                        kc::BasicDB::ProgressChecker* checker) :
+      db_(db), begin_(begin), end_(end), visitor_(visitor), unit_(unit), pause_(pause),
+      checker_(checker) {}
+  bool execute() {
+    visitor_->limit(begin_, end_);
+    bool ordered = istree(db_->type());
+    if (!ordered && visitor_->grows()) return db_->iterate(visitor_, true, checker_);
+    int64_t allcnt = db_->count();
+    bool err = false;
+    if (checker_ && !checker_->check("update_where", "beginning", 0, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      err = true;
+    }
+    kc::PolyDB::Cursor* cur = db_->cursor();
+    bool ok = !err && (ordered && begin_ ? cur->jump(*begin_) : cur->jump());
+    if (!ok && !err && cur->error() != kc::BasicDB::Error::NOREC) {
+      db_->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+      err = true;
+    }
+    if (ok && unit_ > 0 && !db_->begin_transaction()) {
+      ok = false;
+      err = true;
+    }
+    int64_t curcnt = 0;
+    int64_t chunk = 0;
+    std::string key;
+    while (ok && !err) {
+      if (!cur->get_key(&key, false)) {
+        if (cur->error() != kc::BasicDB::Error::NOREC) {
+          db_->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+          err = true;
+        }
+        break;
+      }
+      if (ordered && end_ && key.compare(*end_) >= 0) break;
+      curcnt++;
+      if (checker_ && curcnt % CHECKUNIT == 0 &&
+          !checker_->check("update_where", "processing", curcnt, allcnt)) {
+        db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+        err = true;
+        break;
+      }
+      int64_t ocount = visitor_->count();
+      if (!cur->accept(visitor_, true, false) || (!visitor_->removed() && !cur->step())) {
+        if (cur->error() != kc::BasicDB::Error::NOREC) {
+          db_->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+          err = true;
+        }
+        break;
+      }
+      if (unit_ > 0 && visitor_->count() > ocount && ++chunk >= unit_) {
+        chunk = 0;
+        if (!db_->end_transaction(true)) {
+          ok = false;
+          err = true;
+          break;
+        }
+        if (pause_ > 0) kc::Thread::sleep(pause_);
+        if (!db_->begin_transaction()) {
+          ok = false;
+          err = true;
+        }
+      }
+    }
+    if (ok && unit_ > 0 && !endbulk(db_, !err)) err = true;
+    delete cur;
+    if (!err && checker_ && !checker_->check("update_where", "ending", curcnt, allcnt)) {
+      db_->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "checker failed");
+      err = true;
+    }
+    return !err;
+  }
+  static bool successor(const std::string& prefix, std::string* dest) {
+    dest->assign(prefix);
+    while (!dest->empty() && (unsigned char)(*dest)[dest->size()-1] == 0xff) {
+      dest->resize(dest->size() - 1);
+    }
+    if (dest->empty()) return false;
+    (*dest)[dest->size()-1]++;
+    return true;
+  }
+ private:
+  /** The number of records between progress checks. */
+  static const int64_t CHECKUNIT = 1024;
+  kc::PolyDB* db_;
+  const std::string* begin_;
+  const std::string* end_;
+  TransformVisitor* visitor_;
+  int64_t unit_;
+  double pause_;
+  kc::BasicDB::ProgressChecker* checker_;
+};
+
+
+/**
+ * Fast compressor of the LZF family, which needs no external library.
+ */
+class FastCompressor : public kc::Compressor {
+ public:
+  char* compress(const void* buf, size_t size, size_t* sp) {
+    const unsigned char* ip = (const unsigned char*)buf;
+    const unsigned char* iend = ip + size;
+    unsigned char* obuf = new unsigned char[sizeof(uint32_t)+size+size/(MAXLIT-1)+2];
+    kc::writefixnum(obuf, size, sizeof(uint32_t));
+    unsigned char* op = obuf + sizeof(uint32_t);
+    std::vector<const unsigned char*> htab(1 << HTABBITS, (const unsigned char*)NULL);
+    size_t lit = 0;
+    unsigned char* litp = op++;
+    while (ip < iend) {
+      if (ip + 2 < iend) {
+        uint32_t hv = ((uint32_t)ip[0] << 16) | ((uint32_t)ip[1] << 8) | ip[2];
+        size_t slot = (uint32_t)(hv * 2654435761U) >> (32 - HTABBITS);
+        const unsigned char* ref = htab[slot];
+        htab[slot] = ip;
+        if (ref && (size_t)(ip - ref) <= MAXOFF &&
+            ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2]) {
+          size_t off = ip - ref - 1;
+          size_t max = iend - ip;
+          if (max > MAXREF) max = MAXREF;
+          size_t len = 3;
+          while (len < max && ref[len] == ip[len]) {
+            len++;
+          }
+          if (lit > 0) {
+            *litp = lit - 1;
+          } else {
+            op--;
+          }
+          size_t code = len - 2;
+          if (code < 7) {
+            *op++ = (off >> 8) + (code << 5);
+          } else {
+            *op++ = (off >> 8) + (7 << 5);
+            *op++ = code - 7;
+          }
+          *op++ = off & 0xff;
+          ip += len;
+          lit = 0;
+          litp = op++;
+          continue;
+        }
+      }
+      *op++ = *ip++;
+      if (++lit >= MAXLIT) {
+        *litp = MAXLIT - 1;
+        lit = 0;
+        litp = op++;
+      }
+    }
+    if (lit > 0) {
+      *litp = lit - 1;
+    } else {
+      op--;
+    }
+    *sp = op - obuf;
+    return (char*)obuf;
+  }
+  char* decompress(const void* buf, size_t size, size_t* sp) {
+    if (size < sizeof(uint32_t)) return NULL;
+    const unsigned char* ip = (const unsigned char*)buf;
+    const unsigned char* iend = ip + size;
+    size_t rsiz = kc::readfixnum(ip, sizeof(uint32_t));
+    ip += sizeof(uint32_t);
+    unsigned char* obuf = new unsigned char[rsiz+1];
+    unsigned char* op = obuf;
+    unsigned char* oend = obuf + rsiz;
+    while (ip < iend) {
+      size_t ctrl = *ip++;
+      if (ctrl < MAXLIT) {
+        size_t len = ctrl + 1;
+        if (ip + len > iend || op + len > oend) break;
+        std::memcpy(op, ip, len);
+        ip += len;
+        op += len;
+        continue;
+      }
+      size_t len = ctrl >> 5;
+      if (len == 7) {
+        if (ip >= iend) break;
+        len += *ip++;
+      }
+      if (ip >= iend) break;
+      size_t off = ((ctrl & 0x1f) << 8) + *ip++ + 1;
+      len += 2;
+      if (off > (size_t)(op - obuf) || op + len > oend) break;
+      const unsigned char* ref = op - off;
+      for (size_t i = 0; i < len; i++) {
+        *op++ = *ref++;
+      }
+    }
+    if (ip != iend || op != oend) {
+      delete[] obuf;
+      return NULL;
+    }
+    *op = '\0';
+    *sp = rsiz;
+    return (char*)obuf;
+  }
+ private:
+  /** The number of bits of the hash table. */
+  static const size_t HTABBITS = 14;
+  /** The maximum length of a literal run. */
+  static const size_t MAXLIT = 32;
+  /** The maximum distance of a back reference. */
+  static const size_t MAXOFF = 1 << 13;
+  /** The maximum length of a back reference. */
+  static const size_t MAXREF = (7 + 255) + 2;
+};
+
+
+/**
+ * Stream buffer to write a snapshot with block compression.
+ */
+class SnapshotWriter : public std::streambuf {
+ public:
+  explicit SnapshotWriter(std::ostream* dest, kc::Compressor* comp) :
+      dest_(dest), comp_(comp), buf_(BLOCKSIZ), wsiz_(0) {
+    setp(&buf_[0], &buf_[0] + buf_.size());
+  }
+  int64_t size() const {
+    return wsiz_ + (pptr() - pbase());
+  }
+  bool finish() {
+    return flush() && dest_->flush().good();
+  }
+ protected:
+  int_type overflow(int_type c) {
+    if (!flush()) return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+  int sync() {
+    return flush() ? 0 : -1;
+  }
+ private:
+  /** The size of each block. */
+  static const size_t BLOCKSIZ = 1 << 20;
+  bool flush() {
+    size_t size = pptr() - pbase();
+    if (size < 1) return true;
+    if (comp_) {
+      size_t zsiz;
+      char* zbuf = comp_->compress(pbase(), size, &zsiz);
+      if (!zbuf) return false;
+      char head[sizeof(uint32_t)*2];
+      kc::writefixnum(head, size, sizeof(uint32_t));
+      kc::writefixnum(head + sizeof(uint32_t), zsiz, sizeof(uint32_t));
+      dest_->write(head, sizeof(head));
+      dest_->write(zbuf, zsiz);
+      delete[] zbuf;
+    } else {
+      dest_->write(pbase(), size);
+    }
+    wsiz_ += size;
+    setp(&buf_[0], &buf_[0] + buf_.size());
+    return dest_->good();
+  }
+  std::ostream* dest_;
+  kc::Compressor* comp_;
+  std::vector<char> buf_;
+  int64_t wsiz_;
+};
+
+
+/**
+ * Stream buffer to read a snapshot with block decompression in a background thread.
+ */
+class SnapshotReader : public std::streambuf {
+ public:
+  explicit SnapshotReader(std::istream* src, kc::Compressor* comp) :
+      src_(src), comp_(comp), inflater_(this), mlock_(), cond_(), queue_(), stop_(false),
+      done_(false), broken_(false), block_(NULL), buf_(), rsiz_(0) {
+    if (comp_) {
+      inflater_.start();
+    } else {
+      buf_.resize(BLOCKSIZ);
+    }
+  }
+  ~SnapshotReader() {
+    if (comp_) {
+      mlock_.lock();
+      stop_ = true;
+      cond_.broadcast();
+      mlock_.unlock();
+      inflater_.join();
+      while (!queue_.empty()) {
+        delete queue_.front();
+        queue_.pop_front();
+      }
+    }
+    delete block_;
+  }
+  int64_t size() const {
+    return rsiz_ - (egptr() - gptr());
+  }
+  bool broken() {
+    kc::ScopedMutex lock(&mlock_);
+    return broken_;
+  }
+ protected:
+  int_type underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (comp_) {
+      delete block_;
+      block_ = NULL;
+      kc::ScopedMutex lock(&mlock_);
+      while (queue_.empty() && !done_) {
+        cond_.wait(&mlock_);
+      }
+      if (queue_.empty()) return traits_type::eof();
+      block_ = queue_.front();
+      queue_.pop_front();
+      cond_.broadcast();
+      char* ptr = (char*)block_->data();
+      setg(ptr, ptr, ptr + block_->size());
+      rsiz_ += block_->size();
+    } else {
+      src_->read(&buf_[0], buf_.size());
+      size_t size = src_->gcount();
+      if (size < 1) return traits_type::eof();
+      setg(&buf_[0], &buf_[0], &buf_[0] + size);
+      rsiz_ += size;
+    }
+    return traits_type::to_int_type(*gptr());
+  }
+ private:
+  /** The size of each block to read uncompressed data. */
+  static const size_t BLOCKSIZ = 1 << 20;
+  /** The maximum number of decompressed blocks in the queue. */
+  static const size_t QUEUEMAX = 4;
+  /**
+   * Thread to decompress blocks in advance.
+   */
+  class Inflater : public kc::Thread {
+   public:
+    explicit Inflater(SnapshotReader* reader) : reader_(reader) {}
+    void run() {
+      reader_->inflate();
+    }
+   private:
+    SnapshotReader* reader_;
+  };
+  void inflate() {
+    bool broken = false;
+    std::vector<char> zbuf;
+    while (true) {
+      char head[sizeof(uint32_t)*2];
+      src_->read(head, sizeof(head));
+      size_t hsiz = src_->gcount();
+      if (hsiz < 1) break;
+      if (hsiz != sizeof(head)) {
+        broken = true;
+        break;
+      }
+      size_t rsiz = kc::readfixnum(head, sizeof(uint32_t));
+      size_t zsiz = kc::readfixnum(head + sizeof(uint32_t), sizeof(uint32_t));
+      zbuf.resize(zsiz + 1);
+      src_->read(&zbuf[0], zsiz);
+      if ((size_t)src_->gcount() != zsiz) {
+        broken = true;
+        break;
+      }
+      size_t size;
+      char* rbuf = comp_->decompress(&zbuf[0], zsiz, &size);
+      if (!rbuf || size != rsiz) {
+        delete[] rbuf;
+        broken = true;
+        break;
+      }
+      std::string* block = new std::string(rbuf, size);
+      delete[] rbuf;
+      kc::ScopedMutex lock(&mlock_);
+      while (queue_.size() >= QUEUEMAX && !stop_) {
+        cond_.wait(&mlock_);
+      }
+      if (stop_) {
+        delete block;
+        break;
+      }
+      queue_.push_back(block);
+      cond_.broadcast();
+    }
+    kc::ScopedMutex lock(&mlock_);
+    broken_ = broken;
+    done_ = true;
+    cond_.broadcast();
+  }
+  std::istream* src_;
+  kc::Compressor* comp_;
+  Inflater inflater_;
+  kc::Mutex mlock_;
+  kc::CondVar cond_;
+  std::deque<std::string*> queue_;
+  bool stop_;
+  bool done_;
+  bool broken_;
+  std::string* block_;
+  std::vector<char> buf_;
+  int64_t rsiz_;
+};
+
+
+/**
+ * Progress checker to report the amount of processed data of a snapshot.
+ */
+class SnapshotChecker : public kc::BasicDB::ProgressChecker {
+ public:
+  explicit SnapshotChecker(kc::BasicDB::ProgressChecker* checker,
+                           SnapshotWriter* writer, SnapshotReader* reader) :
+      checker_(checker), writer_(writer), reader_(reader) {}
+ private:
+  bool check(const char* name, const char* message, int64_t curcnt, int64_t allcnt) {
+    if (!checker_) return true;
+    int64_t size = writer_ ? writer_->size() : reader_ ? reader_->size() : 0;
+    std::string msg = kc::strprintf("%s (%lld bytes)", message, (long long)size);
+    return checker_->check(name, msg.c_str(), curcnt, allcnt);
+  }
+  kc::BasicDB::ProgressChecker* checker_;
+  SnapshotWriter* writer_;
+  SnapshotReader* reader_;
+};
+
+
+/**
+ * Base of databases wrapping other databases.
+ */
+class WrapperDB : public kc::BasicDB {
+ public:
+  explicit WrapperDB() : error_(), omode_(0) {}
+  Error error() const {
+    return error_;
+  }
+  void set_error(const char* file, int32_t line, const char* func,
+                 Error::Code code, const char* message) {
+    error_->set(code, message);
+  }
+ protected:
+  /**
+   * Cursor passing operations through to a cursor of a wrapped database.
+   */
+  class WrapperCursor : public Cursor {
+   public:
+    explicit WrapperCursor(WrapperDB* db, kc::PolyDB::Cursor* cur) : db_(db), cur_(cur) {}
+    virtual ~WrapperCursor() {
+      delete cur_;
+    }
+    bool accept(Visitor* visitor, bool writable = true, bool step = false) {
+      if (!cur_) return invalid();
+      if (!cur_->accept(visitor, writable, step)) return fail();
+      return true;
+    }
+    bool jump() {
+      if (!cur_) return invalid();
+      if (!cur_->jump()) return fail();
+      return true;
+    }
+    bool jump(const char* kbuf, size_t ksiz) {
+      if (!cur_) return invalid();
+      if (!cur_->jump(kbuf, ksiz)) return fail();
+      return true;
+    }
+    bool jump(const std::string& key) {
+      return jump(key.data(), key.size());
+    }
+    bool jump_back() {
+      if (!cur_) return invalid();
+      if (!cur_->jump_back()) return fail();
+      return true;
+    }
+    bool jump_back(const char* kbuf, size_t ksiz) {
+      if (!cur_) return invalid();
+      if (!cur_->jump_back(kbuf, ksiz)) return fail();
+      return true;
+    }
+    bool jump_back(const std::string& key) {
+      return jump_back(key.data(), key.size());
+    }
+    bool step() {
+      if (!cur_) return invalid();
+      if (!cur_->step()) return fail();
+      return true;
+    }
+    bool step_back() {
+      if (!cur_) return invalid();
+      if (!cur_->step_back()) return fail();
+      return true;
+    }
+    WrapperDB* db() {
+      return db_;
+    }
+   protected:
+    bool fail() {
+      return db_->fail(cur_->error());
+    }
+    bool invalid() {
+      db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    WrapperDB* db_;
+    kc::PolyDB::Cursor* cur_;
+  };
+  bool fail(const Error& err) {
+    error_->set(err.code(), err.message());
+    return false;
+  }
+  bool check_open(bool writable) {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (writable && !(omode_ & OWRITER)) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      return false;
+    }
+    return true;
+  }
+  kc::TSD<Error> error_;
+  uint32_t omode_;
+};
+
+
+/**
+ * Base of wrapper databases visiting each record under a slotted record lock.
+ */
+class SlottedDB : public WrapperDB {
+ public:
+  explicit SlottedDB() : slots_(SLOTNUM) {}
+  bool accept(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable = true) {
+    if (!check_open(writable)) return false;
+    size_t idx = kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    slots_.lock(idx);
+    enter(writable);
+    bool rv = accept_impl(kbuf, ksiz, visitor, writable);
+    leave(writable);
+    slots_.unlock(idx);
+    return rv;
+  }
+  bool accept_bulk(const std::vector<std::string>& keys, Visitor* visitor,
+                   bool writable = true) {
+    if (!check_open(writable)) return false;
+    std::set<size_t> lidxs;
+    std::vector<std::string>::const_iterator it = keys.begin();
+    std::vector<std::string>::const_iterator itend = keys.end();
+    while (it != itend) {
+      lidxs.insert(kc::hashmurmur(it->data(), it->size()) % SLOTNUM);
+      ++it;
+    }
+    std::set<size_t>::iterator lit = lidxs.begin();
+    std::set<size_t>::iterator litend = lidxs.end();
+    while (lit != litend) {
+      slots_.lock(*lit);
+      ++lit;
+    }
+    enter(writable);
+    visitor->visit_before();
+    bool err = false;
+    it = keys.begin();
+    while (it != itend) {
+      if (!accept_impl(it->data(), it->size(), visitor, writable)) {
+        err = true;
+        break;
+      }
+      ++it;
+    }
+    visitor->visit_after();
+    leave(writable);
+    lit = lidxs.begin();
+    while (lit != litend) {
+      slots_.unlock(*lit);
+      ++lit;
+    }
+    return !err;
+  }
+ protected:
+  /** The number of record lock slots. */
+  static const size_t SLOTNUM = 1024;
+  virtual bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable) = 0;
+  virtual void enter(bool writable) {}
+  virtual void leave(bool writable) {}
+  kc::SlottedMutex slots_;
+};
+
+
+/**
+ * Database to distribute records into multiple databases by the hash value of the key.
+ */
+class ShardDB : public WrapperDB {
+ public:
+  explicit ShardDB(size_t dbnum) : dbs_(), path_() {
+    for (size_t i = 0; i < dbnum; i++) {
+      dbs_.push_back(new kc::PolyDB());
+    }
+  }
+  ~ShardDB() {
+    if (omode_ != 0) close();
+    std::vector<kc::PolyDB*>::iterator it = dbs_.begin();
+    std::vector<kc::PolyDB*>::iterator itend = dbs_.end();
+    while (it != itend) {
+      delete *it;
+      it++;
+    }
+  }
+  bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE) {
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      std::string spath;
+      bool rv = expandpath(path, i, &spath);
+      if (!rv) {
+        set_error(_KCCODELINE_, Error::INVALID, "no shard number in the path");
+      } else if (!dbs_[i]->open(spath, mode)) {
+        fail(dbs_[i]->error());
+        rv = false;
+      }
+      if (!rv) {
+        for (size_t j = 0; j < i; j++) {
+          dbs_[j]->close();
+        }
+        return false;
+      }
+    }
+    path_ = path;
+    omode_ = mode;
+    return true;
+  }
+  bool close() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    bool err = false;
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->close()) {
+        fail(dbs_[i]->error());
+        err = true;
+      }
+    }
+    path_.clear();
+    omode_ = 0;
+    return !err;
+  }
+  bool accept(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable = true) {
+    kc::PolyDB* db = dbs_[route(kbuf, ksiz)];
+    if (!db->accept(kbuf, ksiz, visitor, writable)) return fail(db->error());
+    return true;
+  }
+  bool accept_bulk(const std::vector<std::string>& keys, Visitor* visitor,
+                   bool writable = true) {
+    std::vector<StringVector> groups(dbs_.size());
+    std::vector<std::string>::const_iterator it = keys.begin();
+    std::vector<std::string>::const_iterator itend = keys.end();
+    while (it != itend) {
+      groups[route(it->data(), it->size())].push_back(*it);
+      it++;
+    }
+    if (dynamic_cast<SoftVisitor*>(SoftDB::reveal_visitor(visitor))) {
+      for (size_t i = 0; i < dbs_.size(); i++) {
+        if (groups[i].empty()) continue;
+        if (!dbs_[i]->accept_bulk(groups[i], visitor, writable)) return fail(dbs_[i]->error());
+      }
+      return true;
+    }
+    class TaskImpl : public Task {
+     public:
+      explicit TaskImpl(std::vector<StringVector>* groups, Visitor* visitor, bool writable) :
+          groups_(groups), lock_(), visitor_(visitor, &lock_), writable_(writable) {}
+      bool process(kc::PolyDB* db, size_t idx) {
+        const StringVector& keys = (*groups_)[idx];
+        if (keys.empty()) return true;
+        return db->accept_bulk(keys, &visitor_, writable_);
+      }
+     private:
+      std::vector<StringVector>* groups_;
+      kc::Mutex lock_;
+      LockedVisitor visitor_;
+      bool writable_;
+    };
+    TaskImpl task(&groups, visitor, writable);
+    visitor->visit_before();
+    bool rv = fanout(&task);
+    visitor->visit_after();
+    return rv;
+  }
+  bool iterate(Visitor* visitor, bool writable = true, ProgressChecker* checker = NULL) {
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->iterate(visitor, writable, checker)) return fail(dbs_[i]->error());
+    }
+    return true;
+  }
+  bool scan_parallel(Visitor* visitor, size_t thnum, ProgressChecker* checker = NULL) {
+    class TaskImpl : public Task {
+     public:
+      explicit TaskImpl(Visitor* visitor, size_t thnum, ProgressChecker* checker) :
+          visitor_(visitor), thnum_(thnum), checker_(checker) {}
+      bool process(kc::PolyDB* db, size_t idx) {
+        return db->scan_parallel(visitor_, thnum_, checker_);
+      }
+     private:
+      Visitor* visitor_;
+      size_t thnum_;
+      ProgressChecker* checker_;
+    };
+    size_t sthnum = thnum / dbs_.size();
+    TaskImpl task(visitor, sthnum > 0 ? sthnum : 1, checker);
+    return fanout(&task);
+  }
+  bool synchronize(bool hard = false, FileProcessor* proc = NULL,
+                   ProgressChecker* checker = NULL) {
+    if (proc) {
+      for (size_t i = 0; i < dbs_.size(); i++) {
+        if (!dbs_[i]->synchronize(hard, proc, checker)) return fail(dbs_[i]->error());
+      }
+      return true;
+    }
+    class TaskImpl : public Task {
+     public:
+      explicit TaskImpl(bool hard, ProgressChecker* checker) : hard_(hard), checker_(checker) {}
+      bool process(kc::PolyDB* db, size_t idx) {
+        return db->synchronize(hard_, NULL, checker_);
+      }
+     private:
+      bool hard_;
+      ProgressChecker* checker_;
+    };
+    TaskImpl task(hard, checker);
+    return fanout(&task);
+  }
+  bool occupy(bool writable = true, FileProcessor* proc = NULL) {
+    int64_t count = 0;
+    int64_t size = 0;
+    return occupy_impl(0, writable, proc, &count, &size);
+  }
+  bool begin_transaction(bool hard = false) {
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->begin_transaction(hard)) {
+        fail(dbs_[i]->error());
+        for (size_t j = 0; j < i; j++) {
+          dbs_[j]->end_transaction(false);
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+  bool begin_transaction_try(bool hard = false) {
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->begin_transaction_try(hard)) {
+        fail(dbs_[i]->error());
+        for (size_t j = 0; j < i; j++) {
+          dbs_[j]->end_transaction(false);
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+  bool end_transaction(bool commit = true) {
+    bool err = false;
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->end_transaction(commit)) {
+        fail(dbs_[i]->error());
+        err = true;
+      }
+    }
+    return !err;
+  }
+  bool clear() {
+    class TaskImpl : public Task {
+     public:
+      bool process(kc::PolyDB* db, size_t idx) {
+        return db->clear();
+      }
+    };
+    TaskImpl task;
+    return fanout(&task);
+  }
+  int64_t count() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      int64_t num = dbs_[i]->count();
+      if (num < 0) {
+        fail(dbs_[i]->error());
+        return -1;
+      }
+      sum += num;
+    }
+    return sum;
+  }
+  int64_t size() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      int64_t num = dbs_[i]->size();
+      if (num < 0) {
+        fail(dbs_[i]->error());
+        return -1;
+      }
+      sum += num;
+    }
+    return sum;
+  }
+  std::string path() {
+    return path_;
+  }
+  bool status(std::map<std::string, std::string>* strmap) {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    int64_t count = this->count();
+    int64_t size = this->size();
+    if (count < 0 || size < 0) return false;
+    (*strmap)["type"] = kc::strprintf("%u", (unsigned)TYPEMISC);
+    (*strmap)["realtype"] = kc::strprintf("%u", (unsigned)TYPEMISC);
+    (*strmap)["path"] = path_;
+    (*strmap)["shards"] = kc::strprintf("%lld", (long long)dbs_.size());
+    (*strmap)["count"] = kc::strprintf("%lld", (long long)count);
+    (*strmap)["size"] = kc::strprintf("%lld", (long long)size);
+    return true;
+  }
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      std::string spath;
+      if (!expandpath(dest, i, &spath)) {
+        set_error(_KCCODELINE_, Error::INVALID, "no shard number in the path");
+        return false;
+      }
+      if (!dbs_[i]->copy(spath, checker)) return fail(dbs_[i]->error());
+    }
+    return true;
+  }
+  bool tune_logger(Logger* logger, uint32_t kinds = Logger::WARN | Logger::ERROR) {
+    for (size_t i = 0; i < dbs_.size(); i++) {
+      if (!dbs_[i]->tune_logger(logger, kinds)) return fail(dbs_[i]->error());
+    }
+    return true;
+  }
+  Cursor* cursor() {
+    return new ShardCursor(this);
+  }
+ private:
+  /**
+   * Task performed for each shard.
+   */
+  class Task {
+   public:
+    virtual ~Task() {}
+    virtual bool process(kc::PolyDB* db, size_t idx) = 0;
+  };
+  /**
+   * Thread to perform a task for a shard.
+   */
+  class Worker : public kc::Thread {
+   public:
+    explicit Worker(Task* task, kc::PolyDB* db, size_t idx) :
+        task_(task), db_(db), idx_(idx), rv_(false), code_(Error::SUCCESS), message_() {}
+    void run() {
+      rv_ = task_->process(db_, idx_);
+      if (!rv_) {
+        Error err = db_->error();
+        code_ = err.code();
+        message_ = err.message();
+      }
+    }
+    bool result() {
+      return rv_;
+    }
+    Error::Code code() {
+      return code_;
+    }
+    const char* message() {
+      return message_.c_str();
+    }
+   private:
+    Task* task_;
+    kc::PolyDB* db_;
+    size_t idx_;
+    bool rv_;
+    Error::Code code_;
+    std::string message_;
+  };
+  /**
+   * Wrapper of a visitor to serialize calls from multiple threads.
+   */
+  class LockedVisitor : public Visitor {
+   public:
+    explicit LockedVisitor(Visitor* visitor, kc::Mutex* lock) : visitor_(visitor), lock_(lock) {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      kc::ScopedMutex lock(lock_);
+      return visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+    }
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      kc::ScopedMutex lock(lock_);
+      return visitor_->visit_empty(kbuf, ksiz, sp);
+    }
+   private:
+    Visitor* visitor_;
+    kc::Mutex* lock_;
+  };
+  /**
+   * Cursor to traverse records of all shards in order of the shard number.
+   */
+  class ShardCursor : public Cursor {
+   public:
+    explicit ShardCursor(ShardDB* db) : db_(db), curs_(db->dbs_.size(), NULL), idx_(-1) {}
+    ~ShardCursor() {
+      std::vector<kc::PolyDB::Cursor*>::iterator it = curs_.begin();
+      std::vector<kc::PolyDB::Cursor*>::iterator itend = curs_.end();
+      while (it != itend) {
+        delete *it;
+        it++;
+      }
+    }
+    bool accept(Visitor* visitor, bool writable = true, bool step = false) {
+      if (idx_ < 0) return db_->fail(Error(Error::NOREC, "no record"));
+      while (true) {
+        kc::PolyDB::Cursor* cur = get(idx_);
+        if (cur->accept(visitor, writable, step)) return true;
+        Error err = cur->error();
+        if (err != Error::NOREC) return db_->fail(err);
+        if (!forward()) return false;
+      }
+    }
+    bool jump() {
+      idx_ = -1;
+      return forward();
+    }
+    bool jump(const char* kbuf, size_t ksiz) {
+      int64_t idx = db_->route(kbuf, ksiz);
+      kc::PolyDB::Cursor* cur = get(idx);
+      if (!cur->jump(kbuf, ksiz)) {
+        idx_ = -1;
+        return db_->fail(cur->error());
+      }
+      idx_ = idx;
+      return true;
+    }
+    bool jump(const std::string& key) {
+      return jump(key.data(), key.size());
+    }
+    bool jump_back() {
+      idx_ = curs_.size();
+      return backward();
+    }
+    bool jump_back(const char* kbuf, size_t ksiz) {
+      int64_t idx = db_->route(kbuf, ksiz);
+      kc::PolyDB::Cursor* cur = get(idx);
+      if (!cur->jump_back(kbuf, ksiz)) {
+        idx_ = -1;
+        return db_->fail(cur->error());
+      }
+      idx_ = idx;
+      return true;
+    }
+    bool jump_back(const std::string& key) {
+      return jump_back(key.data(), key.size());
+    }
+    bool step() {
+      if (idx_ < 0) return db_->fail(Error(Error::NOREC, "no record"));
+      kc::PolyDB::Cursor* cur = get(idx_);
+      if (cur->step()) return true;
+      Error err = cur->error();
+      if (err != Error::NOREC) return db_->fail(err);
+      return forward();
+    }
+    bool step_back() {
+      if (idx_ < 0) return db_->fail(Error(Error::NOREC, "no record"));
+      kc::PolyDB::Cursor* cur = get(idx_);
+      if (cur->step_back()) return true;
+      Error err = cur->error();
+      if (err != Error::NOREC) return db_->fail(err);
+      return backward();
+    }
+    ShardDB* db() {
+      return db_;
+    }
+   private:
+    kc::PolyDB::Cursor* get(int64_t idx) {
+      if (!curs_[idx]) curs_[idx] = db_->dbs_[idx]->cursor();
+      return curs_[idx];
+    }
+    bool forward() {
+      for (int64_t i = idx_ + 1; i < (int64_t)curs_.size(); i++) {
+        kc::PolyDB::Cursor* cur = get(i);
+        if (cur->jump()) {
+          idx_ = i;
+          return true;
+        }
+        Error err = cur->error();
+        if (err != Error::NOREC) {
+          idx_ = -1;
+          return db_->fail(err);
+        }
+      }
+      idx_ = -1;
+      return db_->fail(Error(Error::NOREC, "no record"));
+    }
+    bool backward() {
+      for (int64_t i = idx_ - 1; i >= 0; i--) {
+        kc::PolyDB::Cursor* cur = get(i);
+        if (cur->jump_back()) {
+          idx_ = i;
+          return true;
+        }
+        Error err = cur->error();
+        if (err != Error::NOREC) {
+          idx_ = -1;
+          return db_->fail(err);
+        }
+      }
+      idx_ = -1;
+      return db_->fail(Error(Error::NOREC, "no record"));
+    }
+    ShardDB* db_;
+    std::vector<kc::PolyDB::Cursor*> curs_;
+    int64_t idx_;
+  };
+  /**
+   * Processor to occupy the next shard.
+   */
+  class OccupyChain : public FileProcessor {
+   public:
+    explicit OccupyChain(ShardDB* db, size_t idx, bool writable, FileProcessor* proc,
+                         int64_t* count, int64_t* size) :
+        db_(db), idx_(idx), writable_(writable), proc_(proc), count_(count), size_(size) {}
+    bool process(const std::string& path, int64_t count, int64_t size) {
+      *count_ += count;
+      *size_ += size;
+      return db_->occupy_impl(idx_ + 1, writable_, proc_, count_, size_);
+    }
+   private:
+    ShardDB* db_;
+    size_t idx_;
+    bool writable_;
+    FileProcessor* proc_;
+    int64_t* count_;
+    int64_t* size_;
+  };
+  size_t route(const char* kbuf, size_t ksiz) {
+    return kc::hashmurmur(kbuf, ksiz) % dbs_.size();
+  }
+  bool fanout(Task* task) {
+    size_t dbnum = dbs_.size();
+    if (dbnum < 2) {
+      if (!task->process(dbs_[0], 0)) return fail(dbs_[0]->error());
+      return true;
+    }
+    std::vector<Worker*> workers;
+    workers.reserve(dbnum);
+    for (size_t i = 0; i < dbnum; i++) {
+      Worker* worker = new Worker(task, dbs_[i], i);
+      worker->start();
+      workers.push_back(worker);
+    }
+    bool err = false;
+    for (size_t i = 0; i < dbnum; i++) {
+      Worker* worker = workers[i];
+      worker->join();
+      if (!worker->result() && !err) {
+        error_->set(worker->code(), worker->message());
+        err = true;
+      }
+      delete worker;
+    }
+    return !err;
+  }
+  bool occupy_impl(size_t idx, bool writable, FileProcessor* proc,
+                   int64_t* count, int64_t* size) {
+    if (idx >= dbs_.size()) return !proc || proc->process(path_, *count, *size);
+    OccupyChain chain(this, idx, writable, proc, count, size);
+    if (!dbs_[idx]->occupy(writable, &chain)) return fail(dbs_[idx]->error());
+    return true;
+  }
+  static bool expandpath(const std::string& tmpl, size_t idx, std::string* dest) {
+    size_t pos = tmpl.find('%');
+    if (pos == std::string::npos) return false;
+    size_t end = pos + 1;
+    while (end < tmpl.size() && tmpl[end] >= '0' && tmpl[end] <= '9') {
+      end++;
+    }
+    if (end >= tmpl.size() || tmpl[end] != 'd') return false;
+    int32_t width = kc::atoi(tmpl.substr(pos + 1, end - pos - 1).c_str());
+    dest->clear();
+    dest->append(tmpl, 0, pos);
+    dest->append(kc::strprintf("%0*d", (int)width, (int)idx));
+    dest->append(tmpl, end + 1, std::string::npos);
+    return true;
+  }
+  std::vector<kc::PolyDB*> dbs_;
+  std::string path_;
+};
+
+
+/**
+ * Database of two tiers with a cache database over a persistent database.
+ */
+class TierDB : public SlottedDB {
+ public:
+  explicit TierDB(const std::string& cpath, int64_t maxdirty) :
+      cache_(), store_(), cpath_(cpath), maxdirty_(maxdirty), dlock_(), wcond_(), fcond_(), flock_(), dirty_(), flushing_(),
+      dstamp_(0), fstamp_(0), flusher_(NULL), stop_(false), urgent_(false),
+      chits_(0), shits_(0), misses_(0), flushes_(0), fails_(0),
+      code_(Error::SUCCESS), message_() {}
+  ~TierDB() {
+    if (omode_ != 0) close();
+  }
+  bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE) {
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    if (!store_.open(path, mode)) return fail(store_.error());
+    if (!cache_.open(cpath_, OWRITER | OCREATE | OTRUNCATE)) {
+      fail(cache_.error());
+      store_.close();
+      return false;
+    }
+    omode_ = mode;
+    if (maxdirty_ > 0 && (mode & OWRITER)) {
+      stop_ = false;
+      flusher_ = new Flusher(this);
+      flusher_->start();
+    }
+    return true;
+  }
+  bool close() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    bool err = false;
+    if (flusher_) {
+      dlock_.lock();
+      stop_ = true;
+      fcond_.broadcast();
+      wcond_.broadcast();
+      dlock_.unlock();
+      flusher_->join();
+      delete flusher_;
+      flusher_ = NULL;
+    }
+    if (!flush_all()) err = true;
+    if (!cache_.close()) {
+      fail(cache_.error());
+      err = true;
+    }
+    if (!store_.close()) {
+      fail(store_.error());
+      err = true;
+    }
+    omode_ = 0;
+    return !err;
+  }
+  bool iterate(Visitor* visitor, bool writable = true, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    EvictVisitor evictor(this, visitor);
+    if (!store_.iterate(&evictor, writable, checker)) return fail(store_.error());
+    return true;
+  }
+  bool scan_parallel(Visitor* visitor, size_t thnum, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.scan_parallel(visitor, thnum, checker)) return fail(store_.error());
+    return true;
+  }
+  bool synchronize(bool hard = false, FileProcessor* proc = NULL,
+                   ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.synchronize(hard, proc, checker)) return fail(store_.error());
+    return true;
+  }
+  bool occupy(bool writable = true, FileProcessor* proc = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.occupy(writable, proc)) return fail(store_.error());
+    return true;
+  }
+  bool begin_transaction(bool hard = false) {
+    if (maxdirty_ > 0) {
+      set_error(_KCCODELINE_, Error::NOIMPL, "not implemented in the write-back mode");
+      return false;
+    }
+    if (!store_.begin_transaction(hard)) return fail(store_.error());
+    return true;
+  }
+  bool begin_transaction_try(bool hard = false) {
+    if (maxdirty_ > 0) {
+      set_error(_KCCODELINE_, Error::NOIMPL, "not implemented in the write-back mode");
+      return false;
+    }
+    if (!store_.begin_transaction_try(hard)) return fail(store_.error());
+    return true;
+  }
+  bool end_transaction(bool commit = true) {
+    if (!store_.end_transaction(commit)) return fail(store_.error());
+    if (!commit && !cache_.clear()) return fail(cache_.error());
+    return true;
+  }
+  bool clear() {
+    kc::ScopedMutex flock(&flock_);
+    dlock_.lock();
+    dirty_.clear();
+    dstamp_ = 0;
+    wcond_.broadcast();
+    dlock_.unlock();
+    if (!cache_.clear()) return fail(cache_.error());
+    if (!store_.clear()) return fail(store_.error());
+    return true;
+  }
+  int64_t count() {
+    if (!flush_all()) return -1;
+    int64_t count = store_.count();
+    if (count < 0) fail(store_.error());
+    return count;
+  }
+  int64_t size() {
+    int64_t size = store_.size();
+    if (size < 0) fail(store_.error());
+    return size;
+  }
+  std::string path() {
+    return store_.path();
+  }
+  bool status(std::map<std::string, std::string>* strmap) {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (!store_.status(strmap)) return fail(store_.error());
+    (*strmap)["type"] = kc::strprintf("%u", (unsigned)TYPEMISC);
+    (*strmap)["tier_cache_count"] = kc::strprintf("%lld", (long long)cache_.count());
+    (*strmap)["tier_cache_size"] = kc::strprintf("%lld", (long long)cache_.size());
+    (*strmap)["tier_cache_hits"] = kc::strprintf("%lld", (long long)chits_.get());
+    (*strmap)["tier_store_hits"] = kc::strprintf("%lld", (long long)shits_.get());
+    (*strmap)["tier_misses"] = kc::strprintf("%lld", (long long)misses_.get());
+    kc::ScopedMutex lock(&dlock_);
+    double now = kc::time();
+    double stamp = fstamp_ > 0 ? fstamp_ : dstamp_;
+    (*strmap)["tier_dirty"] = kc::strprintf("%lld", (long long)(dirty_.size() + flushing_.size()));
+    (*strmap)["tier_flush_lag"] = kc::strprintf("%.6f", stamp > 0 ? now - stamp : 0.0);
+    (*strmap)["tier_flushes"] = kc::strprintf("%lld", (long long)flushes_);
+    (*strmap)["tier_flush_fails"] = kc::strprintf("%lld", (long long)fails_);
+    return true;
+  }
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.copy(dest, checker)) return fail(store_.error());
+    return true;
+  }
+  bool tune_logger(Logger* logger, uint32_t kinds = Logger::WARN | Logger::ERROR) {
+    if (!store_.tune_logger(logger, kinds)) return fail(store_.error());
+    return true;
+  }
+  Cursor* cursor() {
+    flush_all();
+    return new TierCursor(this);
+  }
+ private:
+  /** The maximum interval of flushing dirty records in seconds. */
+  static const double FLUSHINTERVAL;
+  /**
+   * Dirty record not written into the persistent tier yet.
+   */
+  struct DirtyRecord {
+    bool removed;
+    std::string value;
+  };
+  typedef std::map<std::string, DirtyRecord> DirtyMap;
+  /**
+   * Thread to flush dirty records.
+   */
+  class Flusher : public kc::Thread {
+   public:
+    explicit Flusher(TierDB* db) : db_(db) {}
+    void run() {
+      db_->work();
+    }
+   private:
+    TierDB* db_;
+  };
+  /**
+   * Wrapper of a visitor to drop updated records from the cache tier.
+   */
+  class EvictVisitor : public Visitor {
+   public:
+    explicit EvictVisitor(TierDB* db, Visitor* visitor) : db_(db), visitor_(visitor) {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      const char* rv = visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+      if (rv != NOP) db_->cache_.remove(kbuf, ksiz);
+      return rv;
+    }
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      return visitor_->visit_empty(kbuf, ksiz, sp);
+    }
+    void visit_before() {
+      visitor_->visit_before();
+    }
+    void visit_after() {
+      visitor_->visit_after();
+    }
+   private:
+    TierDB* db_;
+    Visitor* visitor_;
+  };
+  /**
+   * Cursor to traverse records of the persistent tier.
+   */
+  class TierCursor : public WrapperCursor {
+   public:
+    explicit TierCursor(TierDB* db) : WrapperCursor(db, db->store_.cursor()), tdb_(db) {}
+    bool accept(Visitor* visitor, bool writable = true, bool step = false) {
+      EvictVisitor evictor(tdb_, visitor);
+      return WrapperCursor::accept(&evictor, writable, step);
+    }
+   private:
+    TierDB* tdb_;
+  };
+  int32_t lookup(const char* kbuf, size_t ksiz, std::string* value) {
+    std::string key(kbuf, ksiz);
+    dlock_.lock();
+    DirtyMap::iterator it = dirty_.find(key);
+    bool hit = it != dirty_.end();
+    if (!hit) {
+      it = flushing_.find(key);
+      hit = it != flushing_.end();
+    }
+    if (hit) {
+      bool removed = it->second.removed;
+      if (!removed) value->assign(it->second.value);
+      dlock_.unlock();
+      chits_.add(1);
+      return removed ? 0 : 1;
+    }
+    dlock_.unlock();
+    size_t vsiz;
+    char* vbuf = cache_.get(kbuf, ksiz, &vsiz);
+    if (vbuf) {
+      value->assign(vbuf, vsiz);
+      delete[] vbuf;
+      chits_.add(1);
+      return 1;
+    }
+    vbuf = store_.get(kbuf, ksiz, &vsiz);
+    if (!vbuf) {
+      if (store_.error() != Error::NOREC) {
+        fail(store_.error());
+        return -1;
+      }
+      misses_.add(1);
+      return 0;
+    }
+    value->assign(vbuf, vsiz);
+    delete[] vbuf;
+    shits_.add(1);
+    cache_.set(kbuf, ksiz, value->data(), value->size());
+    return 1;
+  }
+  bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable) {
+    std::string value;
+    int32_t hit = lookup(kbuf, ksiz, &value);
+    if (hit < 0) return false;
+    size_t vsiz;
+    const char* vbuf = hit > 0 ?
+        visitor->visit_full(kbuf, ksiz, value.data(), value.size(), &vsiz) :
+        visitor->visit_empty(kbuf, ksiz, &vsiz);
+    if (!writable || vbuf == Visitor::NOP) return true;
+    if (vbuf == Visitor::REMOVE) {
+      if (hit < 1) return true;
+      vbuf = NULL;
+      vsiz = 0;
+    }
+    return update(kbuf, ksiz, vbuf, vsiz);
+  }
+  bool update(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    if (maxdirty_ < 1) {
+      if (vbuf) {
+        if (!store_.set(kbuf, ksiz, vbuf, vsiz)) return fail(store_.error());
+        cache_.set(kbuf, ksiz, vbuf, vsiz);
+      } else {
+        if (!store_.remove(kbuf, ksiz) && store_.error() != Error::NOREC)
+          return fail(store_.error());
+        cache_.remove(kbuf, ksiz);
+      }
+      return true;
+    }
+    if (vbuf) {
+      cache_.set(kbuf, ksiz, vbuf, vsiz);
+    } else {
+      cache_.remove(kbuf, ksiz);
+    }
+    kc::ScopedMutex lock(&dlock_);
+    if (dirty_.empty()) dstamp_ = kc::time();
+    DirtyRecord& rec = dirty_[std::string(kbuf, ksiz)];
+    rec.removed = !vbuf;
+    rec.value.assign(vbuf ? vbuf : "", vsiz);
+    if ((int64_t)dirty_.size() >= maxdirty_ / 2) fcond_.signal();
+    while ((int64_t)dirty_.size() >= maxdirty_ && flusher_ && !stop_) {
+      urgent_ = true;
+      fcond_.signal();
+      wcond_.wait(&dlock_);
+    }
+    return true;
+  }
+  void work() {
+    kc::ScopedMutex lock(&dlock_);
+    while (!stop_) {
+      if (dirty_.empty()) {
+        fcond_.wait(&dlock_, FLUSHINTERVAL);
+        continue;
+      }
+      double left = dstamp_ + FLUSHINTERVAL - kc::time();
+      if (!urgent_ && (int64_t)dirty_.size() < maxdirty_ / 2 && left > 0) {
+        fcond_.wait(&dlock_, left);
+        continue;
+      }
+      urgent_ = false;
+      dlock_.unlock();
+      flush_batch();
+      dlock_.lock();
+    }
+  }
+  bool flush_batch() {
+    kc::ScopedMutex flock(&flock_);
+    dlock_.lock();
+    if (dirty_.empty()) {
+      dlock_.unlock();
+      return true;
+    }
+    flushing_.swap(dirty_);
+    fstamp_ = dstamp_;
+    dstamp_ = 0;
+    wcond_.broadcast();
+    dlock_.unlock();
+    DirtyMap failed;
+    Error err;
+    DirtyMap::iterator it = flushing_.begin();
+    DirtyMap::iterator itend = flushing_.end();
+    while (it != itend) {
+      const std::string& key = it->first;
+      const DirtyRecord& rec = it->second;
+      bool rv = rec.removed ?
+          store_.remove(key) || store_.error() == Error::NOREC :
+          store_.set(key, rec.value);
+      if (!rv) {
+        err = store_.error();
+        failed.insert(*it);
+      }
+      ++it;
+    }
+    kc::ScopedMutex lock(&dlock_);
+    flushing_.clear();
+    fstamp_ = 0;
+    flushes_++;
+    if (failed.empty()) return true;
+    fails_++;
+    code_ = err.code();
+    message_ = err.message();
+    it = failed.begin();
+    itend = failed.end();
+    while (it != itend) {
+      if (dirty_.empty()) dstamp_ = kc::time();
+      dirty_.insert(*it);
+      ++it;
+    }
+    return false;
+  }
+  bool flush_all() {
+    while (true) {
+      dlock_.lock();
+      bool empty = dirty_.empty();
+      dlock_.unlock();
+      if (empty) return true;
+      if (!flush_batch()) {
+        kc::ScopedMutex lock(&dlock_);
+        set_error(_KCCODELINE_, code_, message_.c_str());
+        return false;
+      }
+    }
+  }
+  kc::PolyDB cache_;
+  kc::PolyDB store_;
+  std::string cpath_;
+  int64_t maxdirty_;
+  kc::Mutex dlock_;
+  kc::CondVar wcond_;
+  kc::CondVar fcond_;
+  kc::Mutex flock_;
+  DirtyMap dirty_;
+  DirtyMap flushing_;
+  double dstamp_;
+  double fstamp_;
+  Flusher* flusher_;
+  bool stop_;
+  bool urgent_;
+  kc::AtomicInt64 chits_;
+  kc::AtomicInt64 shits_;
+  kc::AtomicInt64 misses_;
+  int64_t flushes_;
+  int64_t fails_;
+  Error::Code code_;
+  std::string message_;
+};
+const double TierDB::FLUSHINTERVAL = 1.0;
+
+
+/**
+ * Database absorbing updates into on-memory tables flushed into a persistent database.
+ */
+class MemtableDB : public SlottedDB {
+ public:
+  explicit MemtableDB(const std::string& mpath, int64_t limit) :
+      store_(), mpath_(mpath), limit_(limit), ordered_(false),
+      active_(NULL), frozen_(NULL), block_(), flock_(), cmutex_(), cond_(),
+      wcond_(), msize_(0), fsize_(0), flusher_(NULL), stop_(false), flushes_(0), fails_(0), ftime_(0) {}
+  ~MemtableDB() {
+    if (omode_ != 0) close();
+  }
+  bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE) {
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    active_ = new kc::PolyDB();
+    frozen_ = new kc::PolyDB();
+    if (!active_->open(mpath_, OWRITER | OCREATE) || !frozen_->open(mpath_, OWRITER | OCREATE)) {
+      fail(active_->error() == Error::SUCCESS ? frozen_->error() : active_->error());
+      delete active_;
+      delete frozen_;
+      active_ = NULL;
+      frozen_ = NULL;
+      return false;
+    }
+    BasicDB::Type type = active_->type();
+    if (type != TYPESTASH && type != TYPEGRASS) {
+      set_error(_KCCODELINE_, Error::INVALID, "not a stash or grass database");
+      delete active_;
+      delete frozen_;
+      active_ = NULL;
+      frozen_ = NULL;
+      return false;
+    }
+    ordered_ = type == TYPEGRASS;
+    if (!store_.open(path, mode)) {
+      fail(store_.error());
+      delete active_;
+      delete frozen_;
+      active_ = NULL;
+      frozen_ = NULL;
+      return false;
+    }
+    omode_ = mode;
+    msize_ = 0;
+    fsize_ = 0;
+    if (mode & OWRITER) {
+      stop_ = false;
+      flusher_ = new Flusher(this);
+      flusher_->start();
+    }
+    return true;
+  }
+  bool close() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    bool err = false;
+    if (flusher_) {
+      cmutex_.lock();
+      stop_ = true;
+      cond_.signal();
+      wcond_.broadcast();
+      cmutex_.unlock();
+      flusher_->join();
+      delete flusher_;
+      flusher_ = NULL;
+    }
+    if (!flush_all()) err = true;
+    if (!store_.close()) {
+      fail(store_.error());
+      err = true;
+    }
+    delete active_;
+    delete frozen_;
+    active_ = NULL;
+    frozen_ = NULL;
+    omode_ = 0;
+    return !err;
+  }
+  bool iterate(Visitor* visitor, bool writable = true, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    RedirectVisitor redirector(this, visitor);
+    if (!store_.iterate(&redirector, false, checker)) return fail(store_.error());
+    if (writable) kick();
+    return true;
+  }
+  bool scan_parallel(Visitor* visitor, size_t thnum, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.scan_parallel(visitor, thnum, checker)) return fail(store_.error());
+    return true;
+  }
+  bool synchronize(bool hard = false, FileProcessor* proc = NULL,
+                   ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.synchronize(hard, proc, checker)) return fail(store_.error());
+    return true;
+  }
+  bool occupy(bool writable = true, FileProcessor* proc = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.occupy(writable, proc)) return fail(store_.error());
+    return true;
+  }
+  bool begin_transaction(bool hard = false) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool begin_transaction_try(bool hard = false) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool end_transaction(bool commit = true) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool clear() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    kc::ScopedMutex flock(&flock_);
+    block_.lock_writer();
+    active_->clear();
+    frozen_->clear();
+    msize_ = 0;
+    fsize_ = 0;
+    block_.unlock();
+    wake();
+    if (!store_.clear()) return fail(store_.error());
+    return true;
+  }
+  int64_t count() {
+    if (!flush_all()) return -1;
+    int64_t count = store_.count();
+    if (count < 0) fail(store_.error());
+    return count;
+  }
+  int64_t size() {
+    int64_t size = store_.size();
+    if (size < 0) fail(store_.error());
+    return size;
+  }
+  std::string path() {
+    return store_.path();
+  }
+  bool status(std::map<std::string, std::string>* strmap) {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (!store_.status(strmap)) return fail(store_.error());
+    (*strmap)["type"] = kc::strprintf("%u", (unsigned)TYPEMISC);
+    block_.lock_reader();
+    (*strmap)["memtable_count"] = kc::strprintf("%lld", (long long)active_->count());
+    (*strmap)["memtable_frozen"] = kc::strprintf("%lld", (long long)frozen_->count());
+    block_.unlock();
+    (*strmap)["memtable_size"] = kc::strprintf("%lld", (long long)msize_.get());
+    (*strmap)["memtable_frozen_size"] = kc::strprintf("%lld", (long long)fsize_.get());
+    (*strmap)["memtable_flushes"] = kc::strprintf("%lld", (long long)flushes_.get());
+    (*strmap)["memtable_flush_fails"] = kc::strprintf("%lld", (long long)fails_.get());
+    (*strmap)["memtable_flush_time"] = kc::strprintf("%.6f", ftime_.get() / 1000000.0);
+    return true;
+  }
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    if (!flush_all()) return false;
+    if (!store_.copy(dest, checker)) return fail(store_.error());
+    return true;
+  }
+  bool tune_logger(Logger* logger, uint32_t kinds = Logger::WARN | Logger::ERROR) {
+    if (!store_.tune_logger(logger, kinds)) return fail(store_.error());
+    return true;
+  }
+  Cursor* cursor() {
+    flush_all();
+    return new MemtableCursor(this);
+  }
+ private:
+  /** The base size of a record in the memory usage. */
+  static const int64_t RECBASESIZ = 64;
+  /** The ratio of the memory usage of both memtables to block writers at. */
+  static const int64_t CAPRATIO = 2;
+  /** The tag of a record storing a value. */
+  static const char TAGVALUE = 1;
+  /** The tag of a record marking a removal. */
+  static const char TAGREMOVE = 0;
+  /**
+   * Thread to flush the frozen table.
+   */
+  class Flusher : public kc::Thread {
+   public:
+    explicit Flusher(MemtableDB* db) : db_(db) {}
+    void run() {
+      db_->work();
+    }
+   private:
+    MemtableDB* db_;
+  };
+  /**
+   * Wrapper of a visitor to store updates of the persistent tier into the active table.
+   */
+  class RedirectVisitor : public Visitor {
+   public:
+    explicit RedirectVisitor(MemtableDB* db, Visitor* visitor) :
+        db_(db), visitor_(visitor), removed_(false) {}
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      const char* rv = visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+      if (rv == NOP) return NOP;
+      if (rv == REMOVE) {
+        db_->put(kbuf, ksiz, NULL, 0);
+        removed_ = true;
+      } else {
+        db_->put(kbuf, ksiz, rv, *sp);
+      }
+      return NOP;
+    }
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      return visitor_->visit_empty(kbuf, ksiz, sp);
+    }
+    void visit_before() {
+      visitor_->visit_before();
+    }
+    void visit_after() {
+      visitor_->visit_after();
+    }
+    bool removed() {
+      return removed_;
+    }
+   private:
+    MemtableDB* db_;
+    Visitor* visitor_;
+    bool removed_;
+  };
+  /**
+   * Cursor to traverse records of the persistent database.
+   */
+  class MemtableCursor : public WrapperCursor {
+   public:
+    explicit MemtableCursor(MemtableDB* db) : WrapperCursor(db, db->store_.cursor()), mdb_(db) {}
+    bool accept(Visitor* visitor, bool writable = true, bool step = false) {
+      RedirectVisitor redirector(mdb_, visitor);
+      if (!WrapperCursor::accept(&redirector, false, step)) return false;
+      if (redirector.removed() && !step && !cur_->step() &&
+          cur_->error() != Error::NOREC) return fail();
+      if (writable) mdb_->kick();
+      return true;
+    }
+   private:
+    MemtableDB* mdb_;
+  };
+  void enter(bool writable) {
+    block_.lock_reader();
+  }
+  void leave(bool writable) {
+    block_.unlock();
+    if (writable) kick();
+  }
+  int32_t lookup(const char* kbuf, size_t ksiz, std::string* value) {
+    size_t vsiz;
+    char* vbuf = active_->get(kbuf, ksiz, &vsiz);
+    if (!vbuf) vbuf = frozen_->get(kbuf, ksiz, &vsiz);
+    if (vbuf) {
+      bool removed = vbuf[0] == TAGREMOVE;
+      if (!removed) value->assign(vbuf + 1, vsiz - 1);
+      delete[] vbuf;
+      return removed ? 0 : 1;
+    }
+    vbuf = store_.get(kbuf, ksiz, &vsiz);
+    if (!vbuf) {
+      if (store_.error() != Error::NOREC) {
+        fail(store_.error());
+        return -1;
+      }
+      return 0;
+    }
+    value->assign(vbuf, vsiz);
+    delete[] vbuf;
+    return 1;
+  }
+  bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable) {
+    std::string value;
+    int32_t hit = lookup(kbuf, ksiz, &value);
+    if (hit < 0) return false;
+    size_t vsiz;
+    const char* vbuf = hit > 0 ?
+        visitor->visit_full(kbuf, ksiz, value.data(), value.size(), &vsiz) :
+        visitor->visit_empty(kbuf, ksiz, &vsiz);
+    if (!writable || vbuf == Visitor::NOP) return true;
+    if (vbuf == Visitor::REMOVE) {
+      if (hit < 1) return true;
+      vbuf = NULL;
+      vsiz = 0;
+    }
+    return stage(kbuf, ksiz, vbuf, vsiz);
+  }
+  bool stage(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    std::string rec;
+    rec.reserve(vsiz + 1);
+    if (vbuf) {
+      rec.append(1, TAGVALUE);
+      rec.append(vbuf, vsiz);
+    } else {
+      rec.append(1, TAGREMOVE);
+    }
+    int32_t osiz = active_->check(kbuf, ksiz);
+    if (!active_->set(kbuf, ksiz, rec.data(), rec.size())) return fail(active_->error());
+    msize_.add(osiz < 0 ? ksiz + vsiz + RECBASESIZ : (int64_t)rec.size() - osiz);
+    return true;
+  }
+  void put(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    block_.lock_reader();
+    stage(kbuf, ksiz, vbuf, vsiz);
+    block_.unlock();
+  }
+  void kick() {
+    if (msize_.get() < limit_ || !flusher_) return;
+    cmutex_.lock();
+    cond_.signal();
+    int64_t fails = fails_.get();
+    while (msize_.get() + fsize_.get() >= limit_ * CAPRATIO && !stop_ && fails_.get() == fails) {
+      wcond_.wait(&cmutex_, 1.0);
+    }
+    cmutex_.unlock();
+  }
+  void wake() {
+    cmutex_.lock();
+    wcond_.broadcast();
+    cmutex_.unlock();
+  }
+  void work() {
+    while (true) {
+      cmutex_.lock();
+      if (!stop_ && msize_.get() < limit_) cond_.wait(&cmutex_, 1.0);
+      bool stop = stop_;
+      cmutex_.unlock();
+      if (stop) break;
+      if (msize_.get() >= limit_ && !flush_table()) kc::Thread::sleep(0.1);
+    }
+  }
+  bool flush_table() {
+    kc::ScopedMutex flock(&flock_);
+    if (frozen_->count() < 1) {
+      block_.lock_writer();
+      kc::PolyDB* swap = active_;
+      active_ = frozen_;
+      frozen_ = swap;
+      fsize_ = msize_.get();
+      msize_ = 0;
+      block_.unlock();
+    }
+    if (frozen_->count() < 1) return true;
+    double stime = kc::time();
+    bool err = false;
+    kc::PolyDB::Cursor* cur = frozen_->cursor();
+    cur->jump();
+    std::string key, rec;
+    if (ordered_) {
+      while (!err && cur->get(&key, &rec, true)) {
+        if (!apply(key, rec)) err = true;
+      }
+    } else {
+      typedef std::pair<std::string, std::string> Record;
+      std::vector<Record> recs;
+      recs.reserve(frozen_->count());
+      while (cur->get(&key, &rec, true)) {
+        recs.push_back(Record(key, rec));
+      }
+      std::sort(recs.begin(), recs.end());
+      std::vector<Record>::iterator it = recs.begin();
+      std::vector<Record>::iterator itend = recs.end();
+      while (!err && it != itend) {
+        if (!apply(it->first, it->second)) err = true;
+        ++it;
+      }
+    }
+    delete cur;
+    ftime_ = (int64_t)((kc::time() - stime) * 1000000);
+    if (err) {
+      fails_.add(1);
+      wake();
+      return false;
+    }
+    block_.lock_writer();
+    frozen_->clear();
+    fsize_ = 0;
+    block_.unlock();
+    flushes_.add(1);
+    wake();
+    return true;
+  }
+  bool apply(const std::string& key, const std::string& rec) {
+    bool rv = rec[0] == TAGREMOVE ?
+        store_.remove(key) || store_.error() == Error::NOREC :
+        store_.set(key.data(), key.size(), rec.data() + 1, rec.size() - 1);
+    if (!rv) return fail(store_.error());
+    return true;
+  }
+  bool flush_all() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (!(omode_ & OWRITER)) return true;
+    for (int32_t i = 0; i < 2; i++) {
+      if (!flush_table()) return false;
+    }
+    return true;
+  }
+  kc::PolyDB store_;
+  std::string mpath_;
+  int64_t limit_;
+  bool ordered_;
+  kc::PolyDB* active_;
+  kc::PolyDB* frozen_;
+  kc::RWLock block_;
+  kc::Mutex flock_;
+  kc::Mutex cmutex_;
+  kc::CondVar cond_;
+  kc::CondVar wcond_;
+  kc::AtomicInt64 msize_;
+  kc::AtomicInt64 fsize_;
+  Flusher* flusher_;
+  bool stop_;
+  kc::AtomicInt64 flushes_;
+  kc::AtomicInt64 fails_;
+  kc::AtomicInt64 ftime_;
+};
+
+
+/**
+ * Database adapter of an indexed database buffering appended values.
+ */
+class IndexAdapter : public SlottedDB {
+ public:
+  explicit IndexAdapter() : idx_(), clim_(0) {}
+  ~IndexAdapter() {
+    if (omode_ != 0) close();
+  }
+  bool tune_cache_limit(int64_t limit) {
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    clim_ = limit;
+    return true;
+  }
+  bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE) {
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    std::string ipath = path;
+    if (clim_ > 0) kc::strprintf(&ipath, "#idxclim=%lld", (long long)clim_);
+    if (!idx_.open(ipath, mode)) return fail(idx_.error());
+    omode_ = mode;
+    return true;
+  }
+  bool close() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    omode_ = 0;
+    if (!idx_.close()) return fail(idx_.error());
+    return true;
+  }
+  bool append(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    if (!check_open(true)) return false;
+    size_t idx = kc::hashmurmur(kbuf, ksiz) % SLOTNUM;
+    slots_.lock(idx);
+    bool rv = idx_.append(kbuf, ksiz, vbuf, vsiz);
+    slots_.unlock(idx);
+    if (!rv) return fail(idx_.error());
+    return true;
+  }
+  /**
+   * Appender storing values into the buffer of the index database.
+   */
+  class BufferAppender : public SoftDB::Appender {
+   public:
+    explicit BufferAppender(IndexAdapter* db) : db_(db) {}
+    bool append(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+      return db_->append(kbuf, ksiz, vbuf, vsiz);
+    }
+   private:
+    IndexAdapter* db_;
+  };
+  bool iterate(Visitor* visitor, bool writable = true, ProgressChecker* checker = NULL) {
+    kc::PolyDB* db = merged();
+    if (!db) return false;
+    if (!db->iterate(visitor, writable, checker)) return fail(db->error());
+    return true;
+  }
+  bool scan_parallel(Visitor* visitor, size_t thnum, ProgressChecker* checker = NULL) {
+    kc::PolyDB* db = merged();
+    if (!db) return false;
+    if (!db->scan_parallel(visitor, thnum, checker)) return fail(db->error());
+    return true;
+  }
+  bool synchronize(bool hard = false, FileProcessor* proc = NULL,
+                   ProgressChecker* checker = NULL) {
+    if (!idx_.synchronize(hard, proc, checker)) return fail(idx_.error());
+    return true;
+  }
+  bool occupy(bool writable = true, FileProcessor* proc = NULL) {
+    if (!idx_.occupy(writable, proc)) return fail(idx_.error());
+    return true;
+  }
+  bool begin_transaction(bool hard = false) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool begin_transaction_try(bool hard = false) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool end_transaction(bool commit = true) {
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return false;
+  }
+  bool clear() {
+    if (!idx_.clear()) return fail(idx_.error());
+    return true;
+  }
+  int64_t count() {
+    int64_t count = idx_.count();
+    if (count < 0) fail(idx_.error());
+    return count;
+  }
+  int64_t size() {
+    int64_t size = idx_.size();
+    if (size < 0) fail(idx_.error());
+    return size;
+  }
+  std::string path() {
+    return idx_.path();
+  }
+  bool status(std::map<std::string, std::string>* strmap) {
+    if (!idx_.status(strmap)) return fail(idx_.error());
+    (*strmap)["type"] = kc::strprintf("%u", (unsigned)TYPEMISC);
+    return true;
+  }
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    if (!idx_.copy(dest, checker)) return fail(idx_.error());
+    return true;
+  }
+  bool tune_logger(Logger* logger, uint32_t kinds = Logger::WARN | Logger::ERROR) {
+    kc::PolyDB* db = idx_.reveal_inner_db();
+    if (!db->tune_logger(logger, kinds)) return fail(db->error());
+    return true;
+  }
+  Cursor* cursor() {
+    kc::PolyDB* db = merged();
+    return new WrapperCursor(this, db ? db->cursor() : NULL);
+  }
+ private:
+  kc::PolyDB* merged() {
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return NULL;
+    }
+    if ((omode_ & OWRITER) && !idx_.synchronize(false)) {
+      fail(idx_.error());
+      return NULL;
+    }
+    return idx_.reveal_inner_db();
+  }
+  bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor, bool writable) {
+    size_t osiz;
+    char* obuf = idx_.get(kbuf, ksiz, &osiz);
+    if (!obuf && idx_.error() != Error::NOREC) return fail(idx_.error());
+    size_t vsiz;
+    const char* vbuf = obuf ? visitor->visit_full(kbuf, ksiz, obuf, osiz, &vsiz) :
+        visitor->visit_empty(kbuf, ksiz, &vsiz);
+    bool err = false;
+    if (writable && vbuf != Visitor::NOP) {
+      if (vbuf == Visitor::REMOVE) {
+        if (obuf && !idx_.remove(kbuf, ksiz)) err = true;
+      } else if (!idx_.set(kbuf, ksiz, vbuf, vsiz)) {
+        err = true;
+      }
+    }
+    delete[] obuf;
+    if (err) return fail(idx_.error());
+    return true;
+  }
+  kc::IndexDB idx_;
+  int64_t clim_;
+};
+
+
+/**
+ * Throw a runtime error.
+ */
+static void throwruntime(JNIEnv* env, const char* message) {
+  jclass cls = env->FindClass("java/lang/RuntimeException");
+  env->ThrowNew(cls, message);
+}
+
+
+/**
+ * Throw the out-of-memory error.
+ */
+static void throwoutmem(JNIEnv* env) {
+  jclass cls = env->FindClass("java/lang/OutOfMemoryError");
+  env->ThrowNew(cls, "out of memory");
+}
+
+
+/**
+ * Throw the illegal argument exception.
+ */
+static void throwillarg(JNIEnv* env) {
+  jclass cls = env->FindClass("java/lang/IllegalArgumentException");
+  env->ThrowNew(cls, "illegal argument");
+}
+
+
+/**
+ * Create a new string.
+ */
+static jstring newstring(JNIEnv* env, const char* str) {
+  jstring jstr = env->NewStringUTF(str);
+  if (!jstr) {
+    throwoutmem(env);
+    throw std::bad_alloc();
+  }
+  return jstr;
+}
+
+
+/**
+ * Create a new byte array.
+ */
+static jbyteArray newarray(JNIEnv* env, const char* buf, size_t size) {
+  jbyteArray jbuf = env->NewByteArray(size);
+  if (!jbuf) {
+    throwoutmem(env);
+    throw std::bad_alloc();
+  }
+  env->SetByteArrayRegion(jbuf, 0, size, (jbyte *)buf);
+  return jbuf;
+}
+
+
+/**
+ * Convert an internal map to a Java map.
+ */
+static jobject maptojhash(JNIEnv* env, const StringMap* map) {
+  jclass cls_hm = env->FindClass("java/util/HashMap");
+  jmethodID id_hm_init = env->GetMethodID(cls_hm, "<init>", "(I)V");
+  jmethodID id_hm_put = env->GetMethodID(cls_hm, "put", "(" L_OBJ L_OBJ ")" L_OBJ);
+  jobject jhash = env->NewObject(cls_hm, id_hm_init, map->size() * 2 + 1);
+  StringMap::const_iterator it = map->begin();
+  StringMap::const_iterator itend = map->end();
+  while (it != itend) {
+    jstring jkey = newstring(env, it->first.c_str());
+    jstring jvalue = newstring(env, it->second.c_str());
+    env->CallObjectMethod(jhash, id_hm_put, jkey, jvalue);
+    env->DeleteLocalRef(jkey);
+    env->DeleteLocalRef(jvalue);
+    it++;
+  }
+  return jhash;
+}
+
+
+/**
+ * Convert an internal vector to a Java list.
+ */
+static jobject vectortojlist(JNIEnv* env, const StringVector* vec) {
+  jclass cls_al = env->FindClass("java/util/ArrayList");
+  jmethodID id_al_init = env->GetMethodID(cls_al, "<init>", "(I)V");
+  jmethodID id_al_add = env->GetMethodID(cls_al, "add", "(" L_OBJ ")Z");
+  jobject jlist = env->NewObject(cls_al, id_al_init, vec->size());
+  StringVector::const_iterator it = vec->begin();
+  StringVector::const_iterator itend = vec->end();
+  while (it != itend) {
+    jstring jstr = newstring(env, it->c_str());
+    env->CallObjectMethod(jlist, id_al_add, jstr);
+    env->DeleteLocalRef(jstr);
+    it++;
+  }
+  return jlist;
+}
+
+
+/**
+ * Convert the pointer to the internal data of a database object.
+ */
+static SoftDB* getdbcore(JNIEnv* env, jobject jdb) {
+  jclass cls_db = env->GetObjectClass(jdb);
+  jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+  return (SoftDB*)(intptr_t)env->GetLongField(jdb, id_db_ptr);
+}
+
+
+/**
+ * Throw the exception of an error code.
+ */
+static void throwdberror(JNIEnv* env, jobject jdb) {
+  jclass cls_db = env->GetObjectClass(jdb);
+  jfieldID id_db_exbits = env->GetFieldID(cls_db, "exbits_", "I");
+  uint32_t exbits = env->GetLongField(jdb, id_db_exbits);
+  if (exbits == 0) return;
+  kc::PolyDB* db = getdbcore(env, jdb);
+  kc::PolyDB::Error err = db->error();
+  uint32_t code = err.code();
+  if (exbits & (1 << code)) {
+    jclass cls = env->FindClass(p_err_children[code]);
+    std::string expr = kc::strprintf("%u: %s", code, err.message());
+    env->ThrowNew(cls, expr.c_str());
+  }
+}
+
+
+/**
+ * Convert the pointer to the internal data of a cursor object.
+ */
+static SoftCursor* getcurcore(JNIEnv* env, jobject jcur) {
+  jclass cls_cur = env->GetObjectClass(jcur);
+  jfieldID id_cur_ptr = env->GetFieldID(cls_cur, "ptr_", "J");
+  return (SoftCursor*)(intptr_t)env->GetLongField(jcur, id_cur_ptr);
+}
+
+
+/**
+ * Get the inner database object of a cursor object.
+ */
+static jobject getcurdb(JNIEnv* env, jobject jcur) {
+  jclass cls_cur = env->GetObjectClass(jcur);
+  jfieldID id_cur_db = env->GetFieldID(cls_cur, "db_", L_DB);
+  return env->GetObjectField(jcur, id_cur_db);
+}
+
+
+/**
+ * Convert the pointer to the internal data of a replication reader object.
+ */
+static UpdateLogReader* getrepcore(JNIEnv* env, jobject jrep) {
+  jclass cls_rep = env->GetObjectClass(jrep);
+  jfieldID id_rep_ptr = env->GetFieldID(cls_rep, "ptr_", "J");
+  return (UpdateLogReader*)(intptr_t)env->GetLongField(jrep, id_rep_ptr);
+}
+
+
+/**
+ * Create a compressor object by the name.
+ */
+static kc::Compressor* newcompressor(const std::string& name) {
+  if (name == "zlib") return new kc::ZLIBCompressor<kc::ZLIB::RAW>;
+  if (name == "def") return new kc::ZLIBCompressor<kc::ZLIB::DEFLATE>;
+  if (name == "gz") return new kc::ZLIBCompressor<kc::ZLIB::GZIP>;
+  if (name == "lzo") return new kc::LZOCompressor<kc::LZO::RAW>;
+  if (name == "lzma") return new kc::LZMACompressor<kc::LZMA::RAW>;
+  if (name == "fast") return new FastCompressor;
+  return NULL;
+}
+
+
+/**
+ * Dump records into a snapshot file with optional compression.
+ */
+static bool dumpsnapshot(kc::BasicDB* db, const std::string& dest, const std::string& codec,
+                         kc::BasicDB::ProgressChecker* checker) {
+  kc::Compressor* comp = NULL;
+  if (!codec.empty()) {
+    comp = newcompressor(codec);
+    if (!comp) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "unknown compressor");
+      return false;
+    }
+  }
+  std::ofstream ofs;
+  ofs.open(dest.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!ofs) {
+    db->set_error(_KCCODELINE_, kc::BasicDB::Error::NOREPOS, "open failed");
+    delete comp;
+    return false;
+  }
+  if (comp) ofs << snap_magic << codec << '\n';
+  bool err = false;
+  SnapshotWriter writer(&ofs, comp);
+  std::ostream os(&writer);
+  SnapshotChecker chk(checker, &writer, NULL);
+  if (!db->dump_snapshot(&os, &chk)) err = true;
+  if (!err && !writer.finish()) {
+    db->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "write failed");
+    err = true;
+  }
+  ofs.close();
+  if (!err && !ofs) {
+    db->set_error(_KCCODELINE_, kc::BasicDB::Error::SYSTEM, "close failed");
+    err = true;
+  }
+  delete comp;
+  return !err;
+}
+
+
+/**
+ * Load records from a snapshot file detecting compression.
+ */
+static bool loadsnapshot(kc::BasicDB* db, const std::string& src,
+                         kc::BasicDB::ProgressChecker* checker) {
+  std::ifstream ifs;
+  ifs.open(src.c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!ifs) {
+    db->set_error(_KCCODELINE_, kc::BasicDB::Error::NOREPOS, "open failed");
+    return false;
+  }
+  kc::Compressor* comp = NULL;
+  size_t msiz = std::strlen(snap_magic);
+  char mbuf[8];
+  ifs.read(mbuf, msiz);
+  if ((size_t)ifs.gcount() == msiz && !std::memcmp(mbuf, snap_magic, msiz)) {
+    std::string codec;
+    std::getline(ifs, codec);
+    comp = newcompressor(codec);
+    if (!comp) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "unknown compressor");
+      return false;
+    }
+  } else {
+    ifs.clear();
+    ifs.seekg(0);
+  }
+  bool err = false;
+  SnapshotReader* reader = new SnapshotReader(&ifs, comp);
+  std::istream is(reader);
+  SnapshotChecker chk(checker, NULL, reader);
+  if (!db->load_snapshot(&is, &chk)) err = true;
+  if (!err && reader->broken()) {
+    db->set_error(_KCCODELINE_, kc::BasicDB::Error::BROKEN, "invalid compressed block");
+    err = true;
+  }
+  delete reader;
+  delete comp;
+  return !err;
+}
+
+
+/**
+ * Escape a string for a field of tab-separated values.
+ */
+static void escapetsv(const char* buf, size_t size, std::string* dest) {
+  const char* ep = buf + size;
+  while (buf < ep) {
+    unsigned char c = *(unsigned char*)buf;
+    switch (c) {
+      case '\\': dest->append("\\\\"); break;
+      case '\t': dest->append("\\t"); break;
+      case '\n': dest->append("\\n"); break;
+      case '\r': dest->append("\\r"); break;
+      default: {
+        if (c < 0x20 || c == 0x7f) {
+          kc::strprintf(dest, "\\x%02x", c);
+        } else {
+          dest->append(1, c);
+        }
+        break;
+      }
+    }
+    buf++;
+  }
+}
+
+
+/**
+ * Unescape a field of tab-separated values.
+ */
+static void unescapetsv(const char* buf, size_t size, std::string* dest) {
+  dest->clear();
+  const char* ep = buf + size;
+  while (buf < ep) {
+    if (*buf != '\\' || buf + 1 >= ep) {
+      dest->append(1, *buf);
+      buf++;
+      continue;
+    }
+    switch (buf[1]) {
+      case 't': dest->append(1, '\t'); buf += 2; break;
+      case 'n': dest->append(1, '\n'); buf += 2; break;
+      case 'r': dest->append(1, '\r'); buf += 2; break;
+      case 'x': {
+        if (buf + 3 < ep) {
+          dest->append(1, (char)kc::atoih(std::string(buf + 2, 2).c_str()));
+          buf += 4;
+        } else {
+          dest->append(buf, ep - buf);
+          buf = ep;
+        }
+        break;
+      }
+      default: dest->append(1, buf[1]); buf += 2; break;
+    }
+  }
+}
+
+
+/**
+ * Parse a line of tab-separated values into a record.
+ */
+static bool parsetsvline(const char* buf, size_t size, std::string* key, std::string* value) {
+  if (size > 0 && buf[size - 1] == '\r') size--;
+  if (size < 1) return false;
+  const char* tp = (const char*)std::memchr(buf, '\t', size);
+  if (tp) {
+    unescapetsv(buf, tp - buf, key);
+    unescapetsv(tp + 1, buf + size - tp - 1, value);
+  } else {
+    unescapetsv(buf, size, key);
+    value->clear();
+  }
+  return true;
+}
+
+
+/**
+ * Read the elements of a byte array array as keys.
+ */
+static bool readkeys(JNIEnv* env, jobjectArray jkeys, StringVector* keys) {
+  size_t knum = env->GetArrayLength(jkeys);
+  keys->reserve(knum);
+  for (size_t i = 0; i < knum; i++) {
+    jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
+    if (!jkey) return false;
+    SoftArray key(env, jkey);
+    keys->push_back(std::string(key.ptr(), key.size()));
+    env->DeleteLocalRef(jkey);
+  }
+  return true;
+}
+
+
+/**
+ * End the transaction of a bulk operation, keeping the error which caused an abort.
+ */
+static bool endbulk(kc::BasicDB* db, bool commit) {
+  if (commit) return db->end_transaction(true);
+  kc::BasicDB::Error err = db->error();
+  db->end_transaction(false);
+  db->set_error(_KCCODELINE_, err.code(), err.message());
+  return false;
+}
+
+
+/**
+ * Check whether a database type keeps the keys in order.
+ */
+static bool istree(kc::BasicDB::Type type) {
+  return type == kc::BasicDB::TYPEPTREE || type == kc::BasicDB::TYPEGRASS ||
+      type == kc::BasicDB::TYPETREE || type == kc::BasicDB::TYPEFOREST;
+}
+
+
+/**
+ * Implementation of init_visitor_NOP.
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Utility_init_1visitor_1NOP
+(JNIEnv* env, jclass cls) {
+  try {
+    char buf[kc::NUMBUFSIZ];
+    size_t size = std::sprintf(buf, "[NOP]");
+    obj_vis_nop = (jbyteArray)env->NewGlobalRef((jobject)newarray(env, buf, size));
+    return obj_vis_nop;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of init_visitor_REMOVE.
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Utility_init_1visitor_1REMOVE
+(JNIEnv* env, jclass cls) {
+  try {
+    char buf[kc::NUMBUFSIZ];
+    size_t size = std::sprintf(buf, "[REMOVE]");
+    obj_vis_remove = (jbyteArray)env->NewGlobalRef((jobject)newarray(env, buf, size));
+    return obj_vis_remove;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of atoi.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_atoi
+(JNIEnv* env, jclass cls, jstring jstr) {
+  try {
+    if (!jstr) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftString str(env, jstr);
+    return kc::atoi(str.str());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of atoix.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_atoix
+(JNIEnv* env, jclass cls, jstring jstr) {
+  try {
+    if (!jstr) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftString str(env, jstr);
+    return kc::atoix(str.str());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of atof.
+ */
+JNIEXPORT jdouble JNICALL Java_kyotocabinet_Utility_atof
+(JNIEnv* env, jclass cls, jstring jstr) {
+  try {
+    if (!jstr) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftString str(env, jstr);
+    return kc::atof(str.str());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of hash_murmur.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_hash_1murmur
+(JNIEnv* env, jclass cls, jbyteArray jary) {
+  try {
+    if (!jary) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftArray ary(env, jary);
+    return kc::hashmurmur(ary.ptr(), ary.size());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of hash_fnv.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_hash_1fnv
+(JNIEnv* env, jclass cls, jbyteArray jary) {
+  try {
+    if (!jary) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftArray ary(env, jary);
+    return kc::hashfnv(ary.ptr(), ary.size());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of levdist.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_levdist___3B_3B
+(JNIEnv* env, jclass cls, jbyteArray ja, jbyteArray jb) {
+  try {
+    if (!ja || !jb) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftArray aary(env, ja);
+    SoftArray bary(env, jb);
+    return kc::memdist(aary.ptr(), aary.size(), bary.ptr(), bary.size());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of levdist.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_levdist__Ljava_lang_String_2Ljava_lang_String_2
+(JNIEnv* env, jclass cls, jstring ja, jstring jb) {
+  try {
+    if (!ja || !jb) {
+      throwillarg(env);
+      return 0;
+    }
+    SoftString astr(env, ja);
+    SoftString bstr(env, jb);
+    return kc::strutfdist(astr.str(), bstr.str());
+  } catch (std::exception& e) {
+    return 0;
+  }
+}
+
+
+/**
+ * Implementation of remove_recursively.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Utility_remove_1files_1recursively
+(JNIEnv* env, jclass cls, jstring jpath) {
+  if (!jpath) {
+    throwillarg(env);
+    return false;
+  }
+  SoftString path(env, jpath);
+  return kc::File::remove_recursively(path.str());
+}
+
+
+/**
+ * Implementation of version.
+ */
+JNIEXPORT jstring JNICALL Java_kyotocabinet_Utility_version
+(JNIEnv* env, jclass cls) {
+  try {
+    return newstring(env, kc::VERSION);
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of codename.
+ */
+JNIEXPORT jstring JNICALL Java_kyotocabinet_Error_codename
+(JNIEnv* env, jclass cls, jint code) {
+  try {
+    return newstring(env, kc::PolyDB::Error::codename((kyotocabinet::PolyDB::Error::Code)code));
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of disable.
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_disable
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return;
+    cur->disable();
+  } catch (std::exception& e) {}
+}
+
+
+/**
+ * Implementation of accept.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_accept
+(JNIEnv* env, jobject jself, jobject jvisitor, jboolean writable, jboolean step) {
+  try {
+    if (!jvisitor) {
+      throwillarg(env);
+      return false;
+    }
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    SoftVisitor visitor(env, jvisitor, writable);
+    bool rv = icur->accept(&visitor, writable, step);
+    jthrowable jex = visitor.exception();
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of set_value.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_set_1value
+(JNIEnv* env, jobject jself, jbyteArray jvalue, jboolean step) {
+  try {
+    if (!jvalue) {
+      throwillarg(env);
+      return false;
+    }
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    SoftArray value(env, jvalue);
+    bool rv = icur->set_value(value.ptr(), value.size(), step);
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of remove.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_remove
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    bool rv = icur->remove();
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of get_key.
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Cursor_get_1key
+(JNIEnv* env, jobject jself, jboolean step) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return NULL;
+    size_t ksiz;
+    char* kbuf = icur->get_key(&ksiz, step);
+    if (!kbuf) {
+      throwdberror(env, getcurdb(env, jself));
+      return NULL;
+    }
+    jbyteArray jkey = newarray(env, kbuf, ksiz);
+    delete[] kbuf;
+    return jkey;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of get_value.
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Cursor_get_1value
+(JNIEnv* env, jobject jself, jboolean step) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return NULL;
+    size_t vsiz;
+    char* vbuf = icur->get_value(&vsiz, step);
+    if (!vbuf) {
+      throwdberror(env, getcurdb(env, jself));
+      return NULL;
+    }
+    jbyteArray jvalue = newarray(env, vbuf, vsiz);
+    delete[] vbuf;
+    return jvalue;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of get.
+ */
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_Cursor_get
+(JNIEnv* env, jobject jself, jboolean step) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return NULL;
+    const char* vbuf;
+    size_t ksiz, vsiz;
+    char* kbuf = icur->get(&ksiz, &vbuf, &vsiz, step);
+    if (!kbuf) {
+      throwdberror(env, getcurdb(env, jself));
+      return NULL;
+    }
+    jbyteArray jkey = newarray(env, kbuf, ksiz);
+    jbyteArray jvalue = newarray(env, vbuf, vsiz);
+    delete[] kbuf;
+    jclass cls_byteary = env->FindClass("[B");
+    jobjectArray jrec = env->NewObjectArray(2, cls_byteary, NULL);
+    env->SetObjectArrayElement(jrec, 0, jkey);
+    env->SetObjectArrayElement(jrec, 1, jvalue);
+    env->DeleteLocalRef(jkey);
+    env->DeleteLocalRef(jvalue);
+    return jrec;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of seize.
+ */
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_Cursor_seize
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return NULL;
+    const char* vbuf;
+    size_t ksiz, vsiz;
+    char* kbuf = icur->seize(&ksiz, &vbuf, &vsiz);
+    if (!kbuf) {
+      throwdberror(env, getcurdb(env, jself));
+      return NULL;
+    }
+    jbyteArray jkey = newarray(env, kbuf, ksiz);
+    jbyteArray jvalue = newarray(env, vbuf, vsiz);
+    delete[] kbuf;
+    jclass cls_byteary = env->FindClass("[B");
+    jobjectArray jrec = env->NewObjectArray(2, cls_byteary, NULL);
+    env->SetObjectArrayElement(jrec, 0, jkey);
+    env->SetObjectArrayElement(jrec, 1, jvalue);
+    env->DeleteLocalRef(jkey);
+    env->DeleteLocalRef(jvalue);
+    return jrec;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of jump.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump__
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    bool rv = icur->jump();
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of jump.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump___3B
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
+  try {
+    if (!jkey) {
+      throwillarg(env);
+      return false;
+    }
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    SoftArray key(env, jkey);
+    bool rv = icur->jump(key.ptr(), key.size());
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of jump_back.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back__
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    bool rv = icur->jump_back();
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of jump_back.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back___3B
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
+  try {
+    if (!jkey) {
+      throwillarg(env);
+      return false;
+    }
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    SoftArray key(env, jkey);
+    bool rv = icur->jump_back(key.ptr(), key.size());
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of step.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    bool rv = icur->step();
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of step_back.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step_1back
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return false;
+    bool rv = icur->step_back();
+    if (rv) return true;
+    throwdberror(env, getcurdb(env, jself));
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of error.
+ */
+JNIEXPORT jthrowable JNICALL Java_kyotocabinet_Cursor_error
+(JNIEnv* env, jobject jself) {
+  try {
+    jclass cls_err = env->FindClass(P_ERR);
+    jmethodID id_err_init = env->GetMethodID(cls_err, "<init>", "(I" L_STR ")V");
+    SoftCursor* cur = getcurcore(env, jself);
+    kc::PolyDB::Cursor* icur = cur->cur();
+    if (!icur) return NULL;
+    kc::PolyDB::Error err = cur->cur()->error();
+    jstring jmessage = newstring(env, err.message());
+    jobject jerr = env->NewObject(cls_err, id_err_init, err.code(), jmessage);
+    env->DeleteLocalRef(jmessage);
+    return (jthrowable)jerr;
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of db.
+ */
+JNIEXPORT jobject JNICALL Java_kyotocabinet_Cursor_db
+(JNIEnv* env, jobject jself) {
+  try {
+    return getcurdb(env, jself);
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/**
+ * Implementation of initialize.
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_initialize
+(JNIEnv* env, jobject jself, jobject jdb) {
+  try {
+    if (!jdb) {
+      throwillarg(env);
+      return;
+    }
+    jclass cls_cur = env->GetObjectClass(jself);
+    jfieldID id_cur_ptr = env->GetFieldID(cls_cur, "ptr_", "J");
+    jfieldID id_cur_db = env->GetFieldID(cls_cur, "db_", L_DB);
+    kc::PolyDB* db = getdbcore(env, jdb);
+    g_curbur.sweap();
+    SoftCursor* cur = new SoftCursor(db);
+    env->SetLongField(jself, id_cur_ptr, (intptr_t)cur);
+    env->SetObjectField(jself, id_cur_db, jdb);
+  } catch (std::exception& e) {}
+}
+
+
+/**
+ * Implementation of destruct.
  */
-static void throwruntime(JNIEnv* env, const char* message) {
-  jclass cls = env->FindClass("java/lang/RuntimeException");
-  env->ThrowNew(cls, message);
+JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_destruct
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftCursor* cur = getcurcore(env, jself);
+    delete cur;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Throw the out-of-memory error.
+ * Implementation of error.
  */
-static void throwoutmem(JNIEnv* env) {
-  jclass cls = env->FindClass("java/lang/OutOfMemoryError");
-  env->ThrowNew(cls, "out of memory");
+JNIEXPORT jthrowable JNICALL Java_kyotocabinet_DB_error
+(JNIEnv* env, jobject jself) {
+  try {
+    jclass cls_err = env->FindClass(P_ERR);
+    jmethodID id_err_init = env->GetMethodID(cls_err, "<init>", "(I" L_STR ")V");
+    kc::PolyDB* db = getdbcore(env, jself);
+    kc::PolyDB::Error err = db->error();
+    jstring jmessage = newstring(env, err.message());
+    jobject jerr = env->NewObject(cls_err, id_err_init, err.code(), jmessage);
+    env->DeleteLocalRef(jmessage);
+    return (jthrowable)jerr;
+  } catch (std::exception& e) {
+    return NULL;
+  }
 }
 
 
 /**
- * Throw the illegal argument exception.
+ * Implementation of open.
  */
-static void throwillarg(JNIEnv* env) {
-  jclass cls = env->FindClass("java/lang/IllegalArgumentException");
-  env->ThrowNew(cls, "illegal argument");
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_open
+(JNIEnv* env, jobject jself, jstring jpath, jint mode) {
+  try {
+    if (!jpath) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftString path(env, jpath);
+    bool rv = db->open(path.str(), mode);
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
 }
 
 
 /**
- * Create a new string.
+ * Implementation of close.
  */
-static jstring newstring(JNIEnv* env, const char* str) {
-  jstring jstr = env->NewStringUTF(str);
-  if (!jstr) {
-    throwoutmem(env);
-    throw std::bad_alloc();
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_close
+(JNIEnv* env, jobject jself) {
+  try {
+    kc::PolyDB* db = getdbcore(env, jself);
+    g_curbur.sweap();
+    bool rv = db->close();
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
   }
-  return jstr;
 }
 
 
 /**
- * Create a new byte array.
+ * Implementation of accept.
  */
-static jbyteArray newarray(JNIEnv* env, const char* buf, size_t size) {
-  jbyteArray jbuf = env->NewByteArray(size);
-  if (!jbuf) {
-    throwoutmem(env);
-    throw std::bad_alloc();
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept
+(JNIEnv* env, jobject jself, jbyteArray jkey, jobject jvisitor, jboolean writable) {
+  try {
+    if (!jkey || !jvisitor) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftVisitor visitor(env, jvisitor, writable);
+    bool rv = db->accept(key.ptr(), key.size(), &visitor, writable);
+    jthrowable jex = visitor.exception();
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
   }
-  env->SetByteArrayRegion(jbuf, 0, size, (jbyte *)buf);
-  return jbuf;
 }
 
 
 /**
- * Convert an internal map to a Java map.
+ * Implementation of accept_bulk.
  */
-static jobject maptojhash(JNIEnv* env, const StringMap* map) {
-  jclass cls_hm = env->FindClass("java/util/HashMap");
-  jmethodID id_hm_init = env->GetMethodID(cls_hm, "<init>", "(I)V");
-  jmethodID id_hm_put = env->GetMethodID(cls_hm, "put", "(" L_OBJ L_OBJ ")" L_OBJ);
-  jobject jhash = env->NewObject(cls_hm, id_hm_init, map->size() * 2 + 1);
-  StringMap::const_iterator it = map->begin();
-  StringMap::const_iterator itend = map->end();
-  while (it != itend) {
-    jstring jkey = newstring(env, it->first.c_str());
-    jstring jvalue = newstring(env, it->second.c_str());
-    env->CallObjectMethod(jhash, id_hm_put, jkey, jvalue);
-    env->DeleteLocalRef(jkey);
-    env->DeleteLocalRef(jvalue);
-    it++;
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jobject jvisitor, jboolean writable) {
+  try {
+    if (!jkeys || !jvisitor) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    keys.reserve(knum);
+    for (size_t i = 0; i < knum; i++) {
+      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
+      if (jkey) {
+        SoftArray key(env, jkey);
+        keys.push_back(std::string(key.ptr(), key.size()));
+      }
+      env->DeleteLocalRef(jkey);
+    }
+    SoftVisitor visitor(env, jvisitor, writable);
+    bool rv = db->accept_bulk(keys, &visitor, writable);
+    jthrowable jex = visitor.exception();
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
   }
-  return jhash;
 }
 
 
 /**
- * Convert an internal vector to a Java list.
+ * Implementation of iterate.
  */
-static jobject vectortojlist(JNIEnv* env, const StringVector* vec) {
-  jclass cls_al = env->FindClass("java/util/ArrayList");
-  jmethodID id_al_init = env->GetMethodID(cls_al, "<init>", "(I)V");
-  jmethodID id_al_add = env->GetMethodID(cls_al, "add", "(" L_OBJ ")Z");
-  jobject jlist = env->NewObject(cls_al, id_al_init, vec->size());
-  StringVector::const_iterator it = vec->begin();
-  StringVector::const_iterator itend = vec->end();
-  while (it != itend) {
-    jstring jstr = newstring(env, it->c_str());
-    env->CallObjectMethod(jlist, id_al_add, jstr);
-    env->DeleteLocalRef(jstr);
-    it++;
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_iterate
+(JNIEnv* env, jobject jself, jobject jvisitor, jboolean writable) {
+  try {
+    if (!jvisitor) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftVisitor visitor(env, jvisitor, writable);
+    bool rv = db->iterate(&visitor, writable);
+    jthrowable jex = visitor.exception();
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
   }
-  return jlist;
 }
 
 
 /**
- * Convert the pointer to the internal data of a database object.
+ * Implementation of set.
  */
-static kc::PolyDB* getdbcore(JNIEnv* env, jobject jdb) {
-  jclass cls_db = env->GetObjectClass(jdb);
-  jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
-  return (kc::PolyDB*)(intptr_t)env->GetLongField(jdb, id_db_ptr);
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_set
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+  try {
+    if (!jkey || !jvalue) {
+      throwillarg(env);
+      return false;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray value(env, jvalue);
+    GroupCommitter* gcom = db->committer();
+    bool rv = gcom ? gcom->set(key.ptr(), key.size(), value.ptr(), value.size()) :
+        db->set(key.ptr(), key.size(), value.ptr(), value.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
 }
 
 
 /**
- * Throw the exception of an error code.
+ * Implementation of add.
  */
-static void throwdberror(JNIEnv* env, jobject jdb) {
-  jclass cls_db = env->GetObjectClass(jdb);
-  jfieldID id_db_exbits = env->GetFieldID(cls_db, "exbits_", "I");
-  uint32_t exbits = env->GetLongField(jdb, id_db_exbits);
-  if (exbits == 0) return;
-  kc::PolyDB* db = getdbcore(env, jdb);
-  kc::PolyDB::Error err = db->error();
-  uint32_t code = err.code();
-  if (exbits & (1 << code)) {
-    jclass cls = env->FindClass(p_err_children[code]);
-    std::string expr = kc::strprintf("%u: %s", code, err.message());
-    env->ThrowNew(cls, expr.c_str());
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_add
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+  try {
+    if (!jkey || !jvalue) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray value(env, jvalue);
+    bool rv = db->add(key.ptr(), key.size(), value.ptr(), value.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of add_bulk.
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_add_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jobjectArray jvalues, jboolean atomic) {
+  try {
+    if (!jkeys || !jvalues) {
+      throwillarg(env);
+      return NULL;
+    }
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    if ((size_t)env->GetArrayLength(jvalues) < knum || !readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return NULL;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    std::string bits((knum + 7) / 8, '\0');
+    if (atomic && !db->begin_transaction()) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    bool err = false;
+    for (size_t i = 0; i < knum; i++) {
+      jbyteArray jvalue = (jbyteArray)env->GetObjectArrayElement(jvalues, i);
+      if (!jvalue) {
+        db->set_error(_KCCODELINE_, kc::BasicDB::Error::INVALID, "invalid parameter");
+        err = true;
+        break;
+      }
+      SoftArray value(env, jvalue);
+      const std::string& key = keys[i];
+      if (db->add(key.data(), key.size(), value.ptr(), value.size())) {
+        bits[i/8] |= 1 << (i % 8);
+      } else if (atomic || db->error() != kc::BasicDB::Error::DUPREC) {
+        err = true;
+      }
+      env->DeleteLocalRef(jvalue);
+      if (err) break;
+    }
+    if (atomic && !endbulk(db, !err)) err = true;
+    if (err) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return newarray(env, bits.data(), bits.size());
+  } catch (std::exception& e) {
+    return NULL;
   }
 }
 
 
 /**
- * Convert the pointer to the internal data of a cursor object.
+ * Implementation of replace.
  */
-static SoftCursor* getcurcore(JNIEnv* env, jobject jcur) {
-  jclass cls_cur = env->GetObjectClass(jcur);
-  jfieldID id_cur_ptr = env->GetFieldID(cls_cur, "ptr_", "J");
-  return (SoftCursor*)(intptr_t)env->GetLongField(jcur, id_cur_ptr);
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_replace
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+  try {
+    if (!jkey || !jvalue) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray value(env, jvalue);
+    bool rv = db->replace(key.ptr(), key.size(), value.ptr(), value.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
 }
 
 
 /**
- * Get the inner database object of a cursor object.
+ * Implementation of append.
  */
-static jobject getcurdb(JNIEnv* env, jobject jcur) {
-  jclass cls_cur = env->GetObjectClass(jcur);
-  jfieldID id_cur_db = env->GetFieldID(cls_cur, "db_", L_DB);
-  return env->GetObjectField(jcur, id_cur_db);
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_append
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+  try {
+    if (!jkey || !jvalue) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray value(env, jvalue);
+    bool rv = db->append(key.ptr(), key.size(), value.ptr(), value.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
+  }
 }
 
 
 /**
- * Implementation of init_visitor_NOP.
+ * Implementation of increment.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Utility_init_1visitor_1NOP
-(JNIEnv* env, jclass cls) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_increment
+(JNIEnv* env, jobject jself, jbyteArray jkey, jlong num, jlong orig) {
   try {
-    char buf[kc::NUMBUFSIZ];
-    size_t size = std::sprintf(buf, "[NOP]");
-    obj_vis_nop = (jbyteArray)env->NewGlobalRef((jobject)newarray(env, buf, size));
-    return obj_vis_nop;
+    if (!jkey) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    num = db->increment(key.ptr(), key.size(), num, orig);
+    if (num == kc::INT64MIN) throwdberror(env, jself);
+    return num;
   } catch (std::exception& e) {
-    return NULL;
+    return 0;
   }
 }
 
 
 /**
- * Implementation of init_visitor_REMOVE.
+ * Implementation of increment_double.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Utility_init_1visitor_1REMOVE
-(JNIEnv* env, jclass cls) {
+JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_increment_1double
+(JNIEnv* env, jobject jself, jbyteArray jkey, jdouble num, jdouble orig) {
   try {
-    char buf[kc::NUMBUFSIZ];
-    size_t size = std::sprintf(buf, "[REMOVE]");
-    obj_vis_remove = (jbyteArray)env->NewGlobalRef((jobject)newarray(env, buf, size));
-    return obj_vis_remove;
+    if (!jkey) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    num = db->increment_double(key.ptr(), key.size(), num, orig);
+    if (kc::chknan(num)) throwdberror(env, jself);
+    return num;
   } catch (std::exception& e) {
-    return NULL;
+    return 0;
   }
 }
 
 
 /**
- * Implementation of atoi.
+ * Implementation of increment_bulk.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_atoi
-(JNIEnv* env, jclass cls, jstring jstr) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_increment_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jlongArray jnums, jlongArray jresults,
+ jlong orig, jboolean atomic) {
   try {
-    if (!jstr) {
+    if (!jkeys || !jnums) {
       throwillarg(env);
-      return 0;
+      return false;
     }
-    SoftString str(env, jstr);
-    return kc::atoi(str.str());
+    size_t knum = env->GetArrayLength(jkeys);
+    if ((size_t)env->GetArrayLength(jnums) < knum ||
+        (jresults && (size_t)env->GetArrayLength(jresults) < knum)) {
+      throwillarg(env);
+      return false;
+    }
+    StringVector keys;
+    if (!readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return false;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    std::vector<jlong> nums(knum + 1);
+    env->GetLongArrayRegion(jnums, 0, knum, &nums[0]);
+    if (atomic && !db->begin_transaction()) {
+      throwdberror(env, jself);
+      return false;
+    }
+    bool err = false;
+    for (size_t i = 0; i < knum; i++) {
+      const std::string& key = keys[i];
+      nums[i] = db->increment(key.data(), key.size(), nums[i], orig);
+      if (nums[i] == kc::INT64MIN) {
+        err = true;
+        break;
+      }
+    }
+    if (atomic && !endbulk(db, !err)) err = true;
+    if (err) {
+      throwdberror(env, jself);
+      return false;
+    }
+    if (jresults) env->SetLongArrayRegion(jresults, 0, knum, &nums[0]);
+    return true;
   } catch (std::exception& e) {
-    return 0;
+    return false;
   }
 }
 
 
 /**
- * Implementation of atoix.
+ * Implementation of increment_double_bulk.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_atoix
-(JNIEnv* env, jclass cls, jstring jstr) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_increment_1double_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jdoubleArray jnums, jdoubleArray jresults,
+ jdouble orig, jboolean atomic) {
   try {
-    if (!jstr) {
+    if (!jkeys || !jnums) {
       throwillarg(env);
-      return 0;
+      return false;
     }
-    SoftString str(env, jstr);
-    return kc::atoix(str.str());
+    size_t knum = env->GetArrayLength(jkeys);
+    if ((size_t)env->GetArrayLength(jnums) < knum ||
+        (jresults && (size_t)env->GetArrayLength(jresults) < knum)) {
+      throwillarg(env);
+      return false;
+    }
+    StringVector keys;
+    if (!readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return false;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    std::vector<jdouble> nums(knum + 1);
+    env->GetDoubleArrayRegion(jnums, 0, knum, &nums[0]);
+    if (atomic && !db->begin_transaction()) {
+      throwdberror(env, jself);
+      return false;
+    }
+    bool err = false;
+    for (size_t i = 0; i < knum; i++) {
+      const std::string& key = keys[i];
+      nums[i] = db->increment_double(key.data(), key.size(), nums[i], orig);
+      if (kc::chknan(nums[i])) {
+        err = true;
+        break;
+      }
+    }
+    if (atomic && !endbulk(db, !err)) err = true;
+    if (err) {
+      throwdberror(env, jself);
+      return false;
+    }
+    if (jresults) env->SetDoubleArrayRegion(jresults, 0, knum, &nums[0]);
+    return true;
   } catch (std::exception& e) {
-    return 0;
+    return false;
   }
 }
 
 
 /**
- * Implementation of atof.
+ * Implementation of merge_value.
  */
-JNIEXPORT jdouble JNICALL Java_kyotocabinet_Utility_atof
-(JNIEnv* env, jclass cls, jstring jstr) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge_1value
+(JNIEnv* env, jobject jself, jbyteArray jkey, jint op, jbyteArray joperand, jlong limit) {
   try {
-    if (!jstr) {
+    if (!jkey || !joperand || !MergeVisitor::valid(op)) {
       throwillarg(env);
-      return 0;
+      return false;
     }
-    SoftString str(env, jstr);
-    return kc::atof(str.str());
+    SoftDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray operand(env, joperand);
+    MergeVisitor visitor(op, limit);
+    visitor.push(key.ptr(), key.size(), operand.ptr(), operand.size());
+    bool rv = db->accept(key.ptr(), key.size(), &visitor, true);
+    if (rv && visitor.failed()) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "logical inconsistency");
+      rv = false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return 0;
+    return false;
   }
 }
 
 
 /**
- * Implementation of hash_murmur.
+ * Implementation of merge_value_bulk.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_hash_1murmur
-(JNIEnv* env, jclass cls, jbyteArray jary) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_merge_1value_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jrecs, jint op, jlong limit, jboolean atomic) {
   try {
-    if (!jary) {
+    if (!jrecs || !MergeVisitor::valid(op)) {
       throwillarg(env);
-      return 0;
+      return -1;
     }
-    SoftArray ary(env, jary);
-    return kc::hashmurmur(ary.ptr(), ary.size());
+    SoftDB* db = getdbcore(env, jself);
+    size_t rnum = env->GetArrayLength(jrecs);
+    MergeVisitor visitor(op, limit);
+    StringVector keys;
+    keys.reserve(rnum / 2);
+    for (size_t i = 0; i + 1 < rnum; i += 2) {
+      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jrecs, i);
+      jbyteArray joperand = (jbyteArray)env->GetObjectArrayElement(jrecs, i + 1);
+      if (jkey && joperand) {
+        SoftArray key(env, jkey);
+        SoftArray operand(env, joperand);
+        visitor.push(key.ptr(), key.size(), operand.ptr(), operand.size());
+        keys.push_back(std::string(key.ptr(), key.size()));
+      }
+      env->DeleteLocalRef(jkey);
+      env->DeleteLocalRef(joperand);
+    }
+    if (!visitor.valid()) {
+      throwillarg(env);
+      return -1;
+    }
+    bool rv = true;
+    if (atomic) {
+      if (!db->begin_transaction()) {
+        throwdberror(env, jself);
+        return -1;
+      }
+      rv = db->accept_bulk(keys, &visitor, true);
+      if (rv && visitor.failed()) {
+        db->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "logical inconsistency");
+        rv = false;
+      }
+      if (!endbulk(db, rv)) rv = false;
+    } else {
+      StringVector::iterator it = keys.begin();
+      StringVector::iterator itend = keys.end();
+      while (rv && !visitor.failed() && it != itend) {
+        rv = db->accept(it->data(), it->size(), &visitor, true);
+        ++it;
+      }
+    }
+    if (rv && visitor.failed()) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::LOGIC, "logical inconsistency");
+      rv = false;
+    }
+    if (!rv) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return visitor.num();
   } catch (std::exception& e) {
-    return 0;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of hash_fnv.
+ * Implementation of cas.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_hash_1fnv
-(JNIEnv* env, jclass cls, jbyteArray jary) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_cas
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray joval, jbyteArray jnval) {
   try {
-    if (!jary) {
+    if (!jkey) {
       throwillarg(env);
-      return 0;
+      return false;
     }
-    SoftArray ary(env, jary);
-    return kc::hashfnv(ary.ptr(), ary.size());
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    SoftArray oval(env, joval);
+    SoftArray nval(env, jnval);
+    bool rv = db->cas(key.ptr(), key.size(), oval.ptr(), oval.size(), nval.ptr(), nval.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return 0;
+    return false;
   }
 }
 
 
 /**
- * Implementation of levdist.
+ * Implementation of cas_bulk.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_levdist___3B_3B
-(JNIEnv* env, jclass cls, jbyteArray ja, jbyteArray jb) {
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_cas_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jobjectArray jovals, jobjectArray jnvals,
+ jboolean atomic) {
   try {
-    if (!ja || !jb) {
+    if (!jkeys || !jovals || !jnvals) {
       throwillarg(env);
-      return 0;
+      return NULL;
     }
-    SoftArray aary(env, ja);
-    SoftArray bary(env, jb);
-    return kc::memdist(aary.ptr(), aary.size(), bary.ptr(), bary.size());
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    if ((size_t)env->GetArrayLength(jovals) < knum ||
+        (size_t)env->GetArrayLength(jnvals) < knum || !readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return NULL;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    std::string bits((knum + 7) / 8, '\0');
+    if (atomic && !db->begin_transaction()) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    bool err = false;
+    for (size_t i = 0; i < knum; i++) {
+      jbyteArray joval = (jbyteArray)env->GetObjectArrayElement(jovals, i);
+      jbyteArray jnval = (jbyteArray)env->GetObjectArrayElement(jnvals, i);
+      {
+        SoftArray oval(env, joval);
+        SoftArray nval(env, jnval);
+        const std::string& key = keys[i];
+        if (db->cas(key.data(), key.size(), oval.ptr(), oval.size(), nval.ptr(), nval.size())) {
+          bits[i/8] |= 1 << (i % 8);
+        } else if (atomic || db->error() != kc::BasicDB::Error::LOGIC) {
+          err = true;
+        }
+      }
+      env->DeleteLocalRef(joval);
+      env->DeleteLocalRef(jnval);
+      if (err) break;
+    }
+    if (atomic && !endbulk(db, !err)) err = true;
+    if (err) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return newarray(env, bits.data(), bits.size());
   } catch (std::exception& e) {
-    return 0;
+    return NULL;
   }
 }
 
 
 /**
- * Implementation of levdist.
+ * Implementation of remove.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_Utility_levdist__Ljava_lang_String_2Ljava_lang_String_2
-(JNIEnv* env, jclass cls, jstring ja, jstring jb) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_remove
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
   try {
-    if (!ja || !jb) {
+    if (!jkey) {
       throwillarg(env);
-      return 0;
+      return false;
     }
-    SoftString astr(env, ja);
-    SoftString bstr(env, jb);
-    return kc::strutfdist(astr.str(), bstr.str());
+    SoftDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    GroupCommitter* gcom = db->committer();
+    bool rv = gcom ? gcom->remove(key.ptr(), key.size()) : db->remove(key.ptr(), key.size());
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return 0;
-  }
-}
-
-
-/**
- * Implementation of remove_recursively.
- */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Utility_remove_1files_1recursively
-(JNIEnv* env, jclass cls, jstring jpath) {
-  if (!jpath) {
-    throwillarg(env);
     return false;
   }
-  SoftString path(env, jpath);
-  return kc::File::remove_recursively(path.str());
 }
 
 
 /**
- * Implementation of version.
+ * Implementation of get.
  */
-JNIEXPORT jstring JNICALL Java_kyotocabinet_Utility_version
-(JNIEnv* env, jclass cls) {
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_get
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
   try {
-    return newstring(env, kc::VERSION);
+    if (!jkey) {
+      throwillarg(env);
+      return NULL;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    size_t vsiz;
+    char* vbuf = db->get(key.ptr(), key.size(), &vsiz);
+    if (!vbuf) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    jbyteArray jvalue = newarray(env, vbuf, vsiz);
+    delete[] vbuf;
+    return jvalue;
   } catch (std::exception& e) {
     return NULL;
   }
@@ -810,209 +7702,343 @@ JNIEXPORT jstring JNICALL Java_kyotocabinet_Utility_version
 
 
 /**
- * Implementation of codename.
+ * Implementation of check.
  */
-JNIEXPORT jstring JNICALL Java_kyotocabinet_Error_codename
-(JNIEnv* env, jclass cls, jint code) {
+JNIEXPORT jint JNICALL Java_kyotocabinet_DB_check
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
   try {
-    return newstring(env, kc::PolyDB::Error::codename((kyotocabinet::PolyDB::Error::Code)code));
+    if (!jkey) {
+      throwillarg(env);
+      return -1;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    int32_t vsiz = db->check(key.ptr(), key.size());
+    if (vsiz < 0) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return vsiz;
   } catch (std::exception& e) {
-    return NULL;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of disable.
+ * Implementation of check_bulk.
  */
-JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_disable
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_check_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jintArray jsizes) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return;
-    cur->disable();
-  } catch (std::exception& e) {}
+    if (!jkeys) {
+      throwillarg(env);
+      return -1;
+    }
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    if ((jsizes && (size_t)env->GetArrayLength(jsizes) < knum) || !readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return -1;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    std::vector<jint> sizes(knum + 1);
+    int64_t hnum = 0;
+    for (size_t i = 0; i < knum; i++) {
+      const std::string& key = keys[i];
+      sizes[i] = db->check(key.data(), key.size());
+      if (sizes[i] >= 0) {
+        hnum++;
+      } else if (db->error() != kc::BasicDB::Error::NOREC) {
+        throwdberror(env, jself);
+        return -1;
+      }
+    }
+    if (jsizes) env->SetIntArrayRegion(jsizes, 0, knum, &sizes[0]);
+    return hnum;
+  } catch (std::exception& e) {
+    return -1;
+  }
 }
 
 
 /**
- * Implementation of accept.
+ * Implementation of contains_bulk.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_accept
-(JNIEnv* env, jobject jself, jobject jvisitor, jboolean writable, jboolean step) {
+JNIEXPORT jlongArray JNICALL Java_kyotocabinet_DB_contains_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys) {
   try {
-    if (!jvisitor) {
+    if (!jkeys) {
       throwillarg(env);
-      return false;
+      return NULL;
     }
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    SoftVisitor visitor(env, jvisitor, writable);
-    bool rv = icur->accept(&visitor, writable, step);
-    jthrowable jex = visitor.exception();
-    if (jex) {
-      env->Throw(jex);
-      return false;
+    StringVector keys;
+    if (!readkeys(env, jkeys, &keys)) {
+      throwillarg(env);
+      return NULL;
     }
-    if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
-    return false;
+    SoftDB* db = getdbcore(env, jself);
+    size_t knum = keys.size();
+    size_t wnum = (knum + 63) / 64;
+    std::vector<jlong> words(wnum + 1, 0);
+    for (size_t i = 0; i < knum; i++) {
+      const std::string& key = keys[i];
+      if (db->check(key.data(), key.size()) >= 0) {
+        words[i/64] |= (jlong)((uint64_t)1 << (i % 64));
+      } else if (db->error() != kc::BasicDB::Error::NOREC) {
+        throwdberror(env, jself);
+        return NULL;
+      }
+    }
+    jlongArray jwords = env->NewLongArray(wnum);
+    if (!jwords) {
+      throwoutmem(env);
+      throw std::bad_alloc();
+    }
+    env->SetLongArrayRegion(jwords, 0, wnum, &words[0]);
+    return jwords;
   } catch (std::exception& e) {
-    return false;
+    return NULL;
   }
 }
 
 
 /**
- * Implementation of set_value.
+ * Implementation of seize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_set_1value
-(JNIEnv* env, jobject jself, jbyteArray jvalue, jboolean step) {
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_seize
+(JNIEnv* env, jobject jself, jbyteArray jkey) {
   try {
-    if (!jvalue) {
+    if (!jkey) {
       throwillarg(env);
-      return false;
+      return NULL;
     }
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    SoftArray value(env, jvalue);
-    bool rv = icur->set_value(value.ptr(), value.size(), step);
-    if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
-    return false;
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray key(env, jkey);
+    size_t vsiz;
+    char* vbuf = db->seize(key.ptr(), key.size(), &vsiz);
+    if (!vbuf) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    jbyteArray jvalue = newarray(env, vbuf, vsiz);
+    delete[] vbuf;
+    return jvalue;
   } catch (std::exception& e) {
-    return false;
+    return NULL;
   }
 }
 
 
 /**
- * Implementation of remove.
+ * Implementation of set_bulk.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_remove
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_set_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jrecs, jboolean atomic) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    bool rv = icur->remove();
-    if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
-    return false;
+    if (!jrecs) {
+      throwillarg(env);
+      return -1;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    size_t rnum = env->GetArrayLength(jrecs);
+    StringMap recs;
+    for (size_t i = 0; i + 1 < rnum; i += 2) {
+      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jrecs, i);
+      jbyteArray jvalue = (jbyteArray)env->GetObjectArrayElement(jrecs, i + 1);
+      if (jkey && jvalue) {
+        SoftArray key(env, jkey);
+        SoftArray value(env, jvalue);
+        recs[std::string(key.ptr(), key.size())] = std::string(value.ptr(), value.size());
+      }
+      env->DeleteLocalRef(jkey);
+      env->DeleteLocalRef(jvalue);
+    }
+    GroupCommitter* gcom = db->committer();
+    int64_t rv = gcom ? gcom->set_bulk(recs) : db->set_bulk(recs, atomic);
+    if (rv < 0) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return rv;
   } catch (std::exception& e) {
-    return false;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of get_key.
+ * Implementation of remove_bulk.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Cursor_get_1key
-(JNIEnv* env, jobject jself, jboolean step) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jboolean atomic) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return NULL;
-    size_t ksiz;
-    char* kbuf = icur->get_key(&ksiz, step);
-    if (!kbuf) {
-      throwdberror(env, getcurdb(env, jself));
-      return NULL;
+    if (!jkeys) {
+      throwillarg(env);
+      return -1;
     }
-    jbyteArray jkey = newarray(env, kbuf, ksiz);
-    delete[] kbuf;
-    return jkey;
+    SoftDB* db = getdbcore(env, jself);
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    keys.reserve(knum);
+    for (size_t i = 0; i < knum; i++) {
+      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
+      if (jkey) {
+        SoftArray key(env, jkey);
+        keys.push_back(std::string(key.ptr(), key.size()));
+      }
+      env->DeleteLocalRef(jkey);
+    }
+    GroupCommitter* gcom = db->committer();
+    int64_t rv = gcom ? gcom->remove_bulk(keys) : db->remove_bulk(keys, atomic);
+    if (rv < 0) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return rv;
   } catch (std::exception& e) {
-    return NULL;
+    return (jlong)NULL;
   }
 }
 
 
 /**
- * Implementation of get_value.
+ * Implementation of remove_prefix.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_Cursor_get_1value
-(JNIEnv* env, jobject jself, jboolean step) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1prefix
+(JNIEnv* env, jobject jself, jbyteArray jprefix, jlong unit, jdouble pause) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return NULL;
-    size_t vsiz;
-    char* vbuf = icur->get_value(&vsiz, step);
-    if (!vbuf) {
-      throwdberror(env, getcurdb(env, jself));
-      return NULL;
+    if (!jprefix) {
+      throwillarg(env);
+      return -1;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray prefix(env, jprefix);
+    std::string bstr(prefix.ptr(), prefix.size());
+    std::string estr;
+    bool bounded = RangeUpdater::successor(bstr, &estr);
+    TransformVisitor visitor(TransformVisitor::TREMOVE, 0, 0, "");
+    RangeUpdater updater(db, &bstr, bounded ? &estr : NULL, &visitor, unit, pause, NULL);
+    if (!updater.execute()) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return visitor.count();
+  } catch (std::exception& e) {
+    return -1;
+  }
+}
+
+
+/**
+ * Implementation of remove_range.
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1range
+(JNIEnv* env, jobject jself, jbyteArray jbegin, jbyteArray jend, jlong unit, jdouble pause) {
+  try {
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray begin(env, jbegin);
+    SoftArray end(env, jend);
+    std::string bstr, estr;
+    if (jbegin) bstr.assign(begin.ptr(), begin.size());
+    if (jend) estr.assign(end.ptr(), end.size());
+    TransformVisitor visitor(TransformVisitor::TREMOVE, 0, 0, "");
+    RangeUpdater updater(db, jbegin ? &bstr : NULL, jend ? &estr : NULL, &visitor, unit, pause,
+                         NULL);
+    if (!updater.execute()) {
+      throwdberror(env, jself);
+      return -1;
     }
-    jbyteArray jvalue = newarray(env, vbuf, vsiz);
-    delete[] vbuf;
-    return jvalue;
+    return visitor.count();
   } catch (std::exception& e) {
-    return NULL;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of get.
+ * Implementation of update_where.
  */
-JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_Cursor_get
-(JNIEnv* env, jobject jself, jboolean step) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_update_1where
+(JNIEnv* env, jobject jself, jbyteArray jbegin, jbyteArray jend, jint op, jlong pos, jlong num,
+ jbyteArray jdata, jlong unit, jobject jchecker) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return NULL;
-    const char* vbuf;
-    size_t ksiz, vsiz;
-    char* kbuf = icur->get(&ksiz, &vbuf, &vsiz, step);
-    if (!kbuf) {
-      throwdberror(env, getcurdb(env, jself));
-      return NULL;
+    if (!TransformVisitor::valid(op)) {
+      throwillarg(env);
+      return -1;
     }
-    jbyteArray jkey = newarray(env, kbuf, ksiz);
-    jbyteArray jvalue = newarray(env, vbuf, vsiz);
-    delete[] kbuf;
-    jclass cls_byteary = env->FindClass("[B");
-    jobjectArray jrec = env->NewObjectArray(2, cls_byteary, NULL);
-    env->SetObjectArrayElement(jrec, 0, jkey);
-    env->SetObjectArrayElement(jrec, 1, jvalue);
-    env->DeleteLocalRef(jkey);
-    env->DeleteLocalRef(jvalue);
-    return jrec;
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftArray begin(env, jbegin);
+    SoftArray end(env, jend);
+    SoftArray data(env, jdata);
+    std::string bstr, estr, dstr;
+    if (jbegin) bstr.assign(begin.ptr(), begin.size());
+    if (jend) estr.assign(end.ptr(), end.size());
+    if (jdata) dstr.assign(data.ptr(), data.size());
+    TransformVisitor visitor(op, pos, num, dstr);
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    RangeUpdater updater(db, jbegin ? &bstr : NULL, jend ? &estr : NULL, &visitor, unit, 0,
+                         checker);
+    bool rv = updater.execute();
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
+    if (jex) {
+      env->Throw(jex);
+      return -1;
+    }
+    if (!rv) {
+      throwdberror(env, jself);
+      return -1;
+    }
+    return visitor.count();
   } catch (std::exception& e) {
-    return NULL;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of seize.
+ * Implementation of get_bulk.
  */
-JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_Cursor_seize
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_DB_get_1bulk
+(JNIEnv* env, jobject jself, jobjectArray jkeys, jboolean atomic) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return NULL;
-    const char* vbuf;
-    size_t ksiz, vsiz;
-    char* kbuf = icur->seize(&ksiz, &vbuf, &vsiz);
-    if (!kbuf) {
-      throwdberror(env, getcurdb(env, jself));
+    if (!jkeys) {
+      throwillarg(env);
       return NULL;
     }
-    jbyteArray jkey = newarray(env, kbuf, ksiz);
-    jbyteArray jvalue = newarray(env, vbuf, vsiz);
-    delete[] kbuf;
+    kc::PolyDB* db = getdbcore(env, jself);
+    size_t knum = env->GetArrayLength(jkeys);
+    StringVector keys;
+    keys.reserve(knum);
+    for (size_t i = 0; i < knum; i++) {
+      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
+      if (jkey) {
+        SoftArray key(env, jkey);
+        keys.push_back(std::string(key.ptr(), key.size()));
+      }
+      env->DeleteLocalRef(jkey);
+    }
+    StringMap recs;
+    if (db->get_bulk(keys, &recs, atomic) < 0) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    size_t rnum = recs.size();
     jclass cls_byteary = env->FindClass("[B");
-    jobjectArray jrec = env->NewObjectArray(2, cls_byteary, NULL);
-    env->SetObjectArrayElement(jrec, 0, jkey);
-    env->SetObjectArrayElement(jrec, 1, jvalue);
-    env->DeleteLocalRef(jkey);
-    env->DeleteLocalRef(jvalue);
+    jobjectArray jrec = env->NewObjectArray(rnum * 2, cls_byteary, NULL);
+    StringMap::iterator it = recs.begin();
+    StringMap::iterator itend = recs.end();
+    size_t ridx = 0;
+    while (it != itend) {
+      jbyteArray jkey = newarray(env, it->first.data(), it->first.size());
+      jbyteArray jvalue = newarray(env, it->second.data(), it->second.size());
+      env->SetObjectArrayElement(jrec, ridx++, jkey);
+      env->SetObjectArrayElement(jrec, ridx++, jvalue);
+      env->DeleteLocalRef(jkey);
+      env->DeleteLocalRef(jvalue);
+      it++;
+    }
     return jrec;
   } catch (std::exception& e) {
     return NULL;
@@ -1021,17 +8047,15 @@ JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_Cursor_seize
 
 
 /**
- * Implementation of jump.
+ * Implementation of clear.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump__
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_clear
 (JNIEnv* env, jobject jself) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    bool rv = icur->jump();
+    kc::PolyDB* db = getdbcore(env, jself);
+    bool rv = db->clear();
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1040,22 +8064,22 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump__
 
 
 /**
- * Implementation of jump.
+ * Implementation of synchronize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump___3B
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_synchronize
+(JNIEnv* env, jobject jself, jboolean hard, jobject jproc) {
   try {
-    if (!jkey) {
-      throwillarg(env);
+    kc::PolyDB* db = getdbcore(env, jself);
+    if (!jproc) return db->synchronize(hard);
+    SoftFileProcessor proc(env, jproc);
+    bool rv = db->synchronize(hard, &proc);
+    jthrowable jex = proc.exception();
+    if (jex) {
+      env->Throw(jex);
       return false;
     }
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    SoftArray key(env, jkey);
-    bool rv = icur->jump(key.ptr(), key.size());
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1064,17 +8088,22 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump___3B
 
 
 /**
- * Implementation of jump_back.
+ * Implementation of occupy.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back__
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_occupy
+(JNIEnv* env, jobject jself, jboolean writable, jobject jproc) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    bool rv = icur->jump_back();
+    kc::PolyDB* db = getdbcore(env, jself);
+    if (!jproc) return db->occupy(writable);
+    SoftFileProcessor proc(env, jproc);
+    bool rv = db->occupy(writable, &proc);
+    jthrowable jex = proc.exception();
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1083,22 +8112,20 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back__
 
 
 /**
- * Implementation of jump_back.
+ * Implementation of copy.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back___3B
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_copy
+(JNIEnv* env, jobject jself, jstring jdest) {
   try {
-    if (!jkey) {
+    if (!jdest) {
       throwillarg(env);
       return false;
     }
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    SoftArray key(env, jkey);
-    bool rv = icur->jump_back(key.ptr(), key.size());
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftString dest(env, jdest);
+    bool rv = db->copy(dest.str());
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1107,17 +8134,15 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_jump_1back___3B
 
 
 /**
- * Implementation of step.
+ * Implementation of begin_trnasaction.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_begin_1transaction
+(JNIEnv* env, jobject jself, jboolean hard) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    bool rv = icur->step();
+    kc::PolyDB* db = getdbcore(env, jself);
+    bool rv = db->begin_transaction(hard);
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1126,17 +8151,15 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step
 
 
 /**
- * Implementation of step_back.
+ * Implementation of end_transaction.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step_1back
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_end_1transaction
+(JNIEnv* env, jobject jself, jboolean commit) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return false;
-    bool rv = icur->step_back();
+    kc::PolyDB* db = getdbcore(env, jself);
+    bool rv = db->end_transaction(commit);
     if (rv) return true;
-    throwdberror(env, getcurdb(env, jself));
+    throwdberror(env, jself);
     return false;
   } catch (std::exception& e) {
     return false;
@@ -1145,149 +8168,222 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_Cursor_step_1back
 
 
 /**
- * Implementation of error.
+ * Implementation of dump_snapshot.
  */
-JNIEXPORT jthrowable JNICALL Java_kyotocabinet_Cursor_error
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_dump_1snapshot
+(JNIEnv* env, jobject jself, jstring jdest, jstring jcodec, jobject jchecker) {
   try {
-    jclass cls_err = env->FindClass(P_ERR);
-    jmethodID id_err_init = env->GetMethodID(cls_err, "<init>", "(I" L_STR ")V");
-    SoftCursor* cur = getcurcore(env, jself);
-    kc::PolyDB::Cursor* icur = cur->cur();
-    if (!icur) return NULL;
-    kc::PolyDB::Error err = cur->cur()->error();
-    jstring jmessage = newstring(env, err.message());
-    jobject jerr = env->NewObject(cls_err, id_err_init, err.code(), jmessage);
-    env->DeleteLocalRef(jmessage);
-    return (jthrowable)jerr;
+    if (!jdest) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftString dest(env, jdest);
+    SoftString codec(env, jcodec);
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    bool rv = dumpsnapshot(db, dest.str(), codec.str() ? codec.str() : "", checker);
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return NULL;
+    return false;
+  }
+}
+
+
+/**
+ * Implementation of load_snapshot.
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_load_1snapshot
+(JNIEnv* env, jobject jself, jstring jsrc, jobject jchecker) {
+  try {
+    if (!jsrc) {
+      throwillarg(env);
+      return false;
+    }
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftString src(env, jsrc);
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    bool rv = loadsnapshot(db, src.str(), checker);
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
+  } catch (std::exception& e) {
+    return false;
   }
 }
 
 
 /**
- * Implementation of db.
+ * Implementation of count.
  */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_Cursor_db
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_count
 (JNIEnv* env, jobject jself) {
   try {
-    return getcurdb(env, jself);
+    kc::PolyDB* db = getdbcore(env, jself);
+    int64_t count = db->count();
+    if (count < 0) throwdberror(env, jself);
+    return count;
   } catch (std::exception& e) {
-    return NULL;
+    return 0;
   }
 }
 
 
 /**
- * Implementation of initialize.
+ * Implementation of size.
  */
-JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_initialize
-(JNIEnv* env, jobject jself, jobject jdb) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_size
+(JNIEnv* env, jobject jself) {
   try {
-    if (!jdb) {
-      throwillarg(env);
-      return;
-    }
-    jclass cls_cur = env->GetObjectClass(jself);
-    jfieldID id_cur_ptr = env->GetFieldID(cls_cur, "ptr_", "J");
-    jfieldID id_cur_db = env->GetFieldID(cls_cur, "db_", L_DB);
-    kc::PolyDB* db = getdbcore(env, jdb);
-    g_curbur.sweap();
-    SoftCursor* cur = new SoftCursor(db);
-    env->SetLongField(jself, id_cur_ptr, (intptr_t)cur);
-    env->SetObjectField(jself, id_cur_db, jdb);
-  } catch (std::exception& e) {}
+    kc::PolyDB* db = getdbcore(env, jself);
+    int64_t size = db->size();
+    if (size < 0) throwdberror(env, jself);
+    return size;
+  } catch (std::exception& e) {
+    return 0;
+  }
 }
 
 
 /**
- * Implementation of destruct.
+ * Implementation of path.
  */
-JNIEXPORT void JNICALL Java_kyotocabinet_Cursor_destruct
+JNIEXPORT jstring JNICALL Java_kyotocabinet_DB_path
 (JNIEnv* env, jobject jself) {
   try {
-    SoftCursor* cur = getcurcore(env, jself);
-    delete cur;
-  } catch (std::exception& e) {}
+    kc::PolyDB* db = getdbcore(env, jself);
+    std::string path = db->path().c_str();
+    if (path.empty()) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return newstring(env, path.c_str());
+  } catch (std::exception& e) {
+    return NULL;
+  }
 }
 
 
 /**
- * Implementation of error.
+ * Implementation of status.
  */
-JNIEXPORT jthrowable JNICALL Java_kyotocabinet_DB_error
+JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_status
 (JNIEnv* env, jobject jself) {
   try {
-    jclass cls_err = env->FindClass(P_ERR);
-    jmethodID id_err_init = env->GetMethodID(cls_err, "<init>", "(I" L_STR ")V");
     kc::PolyDB* db = getdbcore(env, jself);
-    kc::PolyDB::Error err = db->error();
-    jstring jmessage = newstring(env, err.message());
-    jobject jerr = env->NewObject(cls_err, id_err_init, err.code(), jmessage);
-    env->DeleteLocalRef(jmessage);
-    return (jthrowable)jerr;
+    StringMap status;
+    if (!db->status(&status)) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return maptojhash(env, &status);
   } catch (std::exception& e) {
     return NULL;
   }
 }
 
 
-/**
- * Implementation of open.
+/*
+ * Implementation of match_prefix.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_open
-(JNIEnv* env, jobject jself, jstring jpath, jint mode) {
+JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1prefix
+(JNIEnv* env, jobject jself, jstring jprefix, jlong max) {
   try {
-    if (!jpath) {
-      throwillarg(env);
-      return false;
+    kc::PolyDB* db = getdbcore(env, jself);
+    SoftString prefix(env, jprefix);
+    StringVector keys;
+    if (db->match_prefix(prefix.str(), &keys, max) == -1) {
+      throwdberror(env, jself);
+      return NULL;
     }
+    return vectortojlist(env, &keys);
+  } catch (std::exception& e) {
+    return NULL;
+  }
+}
+
+
+/*
+ * Implementation of match_regex.
+ */
+JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1regex
+(JNIEnv* env, jobject jself, jstring jregex, jlong max) {
+  try {
     kc::PolyDB* db = getdbcore(env, jself);
-    SoftString path(env, jpath);
-    bool rv = db->open(path.str(), mode);
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    SoftString regex(env, jregex);
+    StringVector keys;
+    if (db->match_regex(regex.str(), &keys, max) == -1) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return vectortojlist(env, &keys);
   } catch (std::exception& e) {
-    return false;
+    return NULL;
   }
 }
 
 
-/**
- * Implementation of close.
+/*
+ * Implementation of match_similar.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_close
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1similar
+(JNIEnv* env, jobject jself, jstring jorigin, jlong range, jboolean utf, jlong max) {
   try {
     kc::PolyDB* db = getdbcore(env, jself);
-    g_curbur.sweap();
-    bool rv = db->close();
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    SoftString origin(env, jorigin);
+    StringVector keys;
+    if (db->match_similar(origin.str(), range, utf, &keys, max) == -1) {
+      throwdberror(env, jself);
+      return NULL;
+    }
+    return vectortojlist(env, &keys);
   } catch (std::exception& e) {
-    return false;
+    return NULL;
   }
 }
 
 
 /**
- * Implementation of accept.
+ * Implementation of merge.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept
-(JNIEnv* env, jobject jself, jbyteArray jkey, jobject jvisitor, jboolean writable) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge
+(JNIEnv* env, jobject jself, jobjectArray jsrcary, jint mode, jobject jchecker) {
   try {
-    if (!jkey || !jvisitor) {
+    if (!jsrcary) {
       throwillarg(env);
       return false;
     }
     kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftVisitor visitor(env, jvisitor, writable);
-    bool rv = db->accept(key.ptr(), key.size(), &visitor, writable);
-    jthrowable jex = visitor.exception();
+    size_t srcnum = env->GetArrayLength(jsrcary);
+    if (srcnum < 1) return true;
+    kc::BasicDB** srcary = new kc::BasicDB*[srcnum];
+    for (size_t i = 0; i < srcnum; i++) {
+      jobject jsrcdb = env->GetObjectArrayElement(jsrcary, i);
+      if (!jsrcdb) {
+        delete[] srcary;
+        return false;
+      }
+      srcary[i] = getdbcore(env, jsrcdb);
+    }
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    ParallelMerger merger(db, srcary, srcnum, (kc::PolyDB::MergeMode)mode, checker);
+    bool rv = merger.execute();
+    delete[] srcary;
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
     if (jex) {
       env->Throw(jex);
       return false;
@@ -1302,30 +8398,27 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept
 
 
 /**
- * Implementation of accept_bulk.
+ * Implementation of bulk_load.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept_1bulk
-(JNIEnv* env, jobject jself, jobjectArray jkeys, jobject jvisitor, jboolean writable) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_bulk_1load
+(JNIEnv* env, jobject jself, jstring jsrc, jstring jtmpdir, jint thnum, jobject jchecker) {
   try {
-    if (!jkeys || !jvisitor) {
+    if (!jsrc) {
       throwillarg(env);
       return false;
     }
     kc::PolyDB* db = getdbcore(env, jself);
-    size_t knum = env->GetArrayLength(jkeys);
-    StringVector keys;
-    keys.reserve(knum);
-    for (size_t i = 0; i < knum; i++) {
-      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
-      if (jkey) {
-        SoftArray key(env, jkey);
-        keys.push_back(std::string(key.ptr(), key.size()));
-      }
-      env->DeleteLocalRef(jkey);
+    SoftString src(env, jsrc);
+    SoftString tmpdir(env, jtmpdir);
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    bool rv;
+    {
+      BulkLoader loader(db, src.str(), tmpdir.str() ? tmpdir.str() : "",
+                        thnum > 0 ? thnum : 1, checker);
+      rv = loader.execute();
     }
-    SoftVisitor visitor(env, jvisitor, writable);
-    bool rv = db->accept_bulk(keys, &visitor, writable);
-    jthrowable jex = visitor.exception();
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
     if (jex) {
       env->Throw(jex);
       return false;
@@ -1340,19 +8433,27 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_accept_1bulk
 
 
 /**
- * Implementation of iterate.
+ * Implementation of import_file.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_iterate
-(JNIEnv* env, jobject jself, jobject jvisitor, jboolean writable) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_import_1file
+(JNIEnv* env, jobject jself, jstring jpath, jint format, jint thnum, jint batch,
+ jobject jchecker) {
   try {
-    if (!jvisitor) {
+    if (!jpath) {
       throwillarg(env);
       return false;
     }
     kc::PolyDB* db = getdbcore(env, jself);
-    SoftVisitor visitor(env, jvisitor, writable);
-    bool rv = db->iterate(&visitor, writable);
-    jthrowable jex = visitor.exception();
+    SoftString path(env, jpath);
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    bool rv;
+    {
+      FileImporter importer(db, path.str(), format, thnum > 0 ? thnum : 1,
+                            batch > 0 ? batch : 1, checker);
+      rv = importer.execute();
+    }
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
     if (jex) {
       env->Throw(jex);
       return false;
@@ -1367,19 +8468,33 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_iterate
 
 
 /**
- * Implementation of set.
+ * Implementation of export_file.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_set
-(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_export_1file
+(JNIEnv* env, jobject jself, jstring jpath, jint format, jbyteArray jbegin, jbyteArray jend,
+ jobject jchecker) {
   try {
-    if (!jkey || !jvalue) {
+    if (!jpath) {
       throwillarg(env);
       return false;
     }
     kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftArray value(env, jvalue);
-    bool rv = db->set(key.ptr(), key.size(), value.ptr(), value.size());
+    SoftString path(env, jpath);
+    SoftArray begin(env, jbegin);
+    SoftArray end(env, jend);
+    std::string bstr, estr;
+    if (jbegin) bstr.assign(begin.ptr(), begin.size());
+    if (jend) estr.assign(end.ptr(), end.size());
+    SoftProgressChecker* checker = jchecker ? new SoftProgressChecker(env, jchecker) : NULL;
+    FileExporter exporter(db, path.str(), format, jbegin ? &bstr : NULL, jend ? &estr : NULL,
+                          checker);
+    bool rv = exporter.execute();
+    jthrowable jex = checker ? checker->exception() : NULL;
+    delete checker;
+    if (jex) {
+      env->Throw(jex);
+      return false;
+    }
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1390,45 +8505,29 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_set
 
 
 /**
- * Implementation of add.
+ * Implementation of cursor.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_add
-(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_cursor
+(JNIEnv* env, jobject jself) {
   try {
-    if (!jkey || !jvalue) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftArray value(env, jvalue);
-    bool rv = db->add(key.ptr(), key.size(), value.ptr(), value.size());
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    jclass cls_cur = env->FindClass(P_CUR);
+    jmethodID id_cur_init = env->GetMethodID(cls_cur, "<init>", "(" L_DB ")V");
+    return env->NewObject(cls_cur, id_cur_init, jself);
   } catch (std::exception& e) {
-    return false;
+    return NULL;
   }
 }
 
 
 /**
- * Implementation of replace.
+ * Implementation of tune_group_commit.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_replace
-(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1group_1commit
+(JNIEnv* env, jobject jself, jboolean enabled, jboolean hard) {
   try {
-    if (!jkey || !jvalue) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftArray value(env, jvalue);
-    bool rv = db->replace(key.ptr(), key.size(), value.ptr(), value.size());
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    SoftDB* db = getdbcore(env, jself);
+    db->tune_group_commit(enabled, hard);
+    return true;
   } catch (std::exception& e) {
     return false;
   }
@@ -1436,22 +8535,14 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_replace
 
 
 /**
- * Implementation of append.
+ * Implementation of tune_background_sync.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_append
-(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1background_1sync
+(JNIEnv* env, jobject jself, jlong interval, jlong size, jboolean hard) {
   try {
-    if (!jkey || !jvalue) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftArray value(env, jvalue);
-    bool rv = db->append(key.ptr(), key.size(), value.ptr(), value.size());
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    SoftDB* db = getdbcore(env, jself);
+    db->tune_background_sync(interval > 0 ? interval / 1000.0 : 0, size > 0 ? size : 0, hard);
+    return true;
   } catch (std::exception& e) {
     return false;
   }
@@ -1459,84 +8550,55 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_append
 
 
 /**
- * Implementation of increment.
+ * Implementation of sequence.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_increment
-(JNIEnv* env, jobject jself, jbyteArray jkey, jlong num, jlong orig) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_sequence
+(JNIEnv* env, jobject jself) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    num = db->increment(key.ptr(), key.size(), num, orig);
-    if (num == kc::INT64MIN) throwdberror(env, jself);
-    return num;
+    SoftDB* db = getdbcore(env, jself);
+    return db->synchronizer()->sequence();
   } catch (std::exception& e) {
-    return 0;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of increment_double.
+ * Implementation of synced_sequence.
  */
-JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_increment_1double
-(JNIEnv* env, jobject jself, jbyteArray jkey, jdouble num, jdouble orig) {
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_synced_1sequence
+(JNIEnv* env, jobject jself) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    num = db->increment_double(key.ptr(), key.size(), num, orig);
-    if (kc::chknan(num)) throwdberror(env, jself);
-    return num;
+    SoftDB* db = getdbcore(env, jself);
+    return db->synchronizer()->synced_sequence();
   } catch (std::exception& e) {
-    return 0;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of cas.
+ * Implementation of synced_time.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_cas
-(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray joval, jbyteArray jnval) {
+JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_synced_1time
+(JNIEnv* env, jobject jself) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    SoftArray oval(env, joval);
-    SoftArray nval(env, jnval);
-    bool rv = db->cas(key.ptr(), key.size(), oval.ptr(), oval.size(), nval.ptr(), nval.size());
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    SoftDB* db = getdbcore(env, jself);
+    return db->synchronizer()->synced_time();
   } catch (std::exception& e) {
-    return false;
+    return 0.0;
   }
 }
 
 
 /**
- * Implementation of remove.
+ * Implementation of synchronize_until.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_remove
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_synchronize_1until
+(JNIEnv* env, jobject jself, jlong seq) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    bool rv = db->remove(key.ptr(), key.size());
+    SoftDB* db = getdbcore(env, jself);
+    bool rv = db->synchronizer()->synchronize_until(seq);
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1547,196 +8609,158 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_remove
 
 
 /**
- * Implementation of get.
+ * Implementation of tune_throttle.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_get
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1throttle
+(JNIEnv* env, jobject jself, jlong ops, jlong size, jboolean prior) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return NULL;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    size_t vsiz;
-    char* vbuf = db->get(key.ptr(), key.size(), &vsiz);
-    if (!vbuf) {
-      throwdberror(env, jself);
-      return NULL;
-    }
-    jbyteArray jvalue = newarray(env, vbuf, vsiz);
-    delete[] vbuf;
-    return jvalue;
+    SoftDB* db = getdbcore(env, jself);
+    db->tune_throttle(ops > 0 ? ops : 0, size > 0 ? size : 0, prior);
+    return true;
   } catch (std::exception& e) {
-    return NULL;
+    return false;
   }
 }
 
 
 /**
- * Implementation of check.
+ * Implementation of tune_change_capture.
  */
-JNIEXPORT jint JNICALL Java_kyotocabinet_DB_check
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1change_1capture
+(JNIEnv* env, jobject jself, jint capacity, jint policy) {
   try {
-    if (!jkey) {
-      throwillarg(env);
-      return -1;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    int32_t vsiz = db->check(key.ptr(), key.size());
-    if (vsiz < 0) {
-      throwdberror(env, jself);
-      return -1;
+    SoftDB* db = getdbcore(env, jself);
+    ChangeRing::Policy cpol = ChangeRing::PBLOCK;
+    switch (policy) {
+      case kyotocabinet_DB_CDISCARD: cpol = ChangeRing::PDISCARD; break;
+      case kyotocabinet_DB_COVERWRITE: cpol = ChangeRing::POVERWRITE; break;
     }
-    return vsiz;
+    bool rv = db->tune_change_capture(capacity > 0 ? capacity : 0, cpol);
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return -1;
+    return false;
   }
 }
 
 
 /**
- * Implementation of seize.
+ * Implementation of poll_changes.
  */
-JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_seize
-(JNIEnv* env, jobject jself, jbyteArray jkey) {
+JNIEXPORT jint JNICALL Java_kyotocabinet_DB_poll_1changes
+(JNIEnv* env, jobject jself, jbyteArray jbuf, jint max) {
   try {
-    if (!jkey) {
+    if (!jbuf) {
       throwillarg(env);
-      return NULL;
+      return -1;
     }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftArray key(env, jkey);
-    size_t vsiz;
-    char* vbuf = db->seize(key.ptr(), key.size(), &vsiz);
-    if (!vbuf) {
+    SoftDB* db = getdbcore(env, jself);
+    ChangeRing* ring = db->change_ring();
+    if (!ring) {
+      db->set_error(_KCCODELINE_, kc::PolyDB::Error::INVALID, "not captured");
       throwdberror(env, jself);
-      return NULL;
+      return -1;
     }
-    jbyteArray jvalue = newarray(env, vbuf, vsiz);
-    delete[] vbuf;
-    return jvalue;
+    size_t size = env->GetArrayLength(jbuf);
+    if (max < 0) max = kc::INT32MAX;
+    char* buf = new char[size+1];
+    size_t wsiz = 0;
+    int32_t num = ring->poll(buf, size, max, &wsiz);
+    if (wsiz > 0) env->SetByteArrayRegion(jbuf, 0, wsiz, (jbyte*)buf);
+    delete[] buf;
+    if (num >= 0) return num;
+    db->set_error(_KCCODELINE_, kc::PolyDB::Error::INVALID, "too small buffer");
+    throwdberror(env, jself);
+    return -1;
   } catch (std::exception& e) {
-    return NULL;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of set_bulk.
+ * Implementation of open_with_ulog.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_set_1bulk
-(JNIEnv* env, jobject jself, jobjectArray jrecs, jboolean atomic) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_open_1with_1ulog
+(JNIEnv* env, jobject jself, jstring jpath, jint mode, jstring judir, jlong limsiz) {
   try {
-    if (!jrecs) {
+    if (!jpath || !judir) {
       throwillarg(env);
-      return -1;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    size_t rnum = env->GetArrayLength(jrecs);
-    StringMap recs;
-    for (size_t i = 0; i + 1 < rnum; i += 2) {
-      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jrecs, i);
-      jbyteArray jvalue = (jbyteArray)env->GetObjectArrayElement(jrecs, i + 1);
-      if (jkey && jvalue) {
-        SoftArray key(env, jkey);
-        SoftArray value(env, jvalue);
-        recs[std::string(key.ptr(), key.size())] = std::string(value.ptr(), value.size());
-      }
-      env->DeleteLocalRef(jkey);
-      env->DeleteLocalRef(jvalue);
-    }
-    int64_t rv = db->set_bulk(recs, atomic);
-    if (rv < 0) {
-      throwdberror(env, jself);
-      return -1;
+      return false;
     }
-    return rv;
+    SoftDB* db = getdbcore(env, jself);
+    SoftString path(env, jpath);
+    SoftString udir(env, judir);
+    bool rv = db->open_with_ulog(path.str(), mode, udir.str(), limsiz);
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return -1;
+    return false;
   }
 }
 
 
 /**
- * Implementation of remove_bulk.
+ * Implementation of add_index.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1bulk
-(JNIEnv* env, jobject jself, jobjectArray jkeys, jboolean atomic) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_add_1index
+(JNIEnv* env, jobject jself, jstring jname, jstring jpath, jint kind, jint first, jint second) {
   try {
-    if (!jkeys) {
+    if (!jname || !jpath) {
       throwillarg(env);
-      return -1;
+      return false;
     }
-    kc::PolyDB* db = getdbcore(env, jself);
-    size_t knum = env->GetArrayLength(jkeys);
-    StringVector keys;
-    keys.reserve(knum);
-    for (size_t i = 0; i < knum; i++) {
-      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
-      if (jkey) {
-        SoftArray key(env, jkey);
-        keys.push_back(std::string(key.ptr(), key.size()));
+    SecondaryIndex::Kind ikind;
+    switch (kind) {
+      case kyotocabinet_DB_IRANGE: ikind = SecondaryIndex::KRANGE; break;
+      case kyotocabinet_DB_IFIELD: ikind = SecondaryIndex::KFIELD; break;
+      case kyotocabinet_DB_IINTEGER: ikind = SecondaryIndex::KINTEGER; break;
+      default: {
+        throwillarg(env);
+        return false;
       }
-      env->DeleteLocalRef(jkey);
     }
-    int64_t rv = db->remove_bulk(keys, atomic);
-    if (rv < 0) {
-      throwdberror(env, jself);
-      return -1;
-    }
-    return rv;
+    SoftDB* db = getdbcore(env, jself);
+    SoftString name(env, jname);
+    SoftString path(env, jpath);
+    bool rv = db->add_index(name.str(), path.str(), ikind, first, second);
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return (jlong)NULL;
+    return false;
   }
 }
 
 
 /**
- * Implementation of get_bulk.
+ * Implementation of index_lookup.
  */
-JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_DB_get_1bulk
-(JNIEnv* env, jobject jself, jobjectArray jkeys, jboolean atomic) {
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_DB_index_1lookup
+(JNIEnv* env, jobject jself, jstring jname, jbyteArray jvalue, jlong max) {
   try {
-    if (!jkeys) {
+    if (!jname || !jvalue) {
       throwillarg(env);
       return NULL;
     }
-    kc::PolyDB* db = getdbcore(env, jself);
-    size_t knum = env->GetArrayLength(jkeys);
+    SoftDB* db = getdbcore(env, jself);
+    SoftString name(env, jname);
+    SoftArray value(env, jvalue);
     StringVector keys;
-    keys.reserve(knum);
-    for (size_t i = 0; i < knum; i++) {
-      jbyteArray jkey = (jbyteArray)env->GetObjectArrayElement(jkeys, i);
-      if (jkey) {
-        SoftArray key(env, jkey);
-        keys.push_back(std::string(key.ptr(), key.size()));
-      }
-      env->DeleteLocalRef(jkey);
-    }
-    StringMap recs;
-    if (db->get_bulk(keys, &recs, atomic) < 0) {
+    if (!db->index_lookup(name.str(), value.ptr(), value.size(), max, &keys)) {
       throwdberror(env, jself);
       return NULL;
     }
-    size_t rnum = recs.size();
     jclass cls_byteary = env->FindClass("[B");
-    jobjectArray jrec = env->NewObjectArray(rnum * 2, cls_byteary, NULL);
-    StringMap::iterator it = recs.begin();
-    StringMap::iterator itend = recs.end();
-    size_t ridx = 0;
-    while (it != itend) {
-      jbyteArray jkey = newarray(env, it->first.data(), it->first.size());
-      jbyteArray jvalue = newarray(env, it->second.data(), it->second.size());
-      env->SetObjectArrayElement(jrec, ridx++, jkey);
-      env->SetObjectArrayElement(jrec, ridx++, jvalue);
+    jobjectArray jkeys = env->NewObjectArray(keys.size(), cls_byteary, NULL);
+    for (size_t i = 0; i < keys.size(); i++) {
+      jbyteArray jkey = newarray(env, keys[i].data(), keys[i].size());
+      env->SetObjectArrayElement(jkeys, i, jkey);
       env->DeleteLocalRef(jkey);
-      env->DeleteLocalRef(jvalue);
-      it++;
     }
-    return jrec;
+    return jkeys;
   } catch (std::exception& e) {
     return NULL;
   }
@@ -1744,13 +8768,13 @@ JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_DB_get_1bulk
 
 
 /**
- * Implementation of clear.
+ * Implementation of tune_bloom_filter.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_clear
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1bloom_1filter
+(JNIEnv* env, jobject jself, jlong expected, jdouble fprate) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    bool rv = db->clear();
+    SoftDB* db = getdbcore(env, jself);
+    bool rv = db->tune_bloom_filter(expected, fprate);
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1761,20 +8785,13 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_clear
 
 
 /**
- * Implementation of synchronize.
+ * Implementation of tune_front_cache.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_synchronize
-(JNIEnv* env, jobject jself, jboolean hard, jobject jproc) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1front_1cache
+(JNIEnv* env, jobject jself, jlong capacity) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    if (!jproc) return db->synchronize(hard);
-    SoftFileProcessor proc(env, jproc);
-    bool rv = db->synchronize(hard, &proc);
-    jthrowable jex = proc.exception();
-    if (jex) {
-      env->Throw(jex);
-      return false;
-    }
+    SoftDB* db = getdbcore(env, jself);
+    bool rv = db->tune_front_cache(capacity);
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1785,98 +8802,114 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_synchronize
 
 
 /**
- * Implementation of occupy.
+ * Implementation of initialize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_occupy
-(JNIEnv* env, jobject jself, jboolean writable, jobject jproc) {
+JNIEXPORT void JNICALL Java_kyotocabinet_DB_initialize
+(JNIEnv* env, jobject jself, jint opts) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    if (!jproc) return db->occupy(writable);
-    SoftFileProcessor proc(env, jproc);
-    bool rv = db->occupy(writable, &proc);
-    jthrowable jex = proc.exception();
-    if (jex) {
-      env->Throw(jex);
-      return false;
+    jclass cls_db = env->GetObjectClass(jself);
+    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+    jfieldID id_db_exbits = env->GetFieldID(cls_db, "exbits_", "I");
+    SoftDB* db = new SoftDB();
+    int32_t exbits = 0;
+    if (opts & GEXCEPTIONAL) {
+      exbits |= 1 << kc::PolyDB::Error::NOIMPL;
+      exbits |= 1 << kc::PolyDB::Error::INVALID;
+      exbits |= 1 << kc::PolyDB::Error::NOREPOS;
+      exbits |= 1 << kc::PolyDB::Error::NOPERM;
+      exbits |= 1 << kc::PolyDB::Error::BROKEN;
+      exbits |= 1 << kc::PolyDB::Error::SYSTEM;
+      exbits |= 1 << kc::PolyDB::Error::MISC;
     }
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
-  } catch (std::exception& e) {
-    return false;
-  }
+    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
+    env->SetIntField(jself, id_db_exbits, exbits);
+  } catch (std::exception& e) {}
+}
+
+
+/**
+ * Implementation of destruct.
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_DB_destruct
+(JNIEnv* env, jobject jself) {
+  try {
+    SoftDB* db = getdbcore(env, jself);
+    delete db;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of copy.
+ * Implementation of initialize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_copy
-(JNIEnv* env, jobject jself, jstring jdest) {
+JNIEXPORT void JNICALL Java_kyotocabinet_ShardedDB_initialize
+(JNIEnv* env, jobject jself, jint dbnum) {
   try {
-    if (!jdest) {
+    if (dbnum < 1) {
       throwillarg(env);
-      return false;
+      return;
     }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString dest(env, jdest);
-    bool rv = db->copy(dest.str());
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
-  } catch (std::exception& e) {
-    return false;
-  }
+    jclass cls_db = env->GetObjectClass(jself);
+    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+    SoftDB* odb = (SoftDB*)(intptr_t)env->GetLongField(jself, id_db_ptr);
+    SoftDB* db = new SoftDB(new ShardDB(dbnum));
+    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
+    delete odb;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of begin_trnasaction.
+ * Implementation of initialize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_begin_1transaction
-(JNIEnv* env, jobject jself, jboolean hard) {
+JNIEXPORT void JNICALL Java_kyotocabinet_TieredDB_initialize
+(JNIEnv* env, jobject jself, jstring jcache, jint dirty) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    bool rv = db->begin_transaction(hard);
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
-  } catch (std::exception& e) {
-    return false;
-  }
+    if (!jcache || dirty < 0) {
+      throwillarg(env);
+      return;
+    }
+    SoftString cache(env, jcache);
+    jclass cls_db = env->GetObjectClass(jself);
+    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+    SoftDB* odb = (SoftDB*)(intptr_t)env->GetLongField(jself, id_db_ptr);
+    SoftDB* db = new SoftDB(new TierDB(cache.str(), dirty));
+    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
+    delete odb;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of end_transaction.
+ * Implementation of initialize.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_end_1transaction
-(JNIEnv* env, jobject jself, jboolean commit) {
+JNIEXPORT void JNICALL Java_kyotocabinet_MemtableDB_initialize
+(JNIEnv* env, jobject jself, jstring jmemtable, jlong limit) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    bool rv = db->end_transaction(commit);
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
-  } catch (std::exception& e) {
-    return false;
-  }
+    if (!jmemtable || limit < 1) {
+      throwillarg(env);
+      return;
+    }
+    SoftString memtable(env, jmemtable);
+    jclass cls_db = env->GetObjectClass(jself);
+    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+    SoftDB* odb = (SoftDB*)(intptr_t)env->GetLongField(jself, id_db_ptr);
+    SoftDB* db = new SoftDB(new MemtableDB(memtable.str(), limit));
+    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
+    delete odb;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of dump_snapshot.
+ * Implementation of tune_cache_limit.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_dump_1snapshot
-(JNIEnv* env, jobject jself, jstring jdest) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_IndexDB_tune_1cache_1limit
+(JNIEnv* env, jobject jself, jlong limit) {
   try {
-    if (!jdest) {
-      throwillarg(env);
-      return false;
-    }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString dest(env, jdest);
-    bool rv = db->dump_snapshot(dest.str());
+    SoftDB* db = getdbcore(env, jself);
+    IndexAdapter* idb = (IndexAdapter*)db->reveal_inner_db();
+    bool rv = idb->tune_cache_limit(limit);
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1887,18 +8920,21 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_dump_1snapshot
 
 
 /**
- * Implementation of load_snapshot.
+ * Implementation of append.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_load_1snapshot
-(JNIEnv* env, jobject jself, jstring jsrc) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_IndexDB_append
+(JNIEnv* env, jobject jself, jbyteArray jkey, jbyteArray jvalue) {
   try {
-    if (!jsrc) {
+    if (!jkey || !jvalue) {
       throwillarg(env);
       return false;
     }
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString src(env, jsrc);
-    bool rv = db->load_snapshot(src.str());
+    SoftDB* db = getdbcore(env, jself);
+    IndexAdapter* idb = (IndexAdapter*)db->reveal_inner_db();
+    SoftArray key(env, jkey);
+    SoftArray value(env, jvalue);
+    IndexAdapter::BufferAppender appender(idb);
+    bool rv = db->append(key.ptr(), key.size(), value.ptr(), value.size(), &appender);
     if (rv) return true;
     throwdberror(env, jself);
     return false;
@@ -1909,175 +8945,200 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_load_1snapshot
 
 
 /**
- * Implementation of count.
- */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_count
-(JNIEnv* env, jobject jself) {
-  try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    int64_t count = db->count();
-    if (count < 0) throwdberror(env, jself);
-    return count;
-  } catch (std::exception& e) {
-    return 0;
-  }
-}
-
-
-/**
- * Implementation of size.
+ * Implementation of initialize.
  */
-JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_size
+JNIEXPORT void JNICALL Java_kyotocabinet_IndexDB_initialize
 (JNIEnv* env, jobject jself) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    int64_t size = db->size();
-    if (size < 0) throwdberror(env, jself);
-    return size;
-  } catch (std::exception& e) {
-    return 0;
-  }
+    jclass cls_db = env->GetObjectClass(jself);
+    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
+    SoftDB* odb = (SoftDB*)(intptr_t)env->GetLongField(jself, id_db_ptr);
+    SoftDB* db = new SoftDB(new IndexAdapter());
+    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
+    delete odb;
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of path.
+ * Implementation of append_lines.
  */
-JNIEXPORT jstring JNICALL Java_kyotocabinet_DB_path
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_TextDB_append_1lines
+(JNIEnv* env, jobject jself, jbyteArray jlines) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    std::string path = db->path().c_str();
-    if (path.empty()) {
+    if (!jlines) {
+      throwillarg(env);
+      return false;
+    }
+    SoftDB* db = getdbcore(env, jself);
+    if (db->type() != kc::BasicDB::TYPETEXT) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::NOIMPL, "not a text database");
       throwdberror(env, jself);
-      return NULL;
+      return false;
     }
-    return newstring(env, path.c_str());
+    SoftArray lines(env, jlines);
+    size_t size = lines.size();
+    if (size < 1) return true;
+    if (lines.ptr()[size - 1] == '\n') size--;
+    bool rv = db->set("", 0, lines.ptr(), size);
+    if (rv) return true;
+    throwdberror(env, jself);
+    return false;
   } catch (std::exception& e) {
-    return NULL;
+    return false;
   }
 }
 
 
 /**
- * Implementation of status.
+ * Implementation of read_lines.
  */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_status
-(JNIEnv* env, jobject jself) {
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_TextDB_read_1lines
+(JNIEnv* env, jobject jself, jlong pos, jint max) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    StringMap status;
-    if (!db->status(&status)) {
-      throwdberror(env, jself);
+    if (pos < 0) {
+      throwillarg(env);
       return NULL;
     }
-    return maptojhash(env, &status);
-  } catch (std::exception& e) {
-    return NULL;
-  }
-}
-
-
-/*
- * Implementation of match_prefix.
- */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1prefix
-(JNIEnv* env, jobject jself, jstring jprefix, jlong max) {
-  try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString prefix(env, jprefix);
-    StringVector keys;
-    if (db->match_prefix(prefix.str(), &keys, max) == -1) {
+    SoftDB* db = getdbcore(env, jself);
+    if (db->type() != kc::BasicDB::TYPETEXT) {
+      db->set_error(_KCCODELINE_, kc::BasicDB::Error::NOIMPL, "not a text database");
       throwdberror(env, jself);
       return NULL;
     }
-    return vectortojlist(env, &keys);
-  } catch (std::exception& e) {
-    return NULL;
-  }
-}
-
-
-/*
- * Implementation of match_regex.
- */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1regex
-(JNIEnv* env, jobject jself, jstring jregex, jlong max) {
-  try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString regex(env, jregex);
-    StringVector keys;
-    if (db->match_regex(regex.str(), &keys, max) == -1) {
+    if (max < 0) max = kc::INT32MAX;
+    StringVector recs;
+    kc::PolyDB::Cursor* cur = db->cursor();
+    std::string key = kc::strprintf("%016llX", (unsigned long long)pos);
+    if (cur->jump(key)) {
+      std::string value;
+      while ((int64_t)recs.size() < (int64_t)max * 2 && cur->get(&key, &value, true)) {
+        recs.push_back(key);
+        recs.push_back(value);
+      }
+    }
+    bool err = cur->error() != kc::BasicDB::Error::SUCCESS &&
+        cur->error() != kc::BasicDB::Error::NOREC;
+    if (err) db->set_error(_KCCODELINE_, cur->error().code(), cur->error().message());
+    delete cur;
+    if (err) {
       throwdberror(env, jself);
       return NULL;
     }
-    return vectortojlist(env, &keys);
+    jclass cls_byteary = env->FindClass("[B");
+    jobjectArray jrecs = env->NewObjectArray(recs.size(), cls_byteary, NULL);
+    for (size_t i = 0; i < recs.size(); i++) {
+      jbyteArray jrec = newarray(env, recs[i].data(), recs[i].size());
+      env->SetObjectArrayElement(jrecs, i, jrec);
+      env->DeleteLocalRef(jrec);
+    }
+    return jrecs;
   } catch (std::exception& e) {
     return NULL;
   }
 }
 
 
-/*
- * Implementation of match_similar.
+/**
+ * Implementation of disable.
  */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1similar
-(JNIEnv* env, jobject jself, jstring jorigin, jlong range, jboolean utf, jlong max) {
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_disable
+(JNIEnv* env, jobject jself) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    SoftString origin(env, jorigin);
-    StringVector keys;
-    if (db->match_similar(origin.str(), range, utf, &keys, max) == -1) {
-      throwdberror(env, jself);
-      return NULL;
-    }
-    return vectortojlist(env, &keys);
-  } catch (std::exception& e) {
-    return NULL;
-  }
+    UpdateLogReader* reader = getrepcore(env, jself);
+    reader->close();
+  } catch (std::exception& e) {}
 }
 
 
 /**
- * Implementation of merge.
+ * Implementation of apply.
  */
-JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge
-(JNIEnv* env, jobject jself, jobjectArray jsrcary, jint mode) {
+JNIEXPORT jint JNICALL Java_kyotocabinet_ReplicationReader_apply
+(JNIEnv* env, jobject jself, jobject jdb, jint max, jlong until) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    size_t srcnum = env->GetArrayLength(jsrcary);
-    if (srcnum < 1) return true;
-    kc::BasicDB** srcary = new kc::BasicDB*[srcnum];
-    for (size_t i = 0; i < srcnum; i++) {
-      jobject jsrcdb = env->GetObjectArrayElement(jsrcary, i);
-      if (!jsrcdb) {
-        delete[] srcary;
-        return false;
+    if (!jdb) {
+      throwillarg(env);
+      return -1;
+    }
+    UpdateLogReader* reader = getrepcore(env, jself);
+    SoftDB* db = getdbcore(env, jdb);
+    if (max < 0) max = kc::INT32MAX;
+    UpdateLogReader::Position pos = reader->tell();
+    std::vector<UpdateLogReader::Record> recs;
+    while ((int32_t)recs.size() < max) {
+      UpdateLogReader::Record rec;
+      int32_t rv = reader->read(&rec, until);
+      if (rv < 0) {
+        reader->seek(pos);
+        db->set_error(_KCCODELINE_, kc::PolyDB::Error::BROKEN, "reading the update log failed");
+        throwdberror(env, jdb);
+        return -1;
       }
-      srcary[i] = getdbcore(env, jsrcdb);
+      if (rv == 0) break;
+      recs.push_back(rec);
     }
-    bool rv = db->merge(srcary, srcnum, (kc::PolyDB::MergeMode)mode);
-    delete[] srcary;
-    if (rv) return true;
-    throwdberror(env, jself);
-    return false;
+    if (recs.empty()) return 0;
+    bool err = false;
+    if (db->begin_transaction(false)) {
+      std::vector<UpdateLogReader::Record>::iterator it = recs.begin();
+      std::vector<UpdateLogReader::Record>::iterator itend = recs.end();
+      while (!err && it != itend) {
+        switch (it->type) {
+          case ChangeRing::TSET: {
+            if (!db->set(it->key.data(), it->key.size(), it->value.data(), it->value.size()))
+              err = true;
+            break;
+          }
+          case ChangeRing::TREMOVE: {
+            if (!db->remove(it->key.data(), it->key.size()) &&
+                db->error() != kc::PolyDB::Error::NOREC) err = true;
+            break;
+          }
+          case ChangeRing::TCLEAR: {
+            if (!db->clear()) err = true;
+            break;
+          }
+          default: {
+            db->set_error(_KCCODELINE_, kc::PolyDB::Error::BROKEN, "unknown update type");
+            err = true;
+            break;
+          }
+        }
+        ++it;
+      }
+      if (err) {
+        kc::PolyDB::Error e = db->error();
+        db->end_transaction(false);
+        db->set_error(_KCCODELINE_, e.code(), e.message());
+      } else if (!db->end_transaction(true)) {
+        err = true;
+      }
+    } else {
+      err = true;
+    }
+    if (err) {
+      reader->seek(pos);
+      throwdberror(env, jdb);
+      return -1;
+    }
+    return recs.size();
   } catch (std::exception& e) {
-    return false;
+    return -1;
   }
 }
 
 
 /**
- * Implementation of cursor.
+ * Implementation of timestamp.
  */
-JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_cursor
+JNIEXPORT jlong JNICALL Java_kyotocabinet_ReplicationReader_timestamp
 (JNIEnv* env, jobject jself) {
   try {
-    jclass cls_cur = env->FindClass(P_CUR);
-    jmethodID id_cur_init = env->GetMethodID(cls_cur, "<init>", "(" L_DB ")V");
-    return env->NewObject(cls_cur, id_cur_init, jself);
+    UpdateLogReader* reader = getrepcore(env, jself);
+    return reader->tell().ts;
   } catch (std::exception& e) {
-    return NULL;
+    return 0;
   }
 }
 
@@ -2085,25 +9146,18 @@ JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_cursor
 /**
  * Implementation of initialize.
  */
-JNIEXPORT void JNICALL Java_kyotocabinet_DB_initialize
-(JNIEnv* env, jobject jself, jint opts) {
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_initialize
+(JNIEnv* env, jobject jself, jstring jdir, jlong ts) {
   try {
-    jclass cls_db = env->GetObjectClass(jself);
-    jfieldID id_db_ptr = env->GetFieldID(cls_db, "ptr_", "J");
-    jfieldID id_db_exbits = env->GetFieldID(cls_db, "exbits_", "I");
-    kc::PolyDB* db = new kc::PolyDB();
-    int32_t exbits = 0;
-    if (opts & GEXCEPTIONAL) {
-      exbits |= 1 << kc::PolyDB::Error::NOIMPL;
-      exbits |= 1 << kc::PolyDB::Error::INVALID;
-      exbits |= 1 << kc::PolyDB::Error::NOREPOS;
-      exbits |= 1 << kc::PolyDB::Error::NOPERM;
-      exbits |= 1 << kc::PolyDB::Error::BROKEN;
-      exbits |= 1 << kc::PolyDB::Error::SYSTEM;
-      exbits |= 1 << kc::PolyDB::Error::MISC;
+    if (!jdir) {
+      throwillarg(env);
+      return;
     }
-    env->SetLongField(jself, id_db_ptr, (intptr_t)db);
-    env->SetIntField(jself, id_db_exbits, exbits);
+    jclass cls_rep = env->GetObjectClass(jself);
+    jfieldID id_rep_ptr = env->GetFieldID(cls_rep, "ptr_", "J");
+    SoftString dir(env, jdir);
+    UpdateLogReader* reader = new UpdateLogReader(dir.str(), ts > 0 ? ts : 0);
+    env->SetLongField(jself, id_rep_ptr, (intptr_t)reader);
   } catch (std::exception& e) {}
 }
 
@@ -2111,11 +9165,11 @@ JNIEXPORT void JNICALL Java_kyotocabinet_DB_initialize
 /**
  * Implementation of destruct.
  */
-JNIEXPORT void JNICALL Java_kyotocabinet_DB_destruct
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_destruct
 (JNIEnv* env, jobject jself) {
   try {
-    kc::PolyDB* db = getdbcore(env, jself);
-    delete db;
+    UpdateLogReader* reader = getrepcore(env, jself);
+    delete reader;
   } catch (std::exception& e) {}
 }
 
@@ -35,6 +35,58 @@ extern "C" {
 #define kyotocabinet_DB_MREPLACE 2L
 #undef kyotocabinet_DB_MAPPEND
 #define kyotocabinet_DB_MAPPEND 3L
+#undef kyotocabinet_DB_CBLOCK
+#define kyotocabinet_DB_CBLOCK 0L
+#undef kyotocabinet_DB_CDISCARD
+#define kyotocabinet_DB_CDISCARD 1L
+#undef kyotocabinet_DB_COVERWRITE
+#define kyotocabinet_DB_COVERWRITE 2L
+#undef kyotocabinet_DB_CSET
+#define kyotocabinet_DB_CSET 1L
+#undef kyotocabinet_DB_CREMOVE
+#define kyotocabinet_DB_CREMOVE 2L
+#undef kyotocabinet_DB_CCLEAR
+#define kyotocabinet_DB_CCLEAR 3L
+#undef kyotocabinet_DB_IRANGE
+#define kyotocabinet_DB_IRANGE 0L
+#undef kyotocabinet_DB_IFIELD
+#define kyotocabinet_DB_IFIELD 1L
+#undef kyotocabinet_DB_IINTEGER
+#define kyotocabinet_DB_IINTEGER 2L
+#undef kyotocabinet_DB_FTSV
+#define kyotocabinet_DB_FTSV 0L
+#undef kyotocabinet_DB_FBINARY
+#define kyotocabinet_DB_FBINARY 1L
+#undef kyotocabinet_DB_FSNAPSHOT
+#define kyotocabinet_DB_FSNAPSHOT 2L
+#undef kyotocabinet_DB_VADDINT
+#define kyotocabinet_DB_VADDINT 0L
+#undef kyotocabinet_DB_VADDDBL
+#define kyotocabinet_DB_VADDDBL 1L
+#undef kyotocabinet_DB_VMAX
+#define kyotocabinet_DB_VMAX 2L
+#undef kyotocabinet_DB_VMIN
+#define kyotocabinet_DB_VMIN 3L
+#undef kyotocabinet_DB_VMAXINT
+#define kyotocabinet_DB_VMAXINT 4L
+#undef kyotocabinet_DB_VMININT
+#define kyotocabinet_DB_VMININT 5L
+#undef kyotocabinet_DB_VOR
+#define kyotocabinet_DB_VOR 6L
+#undef kyotocabinet_DB_VUNION
+#define kyotocabinet_DB_VUNION 7L
+#undef kyotocabinet_DB_TSET
+#define kyotocabinet_DB_TSET 0L
+#undef kyotocabinet_DB_TAPPEND
+#define kyotocabinet_DB_TAPPEND 1L
+#undef kyotocabinet_DB_TPREPEND
+#define kyotocabinet_DB_TPREPEND 2L
+#undef kyotocabinet_DB_TFIELD
+#define kyotocabinet_DB_TFIELD 3L
+#undef kyotocabinet_DB_TREMOVE
+#define kyotocabinet_DB_TREMOVE 4L
+#undef kyotocabinet_DB_TINCINT
+#define kyotocabinet_DB_TINCINT 5L
 /*
  * Class:     kyotocabinet_DB
  * Method:    error
@@ -99,6 +151,14 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_set
 JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_add
   (JNIEnv *, jobject, jbyteArray, jbyteArray);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    add_bulk
+ * Signature: ([[B[[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_add_1bulk
+  (JNIEnv *, jobject, jobjectArray, jobjectArray, jboolean);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    replace
@@ -131,6 +191,38 @@ JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_increment
 JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_increment_1double
   (JNIEnv *, jobject, jbyteArray, jdouble, jdouble);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    increment_bulk
+ * Signature: ([[B[J[JJZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_increment_1bulk
+  (JNIEnv *, jobject, jobjectArray, jlongArray, jlongArray, jlong, jboolean);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    increment_double_bulk
+ * Signature: ([[B[D[DDZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_increment_1double_1bulk
+  (JNIEnv *, jobject, jobjectArray, jdoubleArray, jdoubleArray, jdouble, jboolean);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    merge_value
+ * Signature: ([BI[BJ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge_1value
+  (JNIEnv *, jobject, jbyteArray, jint, jbyteArray, jlong);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    merge_value_bulk
+ * Signature: ([[BIJZ)J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_merge_1value_1bulk
+  (JNIEnv *, jobject, jobjectArray, jint, jlong, jboolean);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    cas
@@ -139,6 +231,14 @@ JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_increment_1double
 JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_cas
   (JNIEnv *, jobject, jbyteArray, jbyteArray, jbyteArray);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    cas_bulk
+ * Signature: ([[B[[B[[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_cas_1bulk
+  (JNIEnv *, jobject, jobjectArray, jobjectArray, jobjectArray, jboolean);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    remove
@@ -163,6 +263,22 @@ JNIEXPORT jbyteArray JNICALL Java_kyotocabinet_DB_get
 JNIEXPORT jint JNICALL Java_kyotocabinet_DB_check
   (JNIEnv *, jobject, jbyteArray);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    check_bulk
+ * Signature: ([[B[I)J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_check_1bulk
+  (JNIEnv *, jobject, jobjectArray, jintArray);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    contains_bulk
+ * Signature: ([[B)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_kyotocabinet_DB_contains_1bulk
+  (JNIEnv *, jobject, jobjectArray);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    seize
@@ -187,6 +303,30 @@ JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_set_1bulk
 JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1bulk
   (JNIEnv *, jobject, jobjectArray, jboolean);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    remove_prefix
+ * Signature: ([BJD)J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1prefix
+  (JNIEnv *, jobject, jbyteArray, jlong, jdouble);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    remove_range
+ * Signature: ([B[BJD)J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_remove_1range
+  (JNIEnv *, jobject, jbyteArray, jbyteArray, jlong, jdouble);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    update_where
+ * Signature: ([B[BIJJ[BJLkyotocabinet/ProgressChecker;)J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_update_1where
+  (JNIEnv *, jobject, jbyteArray, jbyteArray, jint, jlong, jlong, jbyteArray, jlong, jobject);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    get_bulk
@@ -246,18 +386,18 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_end_1transaction
 /*
  * Class:     kyotocabinet_DB
  * Method:    dump_snapshot
- * Signature: (Ljava/lang/String;)Z
+ * Signature: (Ljava/lang/String;Ljava/lang/String;Lkyotocabinet/ProgressChecker;)Z
  */
 JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_dump_1snapshot
-  (JNIEnv *, jobject, jstring);
+  (JNIEnv *, jobject, jstring, jstring, jobject);
 
 /*
  * Class:     kyotocabinet_DB
  * Method:    load_snapshot
- * Signature: (Ljava/lang/String;)Z
+ * Signature: (Ljava/lang/String;Lkyotocabinet/ProgressChecker;)Z
  */
 JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_load_1snapshot
-  (JNIEnv *, jobject, jstring);
+  (JNIEnv *, jobject, jstring, jobject);
 
 /*
  * Class:     kyotocabinet_DB
@@ -318,10 +458,34 @@ JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_match_1similar
 /*
  * Class:     kyotocabinet_DB
  * Method:    merge
- * Signature: ([Lkyotocabinet/DB;I)Z
+ * Signature: ([Lkyotocabinet/DB;ILkyotocabinet/ProgressChecker;)Z
  */
 JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge
-  (JNIEnv *, jobject, jobjectArray, jint);
+  (JNIEnv *, jobject, jobjectArray, jint, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    bulk_load
+ * Signature: (Ljava/lang/String;Ljava/lang/String;ILkyotocabinet/ProgressChecker;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_bulk_1load
+  (JNIEnv *, jobject, jstring, jstring, jint, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    import_file
+ * Signature: (Ljava/lang/String;IIILkyotocabinet/ProgressChecker;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_import_1file
+  (JNIEnv *, jobject, jstring, jint, jint, jint, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    export_file
+ * Signature: (Ljava/lang/String;I[B[BLkyotocabinet/ProgressChecker;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_export_1file
+  (JNIEnv *, jobject, jstring, jint, jbyteArray, jbyteArray, jobject);
 
 /*
  * Class:     kyotocabinet_DB
@@ -331,6 +495,118 @@ JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_merge
 JNIEXPORT jobject JNICALL Java_kyotocabinet_DB_cursor
   (JNIEnv *, jobject);
 
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_group_commit
+ * Signature: (ZZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1group_1commit
+  (JNIEnv *, jobject, jboolean, jboolean);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_background_sync
+ * Signature: (JJZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1background_1sync
+  (JNIEnv *, jobject, jlong, jlong, jboolean);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    sequence
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_sequence
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    synced_sequence
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_DB_synced_1sequence
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    synced_time
+ * Signature: ()D
+ */
+JNIEXPORT jdouble JNICALL Java_kyotocabinet_DB_synced_1time
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    synchronize_until
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_synchronize_1until
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_throttle
+ * Signature: (JJZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1throttle
+  (JNIEnv *, jobject, jlong, jlong, jboolean);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_change_capture
+ * Signature: (II)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1change_1capture
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    poll_changes
+ * Signature: ([BI)I
+ */
+JNIEXPORT jint JNICALL Java_kyotocabinet_DB_poll_1changes
+  (JNIEnv *, jobject, jbyteArray, jint);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    open_with_ulog
+ * Signature: (Ljava/lang/String;ILjava/lang/String;J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_open_1with_1ulog
+  (JNIEnv *, jobject, jstring, jint, jstring, jlong);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    add_index
+ * Signature: (Ljava/lang/String;Ljava/lang/String;III)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_add_1index
+  (JNIEnv *, jobject, jstring, jstring, jint, jint, jint);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    index_lookup
+ * Signature: (Ljava/lang/String;[BJ)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_DB_index_1lookup
+  (JNIEnv *, jobject, jstring, jbyteArray, jlong);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_bloom_filter
+ * Signature: (JD)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1bloom_1filter
+  (JNIEnv *, jobject, jlong, jdouble);
+
+/*
+ * Class:     kyotocabinet_DB
+ * Method:    tune_front_cache
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_DB_tune_1front_1cache
+  (JNIEnv *, jobject, jlong);
+
 /*
  * Class:     kyotocabinet_DB
  * Method:    initialize
@@ -0,0 +1,117 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_IndexDB */
+
+#ifndef _Included_kyotocabinet_IndexDB
+#define _Included_kyotocabinet_IndexDB
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef kyotocabinet_IndexDB_GEXCEPTIONAL
+#define kyotocabinet_IndexDB_GEXCEPTIONAL 1L
+#undef kyotocabinet_IndexDB_OREADER
+#define kyotocabinet_IndexDB_OREADER 1L
+#undef kyotocabinet_IndexDB_OWRITER
+#define kyotocabinet_IndexDB_OWRITER 2L
+#undef kyotocabinet_IndexDB_OCREATE
+#define kyotocabinet_IndexDB_OCREATE 4L
+#undef kyotocabinet_IndexDB_OTRUNCATE
+#define kyotocabinet_IndexDB_OTRUNCATE 8L
+#undef kyotocabinet_IndexDB_OAUTOTRAN
+#define kyotocabinet_IndexDB_OAUTOTRAN 16L
+#undef kyotocabinet_IndexDB_OAUTOSYNC
+#define kyotocabinet_IndexDB_OAUTOSYNC 32L
+#undef kyotocabinet_IndexDB_ONOLOCK
+#define kyotocabinet_IndexDB_ONOLOCK 64L
+#undef kyotocabinet_IndexDB_OTRYLOCK
+#define kyotocabinet_IndexDB_OTRYLOCK 128L
+#undef kyotocabinet_IndexDB_ONOREPAIR
+#define kyotocabinet_IndexDB_ONOREPAIR 256L
+#undef kyotocabinet_IndexDB_MSET
+#define kyotocabinet_IndexDB_MSET 0L
+#undef kyotocabinet_IndexDB_MADD
+#define kyotocabinet_IndexDB_MADD 1L
+#undef kyotocabinet_IndexDB_MREPLACE
+#define kyotocabinet_IndexDB_MREPLACE 2L
+#undef kyotocabinet_IndexDB_MAPPEND
+#define kyotocabinet_IndexDB_MAPPEND 3L
+#undef kyotocabinet_IndexDB_CBLOCK
+#define kyotocabinet_IndexDB_CBLOCK 0L
+#undef kyotocabinet_IndexDB_CDISCARD
+#define kyotocabinet_IndexDB_CDISCARD 1L
+#undef kyotocabinet_IndexDB_COVERWRITE
+#define kyotocabinet_IndexDB_COVERWRITE 2L
+#undef kyotocabinet_IndexDB_CSET
+#define kyotocabinet_IndexDB_CSET 1L
+#undef kyotocabinet_IndexDB_CREMOVE
+#define kyotocabinet_IndexDB_CREMOVE 2L
+#undef kyotocabinet_IndexDB_CCLEAR
+#define kyotocabinet_IndexDB_CCLEAR 3L
+#undef kyotocabinet_IndexDB_IRANGE
+#define kyotocabinet_IndexDB_IRANGE 0L
+#undef kyotocabinet_IndexDB_IFIELD
+#define kyotocabinet_IndexDB_IFIELD 1L
+#undef kyotocabinet_IndexDB_IINTEGER
+#define kyotocabinet_IndexDB_IINTEGER 2L
+#undef kyotocabinet_IndexDB_FTSV
+#define kyotocabinet_IndexDB_FTSV 0L
+#undef kyotocabinet_IndexDB_FBINARY
+#define kyotocabinet_IndexDB_FBINARY 1L
+#undef kyotocabinet_IndexDB_FSNAPSHOT
+#define kyotocabinet_IndexDB_FSNAPSHOT 2L
+#undef kyotocabinet_IndexDB_VADDINT
+#define kyotocabinet_IndexDB_VADDINT 0L
+#undef kyotocabinet_IndexDB_VADDDBL
+#define kyotocabinet_IndexDB_VADDDBL 1L
+#undef kyotocabinet_IndexDB_VMAX
+#define kyotocabinet_IndexDB_VMAX 2L
+#undef kyotocabinet_IndexDB_VMIN
+#define kyotocabinet_IndexDB_VMIN 3L
+#undef kyotocabinet_IndexDB_VMAXINT
+#define kyotocabinet_IndexDB_VMAXINT 4L
+#undef kyotocabinet_IndexDB_VMININT
+#define kyotocabinet_IndexDB_VMININT 5L
+#undef kyotocabinet_IndexDB_VOR
+#define kyotocabinet_IndexDB_VOR 6L
+#undef kyotocabinet_IndexDB_VUNION
+#define kyotocabinet_IndexDB_VUNION 7L
+#undef kyotocabinet_IndexDB_TSET
+#define kyotocabinet_IndexDB_TSET 0L
+#undef kyotocabinet_IndexDB_TAPPEND
+#define kyotocabinet_IndexDB_TAPPEND 1L
+#undef kyotocabinet_IndexDB_TPREPEND
+#define kyotocabinet_IndexDB_TPREPEND 2L
+#undef kyotocabinet_IndexDB_TFIELD
+#define kyotocabinet_IndexDB_TFIELD 3L
+#undef kyotocabinet_IndexDB_TREMOVE
+#define kyotocabinet_IndexDB_TREMOVE 4L
+#undef kyotocabinet_IndexDB_TINCINT
+#define kyotocabinet_IndexDB_TINCINT 5L
+/*
+ * Class:     kyotocabinet_IndexDB
+ * Method:    tune_cache_limit
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_IndexDB_tune_1cache_1limit
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     kyotocabinet_IndexDB
+ * Method:    append
+ * Signature: ([B[B)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_IndexDB_append
+  (JNIEnv *, jobject, jbyteArray, jbyteArray);
+
+/*
+ * Class:     kyotocabinet_IndexDB
+ * Method:    initialize
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_IndexDB_initialize
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
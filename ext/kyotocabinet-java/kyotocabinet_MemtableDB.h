@@ -0,0 +1,101 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_MemtableDB */
+
+#ifndef _Included_kyotocabinet_MemtableDB
+#define _Included_kyotocabinet_MemtableDB
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef kyotocabinet_MemtableDB_GEXCEPTIONAL
+#define kyotocabinet_MemtableDB_GEXCEPTIONAL 1L
+#undef kyotocabinet_MemtableDB_OREADER
+#define kyotocabinet_MemtableDB_OREADER 1L
+#undef kyotocabinet_MemtableDB_OWRITER
+#define kyotocabinet_MemtableDB_OWRITER 2L
+#undef kyotocabinet_MemtableDB_OCREATE
+#define kyotocabinet_MemtableDB_OCREATE 4L
+#undef kyotocabinet_MemtableDB_OTRUNCATE
+#define kyotocabinet_MemtableDB_OTRUNCATE 8L
+#undef kyotocabinet_MemtableDB_OAUTOTRAN
+#define kyotocabinet_MemtableDB_OAUTOTRAN 16L
+#undef kyotocabinet_MemtableDB_OAUTOSYNC
+#define kyotocabinet_MemtableDB_OAUTOSYNC 32L
+#undef kyotocabinet_MemtableDB_ONOLOCK
+#define kyotocabinet_MemtableDB_ONOLOCK 64L
+#undef kyotocabinet_MemtableDB_OTRYLOCK
+#define kyotocabinet_MemtableDB_OTRYLOCK 128L
+#undef kyotocabinet_MemtableDB_ONOREPAIR
+#define kyotocabinet_MemtableDB_ONOREPAIR 256L
+#undef kyotocabinet_MemtableDB_MSET
+#define kyotocabinet_MemtableDB_MSET 0L
+#undef kyotocabinet_MemtableDB_MADD
+#define kyotocabinet_MemtableDB_MADD 1L
+#undef kyotocabinet_MemtableDB_MREPLACE
+#define kyotocabinet_MemtableDB_MREPLACE 2L
+#undef kyotocabinet_MemtableDB_MAPPEND
+#define kyotocabinet_MemtableDB_MAPPEND 3L
+#undef kyotocabinet_MemtableDB_CBLOCK
+#define kyotocabinet_MemtableDB_CBLOCK 0L
+#undef kyotocabinet_MemtableDB_CDISCARD
+#define kyotocabinet_MemtableDB_CDISCARD 1L
+#undef kyotocabinet_MemtableDB_COVERWRITE
+#define kyotocabinet_MemtableDB_COVERWRITE 2L
+#undef kyotocabinet_MemtableDB_CSET
+#define kyotocabinet_MemtableDB_CSET 1L
+#undef kyotocabinet_MemtableDB_CREMOVE
+#define kyotocabinet_MemtableDB_CREMOVE 2L
+#undef kyotocabinet_MemtableDB_CCLEAR
+#define kyotocabinet_MemtableDB_CCLEAR 3L
+#undef kyotocabinet_MemtableDB_IRANGE
+#define kyotocabinet_MemtableDB_IRANGE 0L
+#undef kyotocabinet_MemtableDB_IFIELD
+#define kyotocabinet_MemtableDB_IFIELD 1L
+#undef kyotocabinet_MemtableDB_IINTEGER
+#define kyotocabinet_MemtableDB_IINTEGER 2L
+#undef kyotocabinet_MemtableDB_FTSV
+#define kyotocabinet_MemtableDB_FTSV 0L
+#undef kyotocabinet_MemtableDB_FBINARY
+#define kyotocabinet_MemtableDB_FBINARY 1L
+#undef kyotocabinet_MemtableDB_FSNAPSHOT
+#define kyotocabinet_MemtableDB_FSNAPSHOT 2L
+#undef kyotocabinet_MemtableDB_VADDINT
+#define kyotocabinet_MemtableDB_VADDINT 0L
+#undef kyotocabinet_MemtableDB_VADDDBL
+#define kyotocabinet_MemtableDB_VADDDBL 1L
+#undef kyotocabinet_MemtableDB_VMAX
+#define kyotocabinet_MemtableDB_VMAX 2L
+#undef kyotocabinet_MemtableDB_VMIN
+#define kyotocabinet_MemtableDB_VMIN 3L
+#undef kyotocabinet_MemtableDB_VMAXINT
+#define kyotocabinet_MemtableDB_VMAXINT 4L
+#undef kyotocabinet_MemtableDB_VMININT
+#define kyotocabinet_MemtableDB_VMININT 5L
+#undef kyotocabinet_MemtableDB_VOR
+#define kyotocabinet_MemtableDB_VOR 6L
+#undef kyotocabinet_MemtableDB_VUNION
+#define kyotocabinet_MemtableDB_VUNION 7L
+#undef kyotocabinet_MemtableDB_TSET
+#define kyotocabinet_MemtableDB_TSET 0L
+#undef kyotocabinet_MemtableDB_TAPPEND
+#define kyotocabinet_MemtableDB_TAPPEND 1L
+#undef kyotocabinet_MemtableDB_TPREPEND
+#define kyotocabinet_MemtableDB_TPREPEND 2L
+#undef kyotocabinet_MemtableDB_TFIELD
+#define kyotocabinet_MemtableDB_TFIELD 3L
+#undef kyotocabinet_MemtableDB_TREMOVE
+#define kyotocabinet_MemtableDB_TREMOVE 4L
+#undef kyotocabinet_MemtableDB_TINCINT
+#define kyotocabinet_MemtableDB_TINCINT 5L
+/*
+ * Class:     kyotocabinet_MemtableDB
+ * Method:    initialize
+ * Signature: (Ljava/lang/String;J)V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_MemtableDB_initialize
+  (JNIEnv *, jobject, jstring, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
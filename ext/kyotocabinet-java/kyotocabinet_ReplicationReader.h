@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_ReplicationReader */
+
+#ifndef _Included_kyotocabinet_ReplicationReader
+#define _Included_kyotocabinet_ReplicationReader
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     kyotocabinet_ReplicationReader
+ * Method:    disable
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_disable
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     kyotocabinet_ReplicationReader
+ * Method:    apply
+ * Signature: (Lkyotocabinet/DB;IJ)I
+ */
+JNIEXPORT jint JNICALL Java_kyotocabinet_ReplicationReader_apply
+  (JNIEnv *, jobject, jobject, jint, jlong);
+
+/*
+ * Class:     kyotocabinet_ReplicationReader
+ * Method:    timestamp
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_kyotocabinet_ReplicationReader_timestamp
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     kyotocabinet_ReplicationReader
+ * Method:    initialize
+ * Signature: (Ljava/lang/String;J)V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_initialize
+  (JNIEnv *, jobject, jstring, jlong);
+
+/*
+ * Class:     kyotocabinet_ReplicationReader
+ * Method:    destruct
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_ReplicationReader_destruct
+  (JNIEnv *, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
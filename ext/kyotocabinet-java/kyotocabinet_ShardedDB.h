@@ -0,0 +1,101 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_ShardedDB */
+
+#ifndef _Included_kyotocabinet_ShardedDB
+#define _Included_kyotocabinet_ShardedDB
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef kyotocabinet_ShardedDB_GEXCEPTIONAL
+#define kyotocabinet_ShardedDB_GEXCEPTIONAL 1L
+#undef kyotocabinet_ShardedDB_OREADER
+#define kyotocabinet_ShardedDB_OREADER 1L
+#undef kyotocabinet_ShardedDB_OWRITER
+#define kyotocabinet_ShardedDB_OWRITER 2L
+#undef kyotocabinet_ShardedDB_OCREATE
+#define kyotocabinet_ShardedDB_OCREATE 4L
+#undef kyotocabinet_ShardedDB_OTRUNCATE
+#define kyotocabinet_ShardedDB_OTRUNCATE 8L
+#undef kyotocabinet_ShardedDB_OAUTOTRAN
+#define kyotocabinet_ShardedDB_OAUTOTRAN 16L
+#undef kyotocabinet_ShardedDB_OAUTOSYNC
+#define kyotocabinet_ShardedDB_OAUTOSYNC 32L
+#undef kyotocabinet_ShardedDB_ONOLOCK
+#define kyotocabinet_ShardedDB_ONOLOCK 64L
+#undef kyotocabinet_ShardedDB_OTRYLOCK
+#define kyotocabinet_ShardedDB_OTRYLOCK 128L
+#undef kyotocabinet_ShardedDB_ONOREPAIR
+#define kyotocabinet_ShardedDB_ONOREPAIR 256L
+#undef kyotocabinet_ShardedDB_MSET
+#define kyotocabinet_ShardedDB_MSET 0L
+#undef kyotocabinet_ShardedDB_MADD
+#define kyotocabinet_ShardedDB_MADD 1L
+#undef kyotocabinet_ShardedDB_MREPLACE
+#define kyotocabinet_ShardedDB_MREPLACE 2L
+#undef kyotocabinet_ShardedDB_MAPPEND
+#define kyotocabinet_ShardedDB_MAPPEND 3L
+#undef kyotocabinet_ShardedDB_CBLOCK
+#define kyotocabinet_ShardedDB_CBLOCK 0L
+#undef kyotocabinet_ShardedDB_CDISCARD
+#define kyotocabinet_ShardedDB_CDISCARD 1L
+#undef kyotocabinet_ShardedDB_COVERWRITE
+#define kyotocabinet_ShardedDB_COVERWRITE 2L
+#undef kyotocabinet_ShardedDB_CSET
+#define kyotocabinet_ShardedDB_CSET 1L
+#undef kyotocabinet_ShardedDB_CREMOVE
+#define kyotocabinet_ShardedDB_CREMOVE 2L
+#undef kyotocabinet_ShardedDB_CCLEAR
+#define kyotocabinet_ShardedDB_CCLEAR 3L
+#undef kyotocabinet_ShardedDB_IRANGE
+#define kyotocabinet_ShardedDB_IRANGE 0L
+#undef kyotocabinet_ShardedDB_IFIELD
+#define kyotocabinet_ShardedDB_IFIELD 1L
+#undef kyotocabinet_ShardedDB_IINTEGER
+#define kyotocabinet_ShardedDB_IINTEGER 2L
+#undef kyotocabinet_ShardedDB_FTSV
+#define kyotocabinet_ShardedDB_FTSV 0L
+#undef kyotocabinet_ShardedDB_FBINARY
+#define kyotocabinet_ShardedDB_FBINARY 1L
+#undef kyotocabinet_ShardedDB_FSNAPSHOT
+#define kyotocabinet_ShardedDB_FSNAPSHOT 2L
+#undef kyotocabinet_ShardedDB_VADDINT
+#define kyotocabinet_ShardedDB_VADDINT 0L
+#undef kyotocabinet_ShardedDB_VADDDBL
+#define kyotocabinet_ShardedDB_VADDDBL 1L
+#undef kyotocabinet_ShardedDB_VMAX
+#define kyotocabinet_ShardedDB_VMAX 2L
+#undef kyotocabinet_ShardedDB_VMIN
+#define kyotocabinet_ShardedDB_VMIN 3L
+#undef kyotocabinet_ShardedDB_VMAXINT
+#define kyotocabinet_ShardedDB_VMAXINT 4L
+#undef kyotocabinet_ShardedDB_VMININT
+#define kyotocabinet_ShardedDB_VMININT 5L
+#undef kyotocabinet_ShardedDB_VOR
+#define kyotocabinet_ShardedDB_VOR 6L
+#undef kyotocabinet_ShardedDB_VUNION
+#define kyotocabinet_ShardedDB_VUNION 7L
+#undef kyotocabinet_ShardedDB_TSET
+#define kyotocabinet_ShardedDB_TSET 0L
+#undef kyotocabinet_ShardedDB_TAPPEND
+#define kyotocabinet_ShardedDB_TAPPEND 1L
+#undef kyotocabinet_ShardedDB_TPREPEND
+#define kyotocabinet_ShardedDB_TPREPEND 2L
+#undef kyotocabinet_ShardedDB_TFIELD
+#define kyotocabinet_ShardedDB_TFIELD 3L
+#undef kyotocabinet_ShardedDB_TREMOVE
+#define kyotocabinet_ShardedDB_TREMOVE 4L
+#undef kyotocabinet_ShardedDB_TINCINT
+#define kyotocabinet_ShardedDB_TINCINT 5L
+/*
+ * Class:     kyotocabinet_ShardedDB
+ * Method:    initialize
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_ShardedDB_initialize
+  (JNIEnv *, jobject, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,109 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_TextDB */
+
+#ifndef _Included_kyotocabinet_TextDB
+#define _Included_kyotocabinet_TextDB
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef kyotocabinet_TextDB_GEXCEPTIONAL
+#define kyotocabinet_TextDB_GEXCEPTIONAL 1L
+#undef kyotocabinet_TextDB_OREADER
+#define kyotocabinet_TextDB_OREADER 1L
+#undef kyotocabinet_TextDB_OWRITER
+#define kyotocabinet_TextDB_OWRITER 2L
+#undef kyotocabinet_TextDB_OCREATE
+#define kyotocabinet_TextDB_OCREATE 4L
+#undef kyotocabinet_TextDB_OTRUNCATE
+#define kyotocabinet_TextDB_OTRUNCATE 8L
+#undef kyotocabinet_TextDB_OAUTOTRAN
+#define kyotocabinet_TextDB_OAUTOTRAN 16L
+#undef kyotocabinet_TextDB_OAUTOSYNC
+#define kyotocabinet_TextDB_OAUTOSYNC 32L
+#undef kyotocabinet_TextDB_ONOLOCK
+#define kyotocabinet_TextDB_ONOLOCK 64L
+#undef kyotocabinet_TextDB_OTRYLOCK
+#define kyotocabinet_TextDB_OTRYLOCK 128L
+#undef kyotocabinet_TextDB_ONOREPAIR
+#define kyotocabinet_TextDB_ONOREPAIR 256L
+#undef kyotocabinet_TextDB_MSET
+#define kyotocabinet_TextDB_MSET 0L
+#undef kyotocabinet_TextDB_MADD
+#define kyotocabinet_TextDB_MADD 1L
+#undef kyotocabinet_TextDB_MREPLACE
+#define kyotocabinet_TextDB_MREPLACE 2L
+#undef kyotocabinet_TextDB_MAPPEND
+#define kyotocabinet_TextDB_MAPPEND 3L
+#undef kyotocabinet_TextDB_CBLOCK
+#define kyotocabinet_TextDB_CBLOCK 0L
+#undef kyotocabinet_TextDB_CDISCARD
+#define kyotocabinet_TextDB_CDISCARD 1L
+#undef kyotocabinet_TextDB_COVERWRITE
+#define kyotocabinet_TextDB_COVERWRITE 2L
+#undef kyotocabinet_TextDB_CSET
+#define kyotocabinet_TextDB_CSET 1L
+#undef kyotocabinet_TextDB_CREMOVE
+#define kyotocabinet_TextDB_CREMOVE 2L
+#undef kyotocabinet_TextDB_CCLEAR
+#define kyotocabinet_TextDB_CCLEAR 3L
+#undef kyotocabinet_TextDB_IRANGE
+#define kyotocabinet_TextDB_IRANGE 0L
+#undef kyotocabinet_TextDB_IFIELD
+#define kyotocabinet_TextDB_IFIELD 1L
+#undef kyotocabinet_TextDB_IINTEGER
+#define kyotocabinet_TextDB_IINTEGER 2L
+#undef kyotocabinet_TextDB_FTSV
+#define kyotocabinet_TextDB_FTSV 0L
+#undef kyotocabinet_TextDB_FBINARY
+#define kyotocabinet_TextDB_FBINARY 1L
+#undef kyotocabinet_TextDB_FSNAPSHOT
+#define kyotocabinet_TextDB_FSNAPSHOT 2L
+#undef kyotocabinet_TextDB_VADDINT
+#define kyotocabinet_TextDB_VADDINT 0L
+#undef kyotocabinet_TextDB_VADDDBL
+#define kyotocabinet_TextDB_VADDDBL 1L
+#undef kyotocabinet_TextDB_VMAX
+#define kyotocabinet_TextDB_VMAX 2L
+#undef kyotocabinet_TextDB_VMIN
+#define kyotocabinet_TextDB_VMIN 3L
+#undef kyotocabinet_TextDB_VMAXINT
+#define kyotocabinet_TextDB_VMAXINT 4L
+#undef kyotocabinet_TextDB_VMININT
+#define kyotocabinet_TextDB_VMININT 5L
+#undef kyotocabinet_TextDB_VOR
+#define kyotocabinet_TextDB_VOR 6L
+#undef kyotocabinet_TextDB_VUNION
+#define kyotocabinet_TextDB_VUNION 7L
+#undef kyotocabinet_TextDB_TSET
+#define kyotocabinet_TextDB_TSET 0L
+#undef kyotocabinet_TextDB_TAPPEND
+#define kyotocabinet_TextDB_TAPPEND 1L
+#undef kyotocabinet_TextDB_TPREPEND
+#define kyotocabinet_TextDB_TPREPEND 2L
+#undef kyotocabinet_TextDB_TFIELD
+#define kyotocabinet_TextDB_TFIELD 3L
+#undef kyotocabinet_TextDB_TREMOVE
+#define kyotocabinet_TextDB_TREMOVE 4L
+#undef kyotocabinet_TextDB_TINCINT
+#define kyotocabinet_TextDB_TINCINT 5L
+/*
+ * Class:     kyotocabinet_TextDB
+ * Method:    append_lines
+ * Signature: ([B)Z
+ */
+JNIEXPORT jboolean JNICALL Java_kyotocabinet_TextDB_append_1lines
+  (JNIEnv *, jobject, jbyteArray);
+
+/*
+ * Class:     kyotocabinet_TextDB
+ * Method:    read_lines
+ * Signature: (JI)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_kyotocabinet_TextDB_read_1lines
+  (JNIEnv *, jobject, jlong, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
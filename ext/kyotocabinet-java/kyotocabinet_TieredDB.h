@@ -0,0 +1,101 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class kyotocabinet_TieredDB */
+
+#ifndef _Included_kyotocabinet_TieredDB
+#define _Included_kyotocabinet_TieredDB
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef kyotocabinet_TieredDB_GEXCEPTIONAL
+#define kyotocabinet_TieredDB_GEXCEPTIONAL 1L
+#undef kyotocabinet_TieredDB_OREADER
+#define kyotocabinet_TieredDB_OREADER 1L
+#undef kyotocabinet_TieredDB_OWRITER
+#define kyotocabinet_TieredDB_OWRITER 2L
+#undef kyotocabinet_TieredDB_OCREATE
+#define kyotocabinet_TieredDB_OCREATE 4L
+#undef kyotocabinet_TieredDB_OTRUNCATE
+#define kyotocabinet_TieredDB_OTRUNCATE 8L
+#undef kyotocabinet_TieredDB_OAUTOTRAN
+#define kyotocabinet_TieredDB_OAUTOTRAN 16L
+#undef kyotocabinet_TieredDB_OAUTOSYNC
+#define kyotocabinet_TieredDB_OAUTOSYNC 32L
+#undef kyotocabinet_TieredDB_ONOLOCK
+#define kyotocabinet_TieredDB_ONOLOCK 64L
+#undef kyotocabinet_TieredDB_OTRYLOCK
+#define kyotocabinet_TieredDB_OTRYLOCK 128L
+#undef kyotocabinet_TieredDB_ONOREPAIR
+#define kyotocabinet_TieredDB_ONOREPAIR 256L
+#undef kyotocabinet_TieredDB_MSET
+#define kyotocabinet_TieredDB_MSET 0L
+#undef kyotocabinet_TieredDB_MADD
+#define kyotocabinet_TieredDB_MADD 1L
+#undef kyotocabinet_TieredDB_MREPLACE
+#define kyotocabinet_TieredDB_MREPLACE 2L
+#undef kyotocabinet_TieredDB_MAPPEND
+#define kyotocabinet_TieredDB_MAPPEND 3L
+#undef kyotocabinet_TieredDB_CBLOCK
+#define kyotocabinet_TieredDB_CBLOCK 0L
+#undef kyotocabinet_TieredDB_CDISCARD
+#define kyotocabinet_TieredDB_CDISCARD 1L
+#undef kyotocabinet_TieredDB_COVERWRITE
+#define kyotocabinet_TieredDB_COVERWRITE 2L
+#undef kyotocabinet_TieredDB_CSET
+#define kyotocabinet_TieredDB_CSET 1L
+#undef kyotocabinet_TieredDB_CREMOVE
+#define kyotocabinet_TieredDB_CREMOVE 2L
+#undef kyotocabinet_TieredDB_CCLEAR
+#define kyotocabinet_TieredDB_CCLEAR 3L
+#undef kyotocabinet_TieredDB_IRANGE
+#define kyotocabinet_TieredDB_IRANGE 0L
+#undef kyotocabinet_TieredDB_IFIELD
+#define kyotocabinet_TieredDB_IFIELD 1L
+#undef kyotocabinet_TieredDB_IINTEGER
+#define kyotocabinet_TieredDB_IINTEGER 2L
+#undef kyotocabinet_TieredDB_FTSV
+#define kyotocabinet_TieredDB_FTSV 0L
+#undef kyotocabinet_TieredDB_FBINARY
+#define kyotocabinet_TieredDB_FBINARY 1L
+#undef kyotocabinet_TieredDB_FSNAPSHOT
+#define kyotocabinet_TieredDB_FSNAPSHOT 2L
+#undef kyotocabinet_TieredDB_VADDINT
+#define kyotocabinet_TieredDB_VADDINT 0L
+#undef kyotocabinet_TieredDB_VADDDBL
+#define kyotocabinet_TieredDB_VADDDBL 1L
+#undef kyotocabinet_TieredDB_VMAX
+#define kyotocabinet_TieredDB_VMAX 2L
+#undef kyotocabinet_TieredDB_VMIN
+#define kyotocabinet_TieredDB_VMIN 3L
+#undef kyotocabinet_TieredDB_VMAXINT
+#define kyotocabinet_TieredDB_VMAXINT 4L
+#undef kyotocabinet_TieredDB_VMININT
+#define kyotocabinet_TieredDB_VMININT 5L
+#undef kyotocabinet_TieredDB_VOR
+#define kyotocabinet_TieredDB_VOR 6L
+#undef kyotocabinet_TieredDB_VUNION
+#define kyotocabinet_TieredDB_VUNION 7L
+#undef kyotocabinet_TieredDB_TSET
+#define kyotocabinet_TieredDB_TSET 0L
+#undef kyotocabinet_TieredDB_TAPPEND
+#define kyotocabinet_TieredDB_TAPPEND 1L
+#undef kyotocabinet_TieredDB_TPREPEND
+#define kyotocabinet_TieredDB_TPREPEND 2L
+#undef kyotocabinet_TieredDB_TFIELD
+#define kyotocabinet_TieredDB_TFIELD 3L
+#undef kyotocabinet_TieredDB_TREMOVE
+#define kyotocabinet_TieredDB_TREMOVE 4L
+#undef kyotocabinet_TieredDB_TINCINT
+#define kyotocabinet_TieredDB_TINCINT 5L
+/*
+ * Class:     kyotocabinet_TieredDB
+ * Method:    initialize
+ * Signature: (Ljava/lang/String;I)V
+ */
+JNIEXPORT void JNICALL Java_kyotocabinet_TieredDB_initialize
+  (JNIEnv *, jobject, jstring, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif